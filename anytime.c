@@ -0,0 +1,261 @@
+/*
+ * Implementation of the anytime evaluation of the lattices. The linearized
+ * dates are split in residue classes modulo a power of two, visited in
+ * bit - reversed order: after any number of passes the evaluated dates are
+ * evenly spread over the schedule, so that the costs on the dates evaluated
+ * so far extrapolate to the whole schedule. The best lattice so far and its
+ * estimated cost are reported after every pass. The search stops at the first
+ * date past the time budget, or on SIGINT, and the costs of the completed
+ * passes are then replaced by their extrapolation, with a confidence interval
+ * for the best one.
+ */
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<signal.h>
+#include<math.h>
+
+#include<isl/set.h>
+#include<isl/aff.h>
+#include<isl/val.h>
+#include<isl/local_space.h>
+
+#include "support.h"
+#include "counting.h"
+#include "partitioning.h"
+#include "sampling.h"
+#include "anytime.h"
+
+// Number of passes over the dates, a power of two
+#define ANYTIMEPASSES 64
+// Bits of the index of a pass
+#define ANYTIMEBITS 6
+
+extern const unsigned parallel_phases;
+
+// Set by SIGINT, or once the time budget is over
+volatile sig_atomic_t anytimeStop = 0;
+// Wall - clock time at which the search stops, 0 without a budget
+double anytimeDeadline = 0;
+
+void anytime_interrupt(int);
+isl_set * pass_dates(isl_set *, unsigned);
+void anytime_report(FILE *, unsigned, unsigned long *, lattice_metrics *, unsigned, unsigned long, unsigned long);
+void anytime_extrapolate(FILE *, unsigned long *, lattice_metrics *, unsigned, unsigned long, unsigned long);
+
+int anytime_expired(void) {
+	
+	if (anytimeDeadline > 0 && wall_clock() > anytimeDeadline)
+		anytimeStop = 1;
+	
+	return anytimeStop;
+}
+
+void anytime_interrupt(int signum) {
+	anytimeStop = 1;
+}
+
+// The dates congruent to the bit - reversed index of the pass
+isl_set * pass_dates(isl_set * linearizedDatesPtr, unsigned pass) {
+	// Residue of the dates of the pass
+	unsigned residue = 0;
+	// Affine expression of the date minus the residue, modulo the number of passes
+	isl_aff * dateAff = NULL;
+	
+	for (int b = 0; b < ANYTIMEBITS; b++)
+		if (pass & (1 << b))
+			residue |= 1 << (ANYTIMEBITS - 1 - b);
+	
+	dateAff = isl_aff_var_on_domain(isl_local_space_from_space(isl_set_get_space(linearizedDatesPtr)), isl_dim_set, 0);
+	dateAff = isl_aff_add_constant_si(dateAff, -(int)residue);
+	dateAff = isl_aff_mod_val(dateAff, isl_val_int_from_si(isl_set_get_ctx(linearizedDatesPtr), ANYTIMEPASSES));
+	
+	return isl_set_intersect(isl_set_copy(linearizedDatesPtr), isl_set_from_basic_set(isl_aff_zero_basic_set(dateAff)));
+}
+
+isl_stat cost_function_compute_anytime(FILE * stream, phase * phasePtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set * linearizedDatesPtr, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, const memory_model * memoryPtr, unsigned long * cost, lattice_metrics * metrics, result_export * exportPtr, double timeBudget) {
+	// Dates of the current pass
+	isl_set * passDatesPtr = NULL;
+	// Conflicts of each lattice on the dates of the pass
+	unsigned long * passCost = NULL;
+	// Metrics of each lattice on the dates of the pass
+	lattice_metrics * passMetrics = NULL;
+	// Number of linearized dates
+	unsigned long numDates = 0;
+	// Dates evaluated before the current pass
+	unsigned long firstEvaluated = 0;
+	// Dates of the passes whose costs are kept
+	unsigned long numEvaluated = 0;
+	// Whether the current pass was stopped before its last date
+	int interrupted = 0;
+	// Handling of SIGINT before the search
+	struct sigaction previousAction;
+	// Handling of SIGINT during the search
+	struct sigaction interruptAction;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	passCost = malloc(numLattices * sizeof(unsigned long));
+	passMetrics = malloc(numLattices * sizeof(lattice_metrics));
+	
+	if (passCost == NULL || passMetrics == NULL || set_count(linearizedDatesPtr, &numDates) == isl_stat_error) {
+		error(stream, "Memory allocation problem :(");
+		free(passCost);
+		free(passMetrics);
+		return isl_stat_error;
+	}
+	
+	for (int i = 0; i < numLattices; i++)
+		cost[i] = translatesPtr[i] != NULL ? 0 : ULONG_MAX;
+	
+	memset(metrics, 0, numLattices * sizeof(lattice_metrics));
+	
+	memset(&interruptAction, 0, sizeof(struct sigaction));
+	interruptAction.sa_handler = anytime_interrupt;
+	sigemptyset(&(interruptAction.sa_mask));
+	sigaction(SIGINT, &interruptAction, &previousAction);
+	
+	anytimeStop = 0;
+	anytimeDeadline = timeBudget > 0 ? wall_clock() + timeBudget : 0;
+	
+	for (unsigned p = 0; p < ANYTIMEPASSES && outcome == isl_stat_ok && anytimeStop == 0; p++) {
+		passDatesPtr = pass_dates(linearizedDatesPtr, p);
+		firstEvaluated = phasePtr -> statsPtr -> dates;
+		
+		if (passDatesPtr == NULL) {
+			error(stream, "Error during the split of the dates");
+			outcome = isl_stat_error;
+			break;
+		}
+		
+		outcome = cost_function_compute(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, passDatesPtr, translatesPtr, numLattices, numBanks, memoryPtr, passCost, passMetrics, NULL, exportPtr);
+		isl_set_free(passDatesPtr);
+		
+		// Every pass runs the same phases
+		phasePtr -> phase_num -= parallel_phases;
+		
+		interrupted = outcome == isl_stat_error && anytimeStop;
+		
+		if (interrupted)
+			outcome = isl_stat_ok;
+		
+		if (outcome == isl_stat_error)
+			break;
+		
+		// The dates of an interrupted pass are the first ones of its residue, not spread over the schedule
+		if (interrupted && numEvaluated > 0)
+			break;
+		
+		if (interrupted)
+			warning(stream, "No pass was completed, the costs only stand for the first dates of the schedule");
+		
+		for (int i = 0; i < numLattices; i++)
+			if (translatesPtr[i] != NULL) {
+				cost[i] += passCost[i];
+				lattice_metrics_merge(&(metrics[i]), &(passMetrics[i]));
+			}
+		
+		numEvaluated += phasePtr -> statsPtr -> dates - firstEvaluated;
+		
+		if (!interrupted && numEvaluated > 0)
+			anytime_report(stream, p + 1, cost, metrics, numLattices, numEvaluated, numDates);
+	}
+	
+	phasePtr -> phase_num += parallel_phases;
+	sigaction(SIGINT, &previousAction, NULL);
+	anytimeDeadline = 0;
+	
+	if (outcome == isl_stat_ok && numEvaluated < numDates) {
+		
+		if (numEvaluated == 0) {
+			error(stream, "No date was evaluated within the time budget");
+			outcome = isl_stat_error;
+		} else
+			anytime_extrapolate(stream, cost, metrics, numLattices, numEvaluated, numDates);
+	}
+	
+	anytimeStop = 0;
+	
+	// Be clean
+	free(passCost);
+	free(passMetrics);
+	
+	return outcome;
+}
+
+// The lattice with the lowest cost after a pass, and its cost extrapolated to the whole schedule
+void anytime_report(FILE * stream, unsigned numPasses, unsigned long * cost, lattice_metrics * metrics, unsigned numLattices, unsigned long numEvaluated, unsigned long numDates) {
+	// Best lattice so far
+	unsigned bestIdx = UINT_MAX;
+	// Estimated cost of the best lattice and half width of its confidence interval
+	double estimate = 0, margin = 0;
+	
+	for (int i = 0; i < numLattices; i++)
+		if (cost[i] != ULONG_MAX && (bestIdx == UINT_MAX || cost[i] < cost[bestIdx]))
+			bestIdx = i;
+	
+	if (bestIdx == UINT_MAX)
+		return;
+	
+	cost_estimate(cost[bestIdx], &(metrics[bestIdx]), numEvaluated, numDates, &estimate, &margin);
+	
+	info(stream, "Pass %d of the anytime search completed", numPasses);
+	info(stream, "Best lattice so far: %d", bestIdx);
+	info(stream, "Its estimated cost: %d", (int)(estimate + 0.5));
+}
+
+// The costs of the dates evaluated so far stand for those of the whole schedule
+void anytime_extrapolate(FILE * stream, unsigned long * cost, lattice_metrics * metrics, unsigned numLattices, unsigned long numEvaluated, unsigned long numDates) {
+	// Estimated cost of a lattice and half width of its confidence interval
+	double estimate = 0, margin = 0;
+	// Best estimated lattice
+	unsigned bestIdx = UINT_MAX;
+	// Half width of the confidence interval of the best estimated lattice
+	double bestMargin = 0;
+	// Smallest lower end of the confidence intervals of the other lattices
+	double otherLower = INFINITY;
+	// Lower end of the confidence interval of each lattice
+	double * lower = NULL;
+	
+	info(stream, "Search stopped after %d dates", numEvaluated);
+	info(stream, "Coverage of the dates: %d%%", numEvaluated * 100 / numDates);
+	
+	lower = malloc(numLattices * sizeof(double));
+	
+	for (int i = 0; i < numLattices; i++) {
+		
+		if (cost[i] == ULONG_MAX)
+			continue;
+		
+		cost_estimate(cost[i], &(metrics[i]), numEvaluated, numDates, &estimate, &margin);
+		
+		if (lower != NULL)
+			lower[i] = estimate - margin;
+		
+		cost[i] = (unsigned long)(estimate + 0.5);
+		metrics[i].sumSquares = (unsigned long)((double)metrics[i].sumSquares * numDates / numEvaluated + 0.5);
+		metrics[i].imbalance = (unsigned long)((double)metrics[i].imbalance * numDates / numEvaluated + 0.5);
+		
+		if (bestIdx == UINT_MAX || cost[i] < cost[bestIdx]) {
+			bestIdx = i;
+			bestMargin = margin;
+		}
+	}
+	
+	if (bestIdx == UINT_MAX || lower == NULL) {
+		free(lower);
+		return;
+	}
+	
+	info(stream, "Confidence interval of the best extrapolated cost: +/- %d", (int)bestMargin);
+	
+	for (int i = 0; i < numLattices; i++)
+		if (i != bestIdx && cost[i] != ULONG_MAX && lower[i] < otherLower)
+			otherLower = lower[i];
+	
+	// The best lattice so far is only reliable when its interval is apart from the others
+	if (cost[bestIdx] + bestMargin >= otherLower)
+		warning(stream, "The best lattice so far is not significantly better than the others");
+	
+	free(lower);
+}
@@ -0,0 +1,24 @@
+/*
+ * Definitions of the anytime evaluation of the lattices. The dates are
+ * evaluated in passes spreading over the whole schedule, so that the costs
+ * can be extrapolated whenever the time budget expires or the search is
+ * interrupted.
+ */
+
+#ifndef ANYTIME_H
+#define ANYTIME_H
+
+#include<stdio.h>
+
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+#include "export.h"
+#include "ranking.h"
+
+int anytime_expired(void);
+isl_stat cost_function_compute_anytime(FILE *, phase *, manipulated_polyhedral_model **, unsigned, isl_set *, isl_set ***, unsigned, unsigned, const memory_model *, unsigned long *, lattice_metrics *, result_export *, double);
+
+#endif /* ANYTIME_H */
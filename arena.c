@@ -0,0 +1,132 @@
+/*
+ * Implementation of the scratch arena for the per - date temporaries
+ */
+#include<stdlib.h>
+#include<string.h>
+#include<stdalign.h>
+
+#include "arena.h"
+
+#define ARENAALIGN alignof(max_align_t)
+
+arena_block * arena_block_alloc(size_t, arena_block *);
+void arena_blocks_free(arena_block *);
+
+scratch_arena * arena_alloc(size_t size) {
+	// Arena to be allocated
+	scratch_arena * arenaPtr = NULL;
+	
+	arenaPtr = malloc(sizeof(scratch_arena));
+	
+	if (arenaPtr == NULL)
+		return NULL;
+	
+	arenaPtr -> blocks = arena_block_alloc(size, NULL);
+	arenaPtr -> reserved = size;
+	arenaPtr -> peak = 0;
+	
+	if (arenaPtr -> blocks == NULL) {
+		free(arenaPtr);
+		return NULL;
+	}
+	
+	return arenaPtr;
+}
+
+void * arena_get(scratch_arena * arenaPtr, size_t size) {
+	// Block serving the request
+	arena_block * blockPtr = arenaPtr -> blocks;
+	// Buffer to be returned
+	void * buffer = NULL;
+	
+	// Every buffer is suitably aligned for any type
+	size = (size + ARENAALIGN - 1) / ARENAALIGN * ARENAALIGN;
+	
+	// When the current block is exhausted a new one is chained, at least twice as large
+	if (blockPtr -> used + size > blockPtr -> size) {
+		blockPtr = arena_block_alloc(size > 2 * blockPtr -> size ? size : 2 * blockPtr -> size, blockPtr);
+		
+		if (blockPtr == NULL)
+			return NULL;
+		
+		arenaPtr -> blocks = blockPtr;
+		arenaPtr -> reserved += blockPtr -> size;
+	}
+	
+	buffer = blockPtr -> data + blockPtr -> used;
+	blockPtr -> used += size;
+	
+	return buffer;
+}
+
+void * arena_calloc(scratch_arena * arenaPtr, size_t num, size_t size) {
+	// Buffer to be returned
+	void * buffer = arena_get(arenaPtr, num * size);
+	
+	if (buffer != NULL)
+		memset(buffer, 0, num * size);
+	
+	return buffer;
+}
+
+void arena_reset(scratch_arena * arenaPtr) {
+	// Block being examined
+	arena_block * blockPtr = NULL;
+	// Memory used since the last reset
+	size_t used = 0;
+	
+	for (blockPtr = arenaPtr -> blocks; blockPtr != NULL; blockPtr = blockPtr -> next)
+		used += blockPtr -> used;
+	
+	if (used > arenaPtr -> peak)
+		arenaPtr -> peak = used;
+	
+	// If the date needed more than one block, they are merged into a single one for the next dates
+	if (arenaPtr -> blocks -> next != NULL) {
+		blockPtr = arena_block_alloc(arenaPtr -> reserved, NULL);
+		
+		// Without memory for the merged block the chain is kept as it is
+		if (blockPtr != NULL) {
+			arena_blocks_free(arenaPtr -> blocks);
+			arenaPtr -> blocks = blockPtr;
+		}
+	}
+	
+	for (blockPtr = arenaPtr -> blocks; blockPtr != NULL; blockPtr = blockPtr -> next)
+		blockPtr -> used = 0;
+}
+
+void arena_free(scratch_arena * arenaPtr) {
+	
+	if (arenaPtr == NULL)
+		return;
+	
+	arena_blocks_free(arenaPtr -> blocks);
+	free(arenaPtr);
+}
+
+arena_block * arena_block_alloc(size_t size, arena_block * nextPtr) {
+	// Block to be allocated
+	arena_block * blockPtr = NULL;
+	
+	blockPtr = malloc(sizeof(arena_block) + size);
+	
+	if (blockPtr == NULL)
+		return NULL;
+	
+	blockPtr -> size = size;
+	blockPtr -> used = 0;
+	blockPtr -> next = nextPtr;
+	
+	return blockPtr;
+}
+
+void arena_blocks_free(arena_block * blockPtr) {
+	// Block following the one being released
+	arena_block * nextPtr = NULL;
+	
+	for (; blockPtr != NULL; blockPtr = nextPtr) {
+		nextPtr = blockPtr -> next;
+		free(blockPtr);
+	}
+}
@@ -0,0 +1,31 @@
+/*
+ * Definition of the scratch arena holding the buffers which only live for a
+ * single date of the concurrent part. Each worker owns its arena, which is
+ * reset once per date: after the first dates it settles on a single block
+ * and no more memory is requested from the allocator.
+ */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include<stddef.h>
+
+typedef struct arena_block {
+	size_t size;
+	size_t used;
+	struct arena_block * next;
+	_Alignas(max_align_t) char data[];
+} arena_block;
+
+typedef struct {
+	arena_block * blocks;
+	size_t reserved;
+	size_t peak;
+} scratch_arena;
+
+scratch_arena * arena_alloc(size_t);
+void * arena_get(scratch_arena *, size_t);
+void * arena_calloc(scratch_arena *, size_t, size_t);
+void arena_reset(scratch_arena *);
+void arena_free(scratch_arena *);
+
+#endif /* ARENA_H */
@@ -0,0 +1,56 @@
+#!/bin/sh
+# Generates the bank mapping of the best lattice of a few synthetic kernels,
+# builds it as a micro - benchmark with the warnings as errors, and runs it:
+# the micro - benchmark first maps the first and the last address of every
+# translate and fails when uma_bank_map does not give the bank of the
+# translate. Every setting can be overridden from the environment, e.g.
+#	FAMILIES="matmul" SIZES="8" make bankmap-check
+
+FAMILIES=${FAMILIES:-"stencil1d stencil2d matmul"}
+SIZES=${SIZES:-"8"}
+BANKS=${BANKS:-8}
+LATTICES=${LATTICES:-16}
+WORKDIR=${WORKDIR:-benchmark/bankmap}
+UMA=${UMA:-./uma}
+GENERATOR=${GENERATOR:-benchmark/kernel-generator}
+CC=${CC:-gcc}
+
+mkdir -p "$WORKDIR" || exit 1
+failures=0
+
+for family in $FAMILIES; do
+	for size in $SIZES; do
+		dir="$WORKDIR/$family-$size"
+		rm -rf "$dir"
+		printf "%s, size %s... " "$family" "$size"
+
+		if ! "$GENERATOR" "$dir" "$family" "$size" 1 "$BANKS" "$LATTICES"; then
+			echo "generation failed"
+			failures=$((failures + 1))
+			continue
+		fi
+
+		if ! "$UMA" --quiet --arch "$dir/arch.txt" --codegen "$dir/mapping.c" "$dir/log.txt" "${family}_0" > /dev/null 2>&1 || [ ! -f "$dir/mapping.c" ]; then
+			echo "run failed, see $dir/log.txt"
+			failures=$((failures + 1))
+			continue
+		fi
+
+		if ! "$CC" -O2 -DUMA_BANK_MAP_BENCHMARK -Wall -Werror "$dir/mapping.c" -o "$dir/mapping"; then
+			echo "the generated mapping does not build"
+			failures=$((failures + 1))
+			continue
+		fi
+
+		if ! "$dir/mapping"; then
+			failures=$((failures + 1))
+		fi
+	done
+done
+
+if [ "$failures" -gt 0 ]; then
+	echo "$failures bank mapping(s) failed"
+	exit 1
+fi
+
+echo "Every bank mapping gives the banks of the translates"
@@ -0,0 +1,361 @@
+/*
+ * Generator of the synthetic kernels of the benchmark. For a family, a size
+ * and a number of tasks it writes, in the given directory, the source and the
+ * schedule of each task, the architecture file and the catalog of the
+ * fundamental lattices of the address space, with all their translates.
+ *
+ * Every kernel works on a single array, whose first dimension selects the
+ * buffer, and has the two parameters M and N, which are both set to the size
+ * so that their order in the isl spaces does not matter.
+ */
+#include<stdlib.h>
+#include<stdio.h>
+#include<string.h>
+#include<errno.h>
+#include<sys/stat.h>
+
+#define DIMSTRING 1024
+#define MAXDIM 8
+#define MAXLOOPS 4
+#define PROCESSORS 4
+
+typedef struct {
+	const char * name;
+	unsigned arrayDim;
+	const char * array;
+	const char * domain;
+	const char * body;
+	const char * iterators[MAXLOOPS];
+	const char * loops[MAXLOOPS];
+	unsigned coincident[MAXLOOPS];
+} kernel_family;
+
+// State of the enumeration of the fundamental lattices
+typedef struct {
+	const char * directory;
+	unsigned dim;
+	unsigned numBanks;
+	unsigned maxLattices;
+	unsigned numLattices;
+	long basis[MAXDIM][MAXDIM];
+} lattice_catalog;
+
+// The loops are listed from the outermost; the domain is the one of the schedule file
+const kernel_family families[] = {
+	{"stencil1d", 2, "A[2][N]", "0 <= t < M and 1 <= i <= -2 + N",
+		"A[(t + 1) % 2][i] = (A[t % 2][i - 1] + A[t % 2][i] + A[t % 2][i + 1]) / 3;",
+		{"t", "i", NULL, NULL},
+		{"for (int t = 0; t < M; t++)", "for (int i = 1; i < N - 1; i++)", NULL, NULL}, {0, 1, 0, 0}},
+	{"stencil2d", 3, "A[2][M][N]", "1 <= i <= -2 + M and 1 <= j <= -2 + N",
+		"A[1][i][j] = (A[0][i - 1][j] + A[0][i + 1][j] + A[0][i][j] + A[0][i][j - 1] + A[0][i][j + 1]) / 5;",
+		{"i", "j", NULL, NULL},
+		{"for (int i = 1; i < M - 1; i++)", "for (int j = 1; j < N - 1; j++)", NULL, NULL}, {1, 1, 0, 0}},
+	{"stencil3d", 4, "A[2][M][N][N]", "1 <= i <= -2 + M and 1 <= j <= -2 + N and 1 <= k <= -2 + N",
+		"A[1][i][j][k] = (A[0][i - 1][j][k] + A[0][i + 1][j][k] + A[0][i][j - 1][k] + A[0][i][j + 1][k] + A[0][i][j][k - 1] + A[0][i][j][k + 1] + A[0][i][j][k]) / 7;",
+		{"i", "j", "k", NULL},
+		{"for (int i = 1; i < M - 1; i++)", "for (int j = 1; j < N - 1; j++)", "for (int k = 1; k < N - 1; k++)", NULL}, {1, 1, 1, 0}},
+	{"matmul", 3, "A[3][N][N]", "0 <= i < M and 0 <= j < N and 0 <= k < N",
+		"A[2][i][j] += A[0][i][k] * A[1][k][j];",
+		{"i", "j", "k", NULL},
+		{"for (int i = 0; i < M; i++)", "for (int j = 0; j < N; j++)", "for (int k = 0; k < N; k++)", NULL}, {1, 1, 0, 0}},
+	{"transpose", 3, "A[2][N][N]", "0 <= i < M and 0 <= j < N",
+		"A[1][j][i] = A[0][i][j];",
+		{"i", "j", NULL, NULL},
+		{"for (int i = 0; i < M; i++)", "for (int j = 0; j < N; j++)", NULL, NULL}, {1, 1, 0, 0}},
+	{"conv2d", 3, "A[2][M + 2][N + 2]", "0 <= i < M and 0 <= j < N",
+		"A[1][i][j] = A[0][i][j] + A[0][i][j + 1] + A[0][i][j + 2] + A[0][i + 1][j] + A[0][i + 1][j + 1] + A[0][i + 1][j + 2] + A[0][i + 2][j] + A[0][i + 2][j + 1] + A[0][i + 2][j + 2];",
+		{"i", "j", NULL, NULL},
+		{"for (int i = 0; i < M; i++)", "for (int j = 0; j < N; j++)", NULL, NULL}, {1, 1, 0, 0}}
+};
+
+const unsigned numFamilies = sizeof(families) / sizeof(families[0]);
+
+int kernel_write(const char *, const kernel_family *, unsigned);
+int schedule_write(const char *, const kernel_family *, unsigned);
+int architecture_write(const char *, const kernel_family *, unsigned, unsigned, unsigned);
+int lattices_write(const char *, unsigned, unsigned, unsigned);
+int diagonal_enumerate(lattice_catalog *, unsigned, unsigned);
+int hermite_enumerate(lattice_catalog *, unsigned, unsigned);
+int lattice_write(lattice_catalog *);
+void instance_print(FILE *, const kernel_family *);
+
+int main(int argc, char ** argv) {
+	// Family of the kernels
+	const kernel_family * familyPtr = NULL;
+	// Size of the kernels
+	int size = 0;
+	// Number of tasks
+	int numTasks = 0;
+	// Number of banks
+	int numBanks = 0;
+	// Maximum number of fundamental lattices in the catalog
+	int maxLattices = 0;
+	// Directory of the lattices
+	char latticesDir[DIMSTRING];
+	
+	if (argc != 7) {
+		fprintf(stderr, "Usage: %s <directory> <family> <size> <tasks> <banks> <lattices>\n", argv[0]);
+		return 1;
+	}
+	
+	for (int i = 0; i < numFamilies; i++)
+		if (strcmp(argv[2], families[i].name) == 0)
+			familyPtr = &families[i];
+	
+	size = atoi(argv[3]);
+	numTasks = atoi(argv[4]);
+	numBanks = atoi(argv[5]);
+	maxLattices = atoi(argv[6]);
+	
+	if (familyPtr == NULL || size < 3 || numTasks <= 0 || numBanks <= 0 || maxLattices <= 0) {
+		fprintf(stderr, "Unknown family or invalid size, tasks, banks or lattices\n");
+		return 1;
+	}
+	
+	if (snprintf(latticesDir, DIMSTRING, "%s/lattices", argv[1]) >= DIMSTRING) {
+		fprintf(stderr, "Directory name too long\n");
+		return 1;
+	}
+	
+	if ((mkdir(argv[1], 0755) < 0 && errno != EEXIST) || (mkdir(latticesDir, 0755) < 0 && errno != EEXIST)) {
+		perror("Cannot create the directories");
+		return 1;
+	}
+	
+	for (int i = 0; i < numTasks; i++)
+		if (kernel_write(argv[1], familyPtr, i) < 0 || schedule_write(argv[1], familyPtr, i) < 0) {
+			perror("Cannot write a kernel");
+			return 1;
+		}
+	
+	if (architecture_write(argv[1], familyPtr, size, numTasks, numBanks) < 0) {
+		perror("Cannot write the architecture file");
+		return 1;
+	}
+	
+	// The address space has one more dimension, selecting the task
+	if (lattices_write(latticesDir, familyPtr -> arrayDim + 1, numBanks, maxLattices) < 0) {
+		perror("Cannot write the lattices");
+		return 1;
+	}
+	
+	return 0;
+}
+
+int kernel_write(const char * directory, const kernel_family * familyPtr, unsigned taskNum) {
+	// Name of the source file
+	char fileName[DIMSTRING];
+	// Handle to the source file
+	FILE * sourceHdl = NULL;
+	// Number of loops
+	unsigned numLoops = 0;
+	
+	snprintf(fileName, DIMSTRING, "%s/%s_%u.c", directory, familyPtr -> name, taskNum);
+	sourceHdl = fopen(fileName, "w");
+	
+	if (sourceHdl == NULL)
+		return -1;
+	
+	fprintf(sourceHdl, "void %s_%u(int M, int N, float %s) {\n#pragma scop\n", familyPtr -> name, taskNum, familyPtr -> array);
+	
+	for (numLoops = 0; numLoops < MAXLOOPS && familyPtr -> loops[numLoops] != NULL; numLoops++)
+		fprintf(sourceHdl, "%*s%s\n", (int)(numLoops + 1), "", familyPtr -> loops[numLoops]);
+	
+	fprintf(sourceHdl, "%*s%s\n#pragma endscop\n}\n", (int)(numLoops + 1), "", familyPtr -> body);
+	
+	return fclose(sourceHdl) == 0 ? 0 : -1;
+}
+
+int schedule_write(const char * directory, const kernel_family * familyPtr, unsigned taskNum) {
+	// Name of the schedule file
+	char fileName[DIMSTRING];
+	// Handle to the schedule file
+	FILE * scheduleHdl = NULL;
+	
+	snprintf(fileName, DIMSTRING, "%s/%s_%u.isl.schedule", directory, familyPtr -> name, taskNum);
+	scheduleHdl = fopen(fileName, "w");
+	
+	if (scheduleHdl == NULL)
+		return -1;
+	
+	fprintf(scheduleHdl, "domain: \"[M, N] -> { ");
+	instance_print(scheduleHdl, familyPtr);
+	fprintf(scheduleHdl, " : %s }\"\n", familyPtr -> domain);
+	
+	// One band for each loop, so that the outermost parallel one can be found
+	for (int i = 0; i < MAXLOOPS && familyPtr -> iterators[i] != NULL; i++) {
+		fprintf(scheduleHdl, "%*schild:\n", 2 * i, "");
+		fprintf(scheduleHdl, "%*sschedule: \"[M, N] -> [{ ", 2 * i + 2, "");
+		instance_print(scheduleHdl, familyPtr);
+		fprintf(scheduleHdl, " -> [(%s)] }]\"\n", familyPtr -> iterators[i]);
+		fprintf(scheduleHdl, "%*scoincident: [ %u ]\n", 2 * i + 2, "", familyPtr -> coincident[i]);
+	}
+	
+	return fclose(scheduleHdl) == 0 ? 0 : -1;
+}
+
+void instance_print(FILE * stream, const kernel_family * familyPtr) {
+	
+	fprintf(stream, "S_0[");
+	
+	for (int i = 0; i < MAXLOOPS && familyPtr -> iterators[i] != NULL; i++)
+		fprintf(stream, "%s%s", i > 0 ? ", " : "", familyPtr -> iterators[i]);
+	
+	fprintf(stream, "]");
+}
+
+int architecture_write(const char * directory, const kernel_family * familyPtr, unsigned size, unsigned numTasks, unsigned numBanks) {
+	// Name of the architecture file
+	char fileName[DIMSTRING];
+	// Handle to the architecture file
+	FILE * archHdl = NULL;
+	
+	snprintf(fileName, DIMSTRING, "%s/arch.txt", directory);
+	archHdl = fopen(fileName, "w");
+	
+	if (archHdl == NULL)
+		return -1;
+	
+	fprintf(archHdl, "# %s, size %u, %u task(s)\n", familyPtr -> name, size, numTasks);
+	fprintf(archHdl, "banks %u\n", numBanks);
+	fprintf(archHdl, "sources %s/\n", directory);
+	fprintf(archHdl, "schedules %s/\n", directory);
+	fprintf(archHdl, "lattices %s/lattices/\n", directory);
+	
+	for (int i = 0; i < numTasks; i++)
+		fprintf(archHdl, "task %u %u %u\n", PROCESSORS, size, size);
+	
+	return fclose(archHdl) == 0 ? 0 : -1;
+}
+
+int lattices_write(const char * directory, unsigned dim, unsigned numBanks, unsigned maxLattices) {
+	// State of the enumeration
+	lattice_catalog catalog;
+	// Name of the file with the number of lattices
+	char fileName[DIMSTRING];
+	// Handle to the file with the number of lattices
+	FILE * numHdl = NULL;
+	
+	if (dim > MAXDIM)
+		return -1;
+	
+	memset(&catalog, 0, sizeof(lattice_catalog));
+	catalog.directory = directory;
+	catalog.dim = dim;
+	catalog.numBanks = numBanks;
+	catalog.maxLattices = maxLattices;
+	
+	if (diagonal_enumerate(&catalog, 0, numBanks) < 0)
+		return -1;
+	
+	snprintf(fileName, DIMSTRING, "%s/%u_dim%u_numLattices.txt", directory, numBanks, dim);
+	numHdl = fopen(fileName, "w");
+	
+	if (numHdl == NULL)
+		return -1;
+	
+	fprintf(numHdl, "Number of different fundamental lattices: %u\n", catalog.numLattices);
+	
+	return fclose(numHdl) == 0 ? 0 : -1;
+}
+
+// The fundamental lattices with as many translates as banks are the sublattices of
+// index numBanks; each one is generated once by its lower - triangular Hermite normal form
+int diagonal_enumerate(lattice_catalog * catalogPtr, unsigned row, unsigned remaining) {
+	
+	if (row == catalogPtr -> dim - 1) {
+		catalogPtr -> basis[row][row] = remaining;
+		return hermite_enumerate(catalogPtr, 1, 0);
+	}
+	
+	for (unsigned d = 1; d <= remaining && catalogPtr -> numLattices < catalogPtr -> maxLattices; d++) {
+		if (remaining % d != 0)
+			continue;
+		
+		catalogPtr -> basis[row][row] = d;
+		
+		if (diagonal_enumerate(catalogPtr, row + 1, remaining / d) < 0)
+			return -1;
+	}
+	
+	return 0;
+}
+
+// The entries below the diagonal are reduced modulo the diagonal entry of their row
+int hermite_enumerate(lattice_catalog * catalogPtr, unsigned row, unsigned col) {
+	
+	if (catalogPtr -> numLattices >= catalogPtr -> maxLattices)
+		return 0;
+	
+	if (row >= catalogPtr -> dim)
+		return lattice_write(catalogPtr);
+	
+	if (col >= row)
+		return hermite_enumerate(catalogPtr, row + 1, 0);
+	
+	for (long v = 0; v < catalogPtr -> basis[row][row]; v++) {
+		catalogPtr -> basis[row][col] = v;
+		
+		if (hermite_enumerate(catalogPtr, row, col + 1) < 0)
+			return -1;
+	}
+	
+	return 0;
+}
+
+int lattice_write(lattice_catalog * catalogPtr) {
+	// Name of the file of the translate
+	char fileName[DIMSTRING];
+	// Handle to the file of the translate
+	FILE * translateHdl = NULL;
+	// Offset of the translate, within the box of the diagonal
+	long offset[MAXDIM];
+	// Number of the translate
+	unsigned translateNum = 0;
+	
+	catalogPtr -> numLattices++;
+	memset(offset, 0, sizeof(offset));
+	
+	for (translateNum = 1; translateNum <= catalogPtr -> numBanks; translateNum++) {
+		snprintf(fileName, DIMSTRING, "%s/%u_dim%u_lattice%u_translate%u.txt", catalogPtr -> directory, catalogPtr -> numBanks, catalogPtr -> dim, catalogPtr -> numLattices, translateNum);
+		translateHdl = fopen(fileName, "w");
+		
+		if (translateHdl == NULL)
+			return -1;
+		
+		fprintf(translateHdl, "{ [");
+		
+		for (int i = 0; i < catalogPtr -> dim; i++)
+			fprintf(translateHdl, "%sx%d", i > 0 ? ", " : "", i);
+		
+		fprintf(translateHdl, "] : exists (");
+		
+		for (int i = 0; i < catalogPtr -> dim; i++)
+			fprintf(translateHdl, "%sz%d", i > 0 ? ", " : "", i);
+		
+		fprintf(translateHdl, " : ");
+		
+		for (int i = 0; i < catalogPtr -> dim; i++) {
+			fprintf(translateHdl, "%sx%d = %ld", i > 0 ? " and " : "", i, offset[i]);
+			
+			for (int j = 0; j <= i; j++)
+				if (catalogPtr -> basis[i][j] != 0)
+					fprintf(translateHdl, " + %ld * z%d", catalogPtr -> basis[i][j], j);
+		}
+		
+		fprintf(translateHdl, ") }\n");
+		
+		if (fclose(translateHdl) != 0)
+			return -1;
+		
+		// Next offset, as an odometer over the box of the diagonal
+		for (int i = catalogPtr -> dim - 1; i >= 0; i--) {
+			if (++offset[i] < catalogPtr -> basis[i][i])
+				break;
+			
+			offset[i] = 0;
+		}
+	}
+	
+	return 0;
+}
@@ -0,0 +1,61 @@
+#!/bin/sh
+# Runs the pipeline on the synthetic kernels at increasing sizes and numbers of
+# tasks, and collects the per - phase time and memory into a results table.
+# Every setting can be overridden from the environment, e.g.
+#	FAMILIES="matmul" SIZES="8 16" make benchmark
+
+FAMILIES=${FAMILIES:-"stencil1d stencil2d stencil3d matmul transpose conv2d"}
+SIZES=${SIZES:-"8 16 32"}
+TASKS=${TASKS:-"1 2 3"}
+BANKS=${BANKS:-8}
+LATTICES=${LATTICES:-64}
+WORKDIR=${WORKDIR:-benchmark/work}
+RESULTS=${RESULTS:-benchmark/results.tsv}
+UMA=${UMA:-./uma}
+GENERATOR=${GENERATOR:-benchmark/kernel-generator}
+
+mkdir -p "$WORKDIR" || exit 1
+printf "family\tsize\ttasks\tstep\tphase\truns\twall_seconds\tcpu_seconds\tpeak_rss_kb\n" > "$RESULTS"
+
+for family in $FAMILIES; do
+	for size in $SIZES; do
+		for tasks in $TASKS; do
+			dir="$WORKDIR/$family-$size-$tasks"
+			rm -rf "$dir"
+
+			if ! "$GENERATOR" "$dir" "$family" "$size" "$tasks" "$BANKS" "$LATTICES"; then
+				printf "%s\t%s\t%s\t-\tgeneration failed\t0\t0\t0\t0\n" "$family" "$size" "$tasks" >> "$RESULTS"
+				continue
+			fi
+
+			names=""
+			task=0
+			while [ "$task" -lt "$tasks" ]; do
+				names="$names ${family}_$task"
+				task=$((task + 1))
+			done
+
+			printf "%s, size %s, %s task(s)... " "$family" "$size" "$tasks"
+
+			if ! "$UMA" --quiet --arch "$dir/arch.txt" --report "$dir/report.json" "$dir/log.txt" $names > /dev/null 2>&1; then
+				echo "failed, see $dir/log.txt"
+				printf "%s\t%s\t%s\t-\trun failed\t0\t0\t0\t0\n" "$family" "$size" "$tasks" >> "$RESULTS"
+				continue
+			fi
+
+			# One row for each phase, then one for the whole run whose runs are the dates
+			sed -n 's/.*"step": \([0-9]*\), "name": "\([^"]*\)", "runs": \([0-9]*\), "wall_seconds": \([0-9.]*\), "cpu_seconds": \([0-9.]*\), "peak_rss_kb": \([0-9-]*\).*/\1\t\2\t\3\t\4\t\5\t\6/p' "$dir/report.json" |
+				sed "s/^/$family\t$size\t$tasks\t/" >> "$RESULTS"
+
+			dates=$(sed -n 's/^\t"dates": \([0-9]*\),/\1/p' "$dir/report.json")
+			wall=$(sed -n 's/^\t"wall_seconds": \([0-9.]*\),/\1/p' "$dir/report.json")
+			cpu=$(sed -n 's/^\t"cpu_seconds": \([0-9.]*\),/\1/p' "$dir/report.json")
+			rss=$(sed -n 's/^\t"peak_rss_kb": \([0-9-]*\)$/\1/p' "$dir/report.json")
+			printf "%s\t%s\t%s\t-\ttotal\t%s\t%s\t%s\t%s\n" "$family" "$size" "$tasks" "$dates" "$wall" "$cpu" "$rss" >> "$RESULTS"
+
+			echo "${wall} s"
+		done
+	done
+done
+
+echo "Results written to $RESULTS"
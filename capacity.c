@@ -0,0 +1,133 @@
+#ifdef MOREVERBOSE
+#define VERBOSE
+#endif
+/*
+ * Implementation of the analysis of the storage needed in each bank under a
+ * lattice. The capacity is the number of words the compact addressing of the
+ * bank mapping reserves in every bank; the footprint is the number of
+ * allocated addresses falling in a bank, and the fragmentation is the share
+ * of the reserved words which no address uses.
+ */
+#include<stdlib.h>
+
+#include<isl/set.h>
+
+#include "support.h"
+#include "counting.h"
+#include "codegen.h"
+#include "partitioning.h"
+#include "capacity.h"
+
+isl_stat lattice_capacity_analyse(FILE *, isl_set **, unsigned, isl_set *, bank_usage *);
+
+bank_usage * lattices_capacity_analyse(FILE * stream, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, isl_set * addressSpacePtr) {
+	// Usage of the banks under each lattice
+	bank_usage * usage = NULL;
+	
+	usage = calloc(numLattices, sizeof(bank_usage));
+	
+	if (usage == NULL) {
+		error(stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	for (int i = 0; i < numLattices; i++)
+		if (lattice_capacity_analyse(stream, translatesPtr[i], numBanks, addressSpacePtr, &(usage[i])) == isl_stat_error) {
+			free(usage);
+			return NULL;
+		}
+	
+	return usage;
+}
+
+isl_stat lattice_capacity_analyse(FILE * stream, isl_set ** translatesPtr, unsigned numBanks, isl_set * addressSpacePtr, bank_usage * usagePtr) {
+	// Bank mapping of the lattice
+	bank_mapping * mappingPtr = NULL;
+	// Addresses falling in the current bank
+	unsigned long footprint = 0;
+	
+	mappingPtr = bank_mapping_build(stream, translatesPtr, numBanks, addressSpacePtr);
+	
+	if (mappingPtr == NULL)
+		return isl_stat_error;
+	
+	usagePtr -> capacity = bank_mapping_capacity(mappingPtr);
+	bank_mapping_free(mappingPtr);
+	
+	for (int b = 0; b < numBanks; b++) {
+		// The intersection is only needed for its size
+		isl_set * bankAddressesPtr = isl_set_intersect(isl_set_copy(addressSpacePtr), isl_set_copy(translatesPtr[b]));
+		
+		if (bankAddressesPtr == NULL || set_count(bankAddressesPtr, &footprint) == isl_stat_error) {
+			isl_set_free(bankAddressesPtr);
+			return isl_stat_error;
+		}
+		
+		isl_set_free(bankAddressesPtr);
+		usagePtr -> footprint += footprint;
+		
+		if (footprint > usagePtr -> maxFootprint)
+			usagePtr -> maxFootprint = footprint;
+	}
+	
+	usagePtr -> fragmentation = usagePtr -> capacity > 0 ? 1.0 - (double)usagePtr -> footprint / ((double)usagePtr -> capacity * numBanks) : 0;
+	
+	return isl_stat_ok;
+}
+
+// The catalog as a search sees it: the lattices which do not fit are left out, without being rejected from the catalog
+isl_set *** lattices_capacity_view(FILE * stream, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, unsigned long bankCapacity, isl_set * addressSpacePtr) {
+	// Lattices fitting in the banks, sharing their translates with the catalog
+	isl_set *** feasiblePtr = NULL;
+	// Usage of the banks under the current lattice
+	bank_usage usage;
+	
+	feasiblePtr = malloc(numLattices * sizeof(isl_set **));
+	
+	if (feasiblePtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	for (int i = 0; i < numLattices; i++) {
+		feasiblePtr[i] = translatesPtr[i];
+		
+		if (translatesPtr[i] == NULL || bankCapacity == 0)
+			continue;
+		
+		usage.footprint = 0;
+		usage.maxFootprint = 0;
+		
+		if (lattice_capacity_analyse(stream, translatesPtr[i], numBanks, addressSpacePtr, &usage) == isl_stat_error) {
+			free(feasiblePtr);
+			return NULL;
+		}
+		
+		if (usage.capacity > bankCapacity)
+			feasiblePtr[i] = NULL;
+	}
+	
+	return feasiblePtr;
+}
+
+// The lattices which do not fit are rejected, so that the concurrent part skips them
+unsigned lattices_capacity_filter(FILE * stream, isl_set *** translatesPtr, bank_usage * usage, unsigned numLattices, unsigned numBanks, unsigned long bankCapacity) {
+	// Number of lattices fitting in the banks
+	unsigned numFeasible = 0;
+	
+	for (int i = 0; i < numLattices; i++) {
+		if (bankCapacity == 0 || usage[i].capacity <= bankCapacity) {
+			numFeasible++;
+			continue;
+		}
+		
+#ifdef VERBOSE
+		fprintf(stream, "Fundamental lattice %d needs %lu words per bank: rejected\n", i, usage[i].capacity);
+		fflush(stream);
+#endif
+		
+		lattice_reject(translatesPtr, i, numBanks);
+	}
+	
+	return numFeasible;
+}
@@ -0,0 +1,24 @@
+/*
+ * Definitions of the analysis of the storage needed in each bank under a
+ * lattice, with the compact intra - bank addressing of the bank mapping.
+ */
+
+#ifndef CAPACITY_H
+#define CAPACITY_H
+
+#include<stdio.h>
+
+#include<isl/set.h>
+
+typedef struct {
+	unsigned long capacity;
+	unsigned long footprint;
+	unsigned long maxFootprint;
+	double fragmentation;
+} bank_usage;
+
+bank_usage * lattices_capacity_analyse(FILE *, isl_set ***, unsigned, unsigned, isl_set *);
+unsigned lattices_capacity_filter(FILE *, isl_set ***, bank_usage *, unsigned, unsigned, unsigned long);
+isl_set *** lattices_capacity_view(FILE *, isl_set ***, unsigned, unsigned, unsigned long, isl_set *);
+
+#endif /* CAPACITY_H */
@@ -0,0 +1,507 @@
+/*
+ * Implementation of the checkpoints of the cost function computation. The
+ * file is line - oriented text, rewritten atomically at every checkpoint:
+ *   UMA-CHECKPOINT 2
+ *   tasks <n> <task> ...
+ *   banks <n>
+ *   key <hash of the architecture and of the options>
+ *   costs <n> <cost 0> <cost 1> ...
+ *   metrics <n> <worst 0> <squares 0> <imbalance 0> <worst 1> ...
+ *   stats <dates> <points> <lattices>
+ *   processed <isl set of the evaluated dates>
+ *   linearized <task number> <isl union map of the linearized schedule>
+ */
+#define _GNU_SOURCE
+#include<limits.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+
+#include<isl/set.h>
+#include<isl/union_map.h>
+
+#include "support.h"
+#include "model.h"
+#include "checkpoint.h"
+
+#define CHECKPOINTVERSION 2
+// Dates evaluated before they are folded into the processed ones
+#define CHECKPOINTPENDING 64
+
+const char * checkpointHeader = "UMA-CHECKPOINT";
+const char * temporarySuffix = ".tmp";
+
+isl_stat checkpoint_line_parse(FILE *, isl_ctx *, checkpoint *, char *);
+isl_stat checkpoint_pending_fold(checkpoint *);
+unsigned long key_mix(unsigned long, const void *, size_t);
+unsigned long key_mix_string(unsigned long, const char *);
+
+// FNV-1a hash of a block of bytes, chained from the hash of the previous ones
+unsigned long key_mix(unsigned long key, const void * bytes, size_t size) {
+	
+	for (size_t i = 0; i < size; i++) {
+		key ^= ((const unsigned char *)bytes)[i];
+		key *= 1099511628211UL;
+	}
+	
+	return key;
+}
+
+unsigned long key_mix_string(unsigned long key, const char * string) {
+	// Length of the string, hashed so that consecutive strings cannot be confused
+	size_t length = string != NULL ? strlen(string) : 0;
+	
+	key = key_mix(key, &length, sizeof(length));
+	
+	return string != NULL ? key_mix(key, string, length) : key;
+}
+
+// Everything which changes the costs: the architecture, the catalog and the searches run before the evaluation
+unsigned long checkpoint_key(const architecture_config * archPtr, const run_options * optionsPtr) {
+	// Hash being built
+	unsigned long key = 14695981039346656037UL;
+	// Number of latencies of the processors to the banks
+	unsigned numCycles = 0;
+	// Ports of the banks, none when the configuration gives none
+	bank_ports ports = {0, 0, 0};
+	
+	key = key_mix(key, &(archPtr -> maxTasks), sizeof(unsigned));
+	key = key_mix(key, archPtr -> N, archPtr -> maxTasks * sizeof(unsigned));
+	key = key_mix(key, archPtr -> numParams, archPtr -> maxTasks * sizeof(unsigned));
+	
+	for (int i = 0; i < archPtr -> maxTasks; i++)
+		key = key_mix(key, archPtr -> params[i], archPtr -> numParams[i] * sizeof(unsigned));
+	
+	key = key_mix(key, &(archPtr -> numBanks), sizeof(unsigned));
+	key = key_mix_string(key, archPtr -> sourcePath);
+	key = key_mix_string(key, archPtr -> schedulePath);
+	key = key_mix_string(key, archPtr -> latticesPath);
+	key = key_mix(key, &(archPtr -> bankCapacity), sizeof(unsigned long));
+	key = key_mix(key, &(archPtr -> numClusters), sizeof(unsigned));
+	key = key_mix(key, &(archPtr -> clusterWeight), sizeof(unsigned));
+	
+	if (archPtr -> memory.latency != NULL) {
+		numCycles = archPtr -> memory.latency -> numProcessors * archPtr -> memory.latency -> numBanks;
+		key = key_mix(key, &(archPtr -> memory.latency -> numProcessors), sizeof(unsigned));
+		key = key_mix(key, &(archPtr -> memory.latency -> numBanks), sizeof(unsigned));
+		key = key_mix(key, archPtr -> memory.latency -> cycles, numCycles * sizeof(unsigned));
+	}
+	
+	key = key_mix(key, &numCycles, sizeof(unsigned));
+	
+	if (archPtr -> memory.ports != NULL)
+		ports = *(archPtr -> memory.ports);
+	
+	key = key_mix(key, &ports, sizeof(bank_ports));
+	
+	key = key_mix(key, &(optionsPtr -> screen), sizeof(unsigned long));
+	key = key_mix(key, &(optionsPtr -> processorBudget), sizeof(unsigned));
+	key = key_mix(key, &(optionsPtr -> placementSearch), sizeof(unsigned));
+	key = key_mix(key, &(optionsPtr -> placementOffset), sizeof(unsigned));
+	key = key_mix(key, &(optionsPtr -> mergeAccesses), sizeof(unsigned));
+	
+	return key;
+}
+
+checkpoint * checkpoint_alloc(const char * path, double interval, char ** tasks, unsigned numTasks, unsigned numBanks, unsigned long key) {
+	// Checkpoint to be allocated
+	checkpoint * checkpointPtr = NULL;
+	
+	checkpointPtr = calloc(1, sizeof(checkpoint));
+	
+	if (checkpointPtr == NULL)
+		return NULL;
+	
+	checkpointPtr -> path = path;
+	checkpointPtr -> interval = interval;
+	checkpointPtr -> tasks = tasks;
+	checkpointPtr -> numTasks = numTasks;
+	checkpointPtr -> numBanks = numBanks;
+	checkpointPtr -> key = key;
+	
+	return checkpointPtr;
+}
+
+isl_stat checkpoint_load(FILE * stream, isl_ctx * optionsHdl, checkpoint * checkpointPtr) {
+	// Handle to the checkpoint file
+	FILE * checkpointHdl = NULL;
+	// Line currently read
+	char * line = NULL;
+	// Size of the line buffer
+	size_t lineSize = 0;
+	// Version of the file
+	int version = 0;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	checkpointHdl = fopen(checkpointPtr -> path, "r");
+	
+	// Nothing to resume: the run starts from the beginning
+	if (checkpointHdl == NULL) {
+		warning(stream, "No checkpoint found, starting from the first date");
+		return isl_stat_ok;
+	}
+	
+	if (getline(&line, &lineSize, checkpointHdl) < 0 || strncmp(line, checkpointHeader, strlen(checkpointHeader)) != 0 ||
+		sscanf(line + strlen(checkpointHeader), "%d", &version) != 1 || version != CHECKPOINTVERSION) {
+		error(stream, "Unknown checkpoint format");
+		free(line);
+		fclose(checkpointHdl);
+		return isl_stat_error;
+	}
+	
+	checkpointPtr -> linearizedSchedulePtr = calloc(checkpointPtr -> numTasks, sizeof(isl_union_map *));
+	
+	if (checkpointPtr -> linearizedSchedulePtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		free(line);
+		fclose(checkpointHdl);
+		return isl_stat_error;
+	}
+	
+	while (outcome == isl_stat_ok && getline(&line, &lineSize, checkpointHdl) >= 0)
+		outcome = checkpoint_line_parse(stream, optionsHdl, checkpointPtr, line);
+	
+	free(line);
+	fclose(checkpointHdl);
+	
+	if (outcome == isl_stat_ok && !checkpointPtr -> tasksChecked) {
+		error(stream, "The checkpoint has no tasks");
+		outcome = isl_stat_error;
+	}
+	
+	if (outcome == isl_stat_ok && !checkpointPtr -> banksChecked) {
+		error(stream, "The checkpoint has no number of banks");
+		outcome = isl_stat_error;
+	}
+	
+	if (outcome == isl_stat_ok && !checkpointPtr -> keyChecked) {
+		error(stream, "The checkpoint has no key");
+		outcome = isl_stat_error;
+	}
+	
+	if (outcome == isl_stat_ok && (checkpointPtr -> cost == NULL || checkpointPtr -> processedDatesPtr == NULL)) {
+		error(stream, "Incomplete checkpoint");
+		outcome = isl_stat_error;
+	}
+	
+	return outcome;
+}
+
+isl_stat checkpoint_line_parse(FILE * stream, isl_ctx * optionsHdl, checkpoint * checkpointPtr, char * line) {
+	// Keyword of the line
+	char keyword[16];
+	// Position in the line
+	int position = 0;
+	// Characters consumed by the last conversion
+	int consumed = 0;
+	// Number read from the line
+	unsigned num = 0;
+	// Task name read from the line
+	char name[1024];
+	// Key read from the line
+	unsigned long key = 0;
+	
+	if (sscanf(line, "%15s%n", keyword, &position) != 1)
+		return isl_stat_ok;
+	
+	if (strcmp(keyword, "tasks") == 0) {
+		// The checkpoint must belong to the same tasks, in the same order
+		if (sscanf(line + position, "%u%n", &num, &consumed) != 1 || num != checkpointPtr -> numTasks) {
+			error(stream, "The checkpoint belongs to a different set of tasks");
+			return isl_stat_error;
+		}
+		
+		for (int i = 0; i < num; i++) {
+			position += consumed;
+			
+			if (sscanf(line + position, "%1023s%n", name, &consumed) != 1 || strcmp(name, checkpointPtr -> tasks[i]) != 0) {
+				error(stream, "The checkpoint belongs to a different set of tasks");
+				return isl_stat_error;
+			}
+		}
+		
+		checkpointPtr -> tasksChecked = 1;
+	} else if (strcmp(keyword, "banks") == 0) {
+		if (sscanf(line + position, "%u", &num) != 1 || num != checkpointPtr -> numBanks) {
+			error(stream, "The checkpoint belongs to a different number of banks");
+			return isl_stat_error;
+		}
+		
+		checkpointPtr -> banksChecked = 1;
+	} else if (strcmp(keyword, "key") == 0) {
+		// The same tasks may have been evaluated on another architecture or with other options
+		if (sscanf(line + position, "%lx", &key) != 1 || key != checkpointPtr -> key) {
+			error(stream, "The checkpoint belongs to a different architecture or to different options");
+			return isl_stat_error;
+		}
+		
+		checkpointPtr -> keyChecked = 1;
+	} else if (strcmp(keyword, "costs") == 0) {
+		if (sscanf(line + position, "%u%n", &(checkpointPtr -> numLattices), &consumed) != 1 || checkpointPtr -> cost != NULL) {
+			error(stream, "Malformed costs in the checkpoint");
+			return isl_stat_error;
+		}
+		
+		checkpointPtr -> cost = malloc(checkpointPtr -> numLattices * sizeof(unsigned long));
+		
+		if (checkpointPtr -> cost == NULL) {
+			error(stream, "Memory allocation problem :(");
+			return isl_stat_error;
+		}
+		
+		for (int i = 0; i < checkpointPtr -> numLattices; i++) {
+			position += consumed;
+			
+			if (sscanf(line + position, "%lu%n", &(checkpointPtr -> cost[i]), &consumed) != 1) {
+				error(stream, "Malformed costs in the checkpoint");
+				return isl_stat_error;
+			}
+		}
+	} else if (strcmp(keyword, "metrics") == 0) {
+		if (sscanf(line + position, "%u%n", &num, &consumed) != 1 || num != checkpointPtr -> numLattices || checkpointPtr -> metrics != NULL) {
+			error(stream, "Malformed metrics in the checkpoint");
+			return isl_stat_error;
+		}
+		
+		checkpointPtr -> metrics = malloc(num * sizeof(lattice_metrics));
+		
+		if (checkpointPtr -> metrics == NULL) {
+			error(stream, "Memory allocation problem :(");
+			return isl_stat_error;
+		}
+		
+		for (int i = 0; i < num; i++) {
+			position += consumed;
+			
+			if (sscanf(line + position, "%lu %lu %lu%n", &(checkpointPtr -> metrics[i].worstDate), &(checkpointPtr -> metrics[i].sumSquares), &(checkpointPtr -> metrics[i].imbalance), &consumed) != 3) {
+				error(stream, "Malformed metrics in the checkpoint");
+				return isl_stat_error;
+			}
+		}
+	} else if (strcmp(keyword, "stats") == 0) {
+		if (sscanf(line + position, "%lu %lu %lu", &(checkpointPtr -> dates), &(checkpointPtr -> points), &(checkpointPtr -> lattices)) != 3) {
+			error(stream, "Malformed statistics in the checkpoint");
+			return isl_stat_error;
+		}
+	} else if (strcmp(keyword, "processed") == 0) {
+		isl_set_free(checkpointPtr -> processedDatesPtr);
+		checkpointPtr -> processedDatesPtr = isl_set_read_from_str(optionsHdl, line + position);
+		
+		if (checkpointPtr -> processedDatesPtr == NULL) {
+			error(stream, "Malformed processed dates in the checkpoint");
+			return isl_stat_error;
+		}
+	} else if (strcmp(keyword, "linearized") == 0) {
+		if (sscanf(line + position, "%u%n", &num, &consumed) != 1 || num >= checkpointPtr -> numTasks) {
+			error(stream, "Malformed linearized schedule in the checkpoint");
+			return isl_stat_error;
+		}
+		
+		isl_union_map_free(checkpointPtr -> linearizedSchedulePtr[num]);
+		checkpointPtr -> linearizedSchedulePtr[num] = isl_union_map_read_from_str(optionsHdl, line + position + consumed);
+		
+		if (checkpointPtr -> linearizedSchedulePtr[num] == NULL) {
+			error(stream, "Malformed linearized schedule in the checkpoint");
+			return isl_stat_error;
+		}
+	} else {
+		error(stream, "Unknown line in the checkpoint");
+		return isl_stat_error;
+	}
+	
+	return isl_stat_ok;
+}
+
+isl_bool checkpoint_linearization_restore(checkpoint * checkpointPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr) {
+	
+	if (checkpointPtr -> cost == NULL)
+		return isl_bool_false;
+	
+	for (int i = 0; i < checkpointPtr -> numTasks; i++)
+		if (checkpointPtr -> linearizedSchedulePtr[i] == NULL)
+			return isl_bool_false;
+	
+	// The cached linearizations are handed over to the models
+	for (int i = 0; i < checkpointPtr -> numTasks; i++) {
+		isl_union_map_free(modifiedPolyhedralModelPtr[i] -> linearizedSchedule);
+		modifiedPolyhedralModelPtr[i] -> linearizedSchedule = checkpointPtr -> linearizedSchedulePtr[i];
+		checkpointPtr -> linearizedSchedulePtr[i] = NULL;
+	}
+	
+	return isl_bool_true;
+}
+
+isl_set * checkpoint_resume(FILE * stream, checkpoint * checkpointPtr, isl_set * linearizedDatesPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned long * cost, lattice_metrics * metrics, unsigned numLattices, run_statistics * statsPtr) {
+	
+	checkpointPtr -> modifiedPolyhedralModelPtr = modifiedPolyhedralModelPtr;
+	checkpointPtr -> runCost = cost;
+	checkpointPtr -> runMetrics = metrics;
+	checkpointPtr -> runLattices = numLattices;
+	checkpointPtr -> statsPtr = statsPtr;
+	checkpointPtr -> lastWrite = wall_clock();
+	
+	if (checkpointPtr -> cost == NULL) {
+		checkpointPtr -> processedDatesPtr = isl_set_empty(isl_set_get_space(linearizedDatesPtr));
+		return isl_set_copy(linearizedDatesPtr);
+	}
+	
+	if (checkpointPtr -> numLattices != numLattices) {
+		error(stream, "The checkpoint belongs to a different lattice catalog");
+		return NULL;
+	}
+	
+	// A lattice rejected when the checkpoint was written has no partial cost to add to
+	for (int i = 0; i < numLattices; i++)
+		if (cost[i] != ULONG_MAX && checkpointPtr -> cost[i] == ULONG_MAX) {
+			error(stream, "The checkpoint rejected a lattice kept by this run");
+			return NULL;
+		}
+	
+	for (int i = 0; i < numLattices; i++)
+		cost[i] = checkpointPtr -> cost[i];
+	
+	if (metrics != NULL && checkpointPtr -> metrics != NULL)
+		for (int i = 0; i < numLattices; i++)
+			metrics[i] = checkpointPtr -> metrics[i];
+	
+	statsPtr -> dates += checkpointPtr -> dates;
+	statsPtr -> points += checkpointPtr -> points;
+	statsPtr -> lattices += checkpointPtr -> lattices;
+	
+	// Only the dates never evaluated are left
+	return isl_set_subtract(isl_set_copy(linearizedDatesPtr), isl_set_copy(checkpointPtr -> processedDatesPtr));
+}
+
+isl_stat checkpoint_date_done(FILE * stream, checkpoint * checkpointPtr, isl_point * datePtr) {
+	// Current time
+	double now = 0;
+	
+	// A coalescence at every date would cost more as the dates add up, so they are only gathered here
+	if (checkpointPtr -> pendingDatesPtr == NULL)
+		checkpointPtr -> pendingDatesPtr = isl_set_from_point(isl_point_copy(datePtr));
+	else
+		checkpointPtr -> pendingDatesPtr = isl_set_union(checkpointPtr -> pendingDatesPtr, isl_set_from_point(isl_point_copy(datePtr)));
+	
+	if (checkpointPtr -> pendingDatesPtr == NULL)
+		return isl_stat_error;
+	
+	checkpointPtr -> numPending++;
+	
+	if (checkpointPtr -> numPending >= CHECKPOINTPENDING && checkpoint_pending_fold(checkpointPtr) == isl_stat_error)
+		return isl_stat_error;
+	
+	now = wall_clock();
+	
+	if (now - checkpointPtr -> lastWrite < checkpointPtr -> interval)
+		return isl_stat_ok;
+	
+	checkpointPtr -> lastWrite = now;
+	
+	// A checkpoint which cannot be written does not stop the run
+	if (checkpoint_write(stream, checkpointPtr) == isl_stat_error)
+		warning(stream, "Cannot write the checkpoint");
+	
+	return isl_stat_ok;
+}
+
+isl_stat checkpoint_pending_fold(checkpoint * checkpointPtr) {
+	
+	if (checkpointPtr -> pendingDatesPtr == NULL)
+		return isl_stat_ok;
+	
+	checkpointPtr -> processedDatesPtr = isl_set_coalesce(isl_set_union(checkpointPtr -> processedDatesPtr, checkpointPtr -> pendingDatesPtr));
+	checkpointPtr -> pendingDatesPtr = NULL;
+	checkpointPtr -> numPending = 0;
+	
+	return checkpointPtr -> processedDatesPtr != NULL ? isl_stat_ok : isl_stat_error;
+}
+
+isl_stat checkpoint_write(FILE * stream, checkpoint * checkpointPtr) {
+	// Name of the temporary file, renamed over the checkpoint once complete
+	char * temporaryPath = NULL;
+	// Handle to the temporary file
+	FILE * checkpointHdl = NULL;
+	// Textual form of an isl object
+	char * text = NULL;
+	// Statistics of the run
+	run_statistics * statsPtr = checkpointPtr -> statsPtr;
+	
+	// The costs written count every date evaluated so far, so the processed dates must too
+	if (checkpoint_pending_fold(checkpointPtr) == isl_stat_error)
+		return isl_stat_error;
+	
+	temporaryPath = malloc(strlen(checkpointPtr -> path) + strlen(temporarySuffix) + 1);
+	
+	if (temporaryPath == NULL)
+		return isl_stat_error;
+	
+	sprintf(temporaryPath, "%s%s", checkpointPtr -> path, temporarySuffix);
+	checkpointHdl = fopen(temporaryPath, "w");
+	
+	if (checkpointHdl == NULL) {
+		free(temporaryPath);
+		return isl_stat_error;
+	}
+	
+	fprintf(checkpointHdl, "%s %d\n", checkpointHeader, CHECKPOINTVERSION);
+	fprintf(checkpointHdl, "tasks %u", checkpointPtr -> numTasks);
+	
+	for (int i = 0; i < checkpointPtr -> numTasks; i++)
+		fprintf(checkpointHdl, " %s", checkpointPtr -> tasks[i]);
+	
+	fprintf(checkpointHdl, "\nbanks %u\nkey %lx\ncosts %u", checkpointPtr -> numBanks, checkpointPtr -> key, checkpointPtr -> runLattices);
+	
+	for (int i = 0; i < checkpointPtr -> runLattices; i++)
+		fprintf(checkpointHdl, " %lu", checkpointPtr -> runCost[i]);
+	
+	if (checkpointPtr -> runMetrics != NULL) {
+		fprintf(checkpointHdl, "\nmetrics %u", checkpointPtr -> runLattices);
+		
+		for (int i = 0; i < checkpointPtr -> runLattices; i++)
+			fprintf(checkpointHdl, " %lu %lu %lu", checkpointPtr -> runMetrics[i].worstDate, checkpointPtr -> runMetrics[i].sumSquares, checkpointPtr -> runMetrics[i].imbalance);
+	}
+	
+	fprintf(checkpointHdl, "\nstats %lu %lu %lu\n", statsPtr -> dates, statsPtr -> points, statsPtr -> lattices);
+	
+	text = isl_set_to_str(checkpointPtr -> processedDatesPtr);
+	fprintf(checkpointHdl, "processed %s\n", text);
+	free(text);
+	
+	for (int i = 0; i < checkpointPtr -> numTasks; i++) {
+		text = isl_union_map_to_str(checkpointPtr -> modifiedPolyhedralModelPtr[i] -> linearizedSchedule);
+		fprintf(checkpointHdl, "linearized %d %s\n", i, text);
+		free(text);
+	}
+	
+	if (fclose(checkpointHdl) != 0 || rename(temporaryPath, checkpointPtr -> path) != 0) {
+		unlink(temporaryPath);
+		free(temporaryPath);
+		return isl_stat_error;
+	}
+	
+	free(temporaryPath);
+	
+	return isl_stat_ok;
+}
+
+void checkpoint_remove(checkpoint * checkpointPtr) {
+	unlink(checkpointPtr -> path);
+}
+
+void checkpoint_free(checkpoint * checkpointPtr) {
+	
+	if (checkpointPtr == NULL)
+		return;
+	
+	if (checkpointPtr -> linearizedSchedulePtr != NULL)
+		for (int i = 0; i < checkpointPtr -> numTasks; i++)
+			isl_union_map_free(checkpointPtr -> linearizedSchedulePtr[i]);
+	
+	free(checkpointPtr -> linearizedSchedulePtr);
+	free(checkpointPtr -> cost);
+	free(checkpointPtr -> metrics);
+	isl_set_free(checkpointPtr -> processedDatesPtr);
+	isl_set_free(checkpointPtr -> pendingDatesPtr);
+	free(checkpointPtr);
+}
@@ -0,0 +1,64 @@
+/*
+ * Definitions of the checkpoints of the cost function computation. A
+ * checkpoint holds the dates already evaluated, the partial cost of each
+ * lattice and the linearized schedules, so that an interrupted run can be
+ * resumed without evaluating any date twice. Its key hashes the architecture
+ * and the options which change the costs, so that a checkpoint is never
+ * resumed by a run which would compute different ones.
+ */
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include<stdio.h>
+
+#include<isl/ctx.h>
+#include<isl/set.h>
+#include<isl/union_map.h>
+
+#include "config.h"
+#include "model.h"
+#include "support.h"
+#include "ranking.h"
+
+typedef struct {
+	const char * path;
+	double interval;
+	double lastWrite;
+	char ** tasks;
+	unsigned numTasks;
+	unsigned numBanks;
+	unsigned long key;
+	// Lines of the file which identify the run, all of them required
+	unsigned tasksChecked;
+	unsigned banksChecked;
+	unsigned keyChecked;
+	// Restored from the file, if any
+	unsigned numLattices;
+	unsigned long * cost;
+	lattice_metrics * metrics;
+	unsigned long dates;
+	unsigned long points;
+	unsigned long lattices;
+	isl_union_map ** linearizedSchedulePtr;
+	// Progress of the current run, the latest dates being folded into the processed ones in batches
+	isl_set * processedDatesPtr;
+	isl_set * pendingDatesPtr;
+	unsigned numPending;
+	manipulated_polyhedral_model ** modifiedPolyhedralModelPtr;
+	unsigned long * runCost;
+	lattice_metrics * runMetrics;
+	unsigned runLattices;
+	run_statistics * statsPtr;
+} checkpoint;
+
+unsigned long checkpoint_key(const architecture_config *, const run_options *);
+checkpoint * checkpoint_alloc(const char *, double, char **, unsigned, unsigned, unsigned long);
+isl_stat checkpoint_load(FILE *, isl_ctx *, checkpoint *);
+isl_bool checkpoint_linearization_restore(checkpoint *, manipulated_polyhedral_model **);
+isl_set * checkpoint_resume(FILE *, checkpoint *, isl_set *, manipulated_polyhedral_model **, unsigned long *, lattice_metrics *, unsigned, run_statistics *);
+isl_stat checkpoint_date_done(FILE *, checkpoint *, isl_point *);
+isl_stat checkpoint_write(FILE *, checkpoint *);
+void checkpoint_remove(checkpoint *);
+void checkpoint_free(checkpoint *);
+
+#endif /* CHECKPOINT_H */
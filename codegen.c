@@ -0,0 +1,532 @@
+/*
+ * Implementation of the generator of the bank mapping function of a lattice.
+ * The lattice is the set of the differences between two points of the first
+ * translate; its basis is taken in Hermite normal form, column by column, as
+ * the lexicographically smallest vector with the expected leading zeros. An
+ * address is reduced by the columns in order, leaving a residue inside the
+ * fundamental parallelepiped, which a table maps to the number of the bank of
+ * the catalog, and the quotients, which give the offset inside the bank.
+ */
+#include<stdlib.h>
+#include<string.h>
+
+#include<isl/set.h>
+#include<isl/map.h>
+#include<isl/union_map.h>
+#include<isl/val.h>
+
+#include "support.h"
+#include "model.h"
+#include "codegen.h"
+
+// Mappings performed by the generated micro - benchmark, at least one scan of the address space
+#define BENCHMARKMAPPINGS 100000000UL
+
+long floor_div(long, long);
+unsigned is_power_of_two(long);
+unsigned log_two(long);
+isl_stat point_coordinates(isl_point *, unsigned, long *);
+isl_stat basis_column(isl_set *, unsigned, unsigned, long *);
+unsigned long bank_mapping_reduce(bank_mapping *, const long *, long *);
+void quotient_bounds(bank_mapping *);
+isl_stat bank_mapping_checks(bank_mapping *, isl_set **, isl_set *);
+void bank_mapping_generate_reduction(FILE *, bank_mapping *);
+void bank_mapping_generate_checks(FILE *, bank_mapping *);
+void indent(FILE *, unsigned);
+
+bank_mapping * bank_mapping_build(FILE * stream, isl_set ** translatesPtr, unsigned numBanks, isl_set * addressSpacePtr) {
+	// Mapping to be built
+	bank_mapping * mappingPtr = NULL;
+	// Fundamental lattice
+	isl_set * latticePtr = NULL;
+	// Bound of the address space
+	isl_val * boundVal = NULL;
+	// Point of a translate
+	isl_point * pointPtr = NULL;
+	// Coordinates of a point
+	long * address = NULL;
+	// Index of the fundamental lattice, that is the product of the diagonal
+	long index = 1;
+	// Residue of a point
+	unsigned long residue = 0;
+	// Dimensionality of the address space
+	unsigned dim = isl_set_dim(translatesPtr[0], isl_dim_set);
+	
+	mappingPtr = calloc(1, sizeof(bank_mapping));
+	
+	if (mappingPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	mappingPtr -> dim = dim;
+	mappingPtr -> numBanks = numBanks;
+	mappingPtr -> basis = calloc(dim * dim, sizeof(long));
+	mappingPtr -> bankTable = malloc(numBanks * sizeof(unsigned));
+	mappingPtr -> addressMin = malloc(dim * sizeof(long));
+	mappingPtr -> addressMax = malloc(dim * sizeof(long));
+	mappingPtr -> quotientMin = malloc(dim * sizeof(long));
+	mappingPtr -> quotientMax = malloc(dim * sizeof(long));
+	mappingPtr -> checkAddress = malloc(2 * numBanks * dim * sizeof(long));
+	mappingPtr -> checkBank = malloc(2 * numBanks * sizeof(unsigned));
+	address = malloc(dim * sizeof(long));
+	
+	if (mappingPtr -> basis == NULL || mappingPtr -> bankTable == NULL || mappingPtr -> addressMin == NULL || mappingPtr -> addressMax == NULL ||
+		mappingPtr -> quotientMin == NULL || mappingPtr -> quotientMax == NULL || mappingPtr -> checkAddress == NULL || mappingPtr -> checkBank == NULL || address == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto failure;
+	}
+	
+	latticePtr = isl_set_coalesce(isl_map_deltas(isl_map_from_domain_and_range(isl_set_copy(translatesPtr[0]), isl_set_copy(translatesPtr[0]))));
+	
+	for (int i = 0; i < dim; i++) {
+		if (basis_column(latticePtr, i, numBanks, mappingPtr -> basis) == isl_stat_error) {
+			error(stream, "The translates do not describe a lattice");
+			goto failure;
+		}
+		
+		index *= mappingPtr -> basis[i * dim + i];
+	}
+	
+	if (index != numBanks) {
+		error(stream, "The lattice does not have one translate per bank");
+		goto failure;
+	}
+	
+	// Each translate is a coset of the lattice, recognised by the residue of any of its points
+	for (int b = 0; b < numBanks; b++)
+		mappingPtr -> bankTable[b] = numBanks;
+	
+	for (int b = 0; b < numBanks; b++) {
+		pointPtr = isl_set_sample_point(isl_set_copy(translatesPtr[b]));
+		
+		if (point_coordinates(pointPtr, dim, address) == isl_stat_error) {
+			error(stream, "Empty translate");
+			goto failure;
+		}
+		
+		residue = bank_mapping_reduce(mappingPtr, address, NULL);
+		
+		if (mappingPtr -> bankTable[residue] != numBanks) {
+			error(stream, "Two translates of the same coset of the lattice");
+			goto failure;
+		}
+		
+		mappingPtr -> bankTable[residue] = b;
+	}
+	
+	for (int i = 0; i < dim; i++) {
+		boundVal = isl_set_dim_min_val(isl_set_copy(addressSpacePtr), i);
+		
+		if (boundVal == NULL || !isl_val_is_int(boundVal)) {
+			error(stream, "Unbounded address space");
+			isl_val_free(boundVal);
+			goto failure;
+		}
+		
+		mappingPtr -> addressMin[i] = isl_val_get_num_si(boundVal);
+		isl_val_free(boundVal);
+		boundVal = isl_set_dim_max_val(isl_set_copy(addressSpacePtr), i);
+		
+		if (boundVal == NULL || !isl_val_is_int(boundVal)) {
+			error(stream, "Unbounded address space");
+			isl_val_free(boundVal);
+			goto failure;
+		}
+		
+		mappingPtr -> addressMax[i] = isl_val_get_num_si(boundVal);
+		isl_val_free(boundVal);
+	}
+	
+	quotient_bounds(mappingPtr);
+	
+	if (bank_mapping_checks(mappingPtr, translatesPtr, addressSpacePtr) == isl_stat_error) {
+		error(stream, "Error during the choice of the addresses to check");
+		goto failure;
+	}
+	
+	isl_set_free(latticePtr);
+	free(address);
+	
+	return mappingPtr;
+
+failure:
+	isl_set_free(latticePtr);
+	free(address);
+	bank_mapping_free(mappingPtr);
+	
+	return NULL;
+}
+
+// The column is the smallest lattice vector with i leading zeros; the other coordinates can be taken in [0, numBanks), since numBanks * Z^dim is in the lattice
+isl_stat basis_column(isl_set * latticePtr, unsigned i, unsigned numBanks, long * basis) {
+	// Candidates for the column
+	isl_set * candidatesPtr = isl_set_copy(latticePtr);
+	// Column of the basis
+	isl_point * pointPtr = NULL;
+	// Dimensionality of the lattice
+	unsigned dim = isl_set_dim(latticePtr, isl_dim_set);
+	// Coordinates of the column
+	long * column = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	for (int j = 0; j < dim; j++)
+		if (j < i)
+			candidatesPtr = isl_set_fix_si(candidatesPtr, isl_dim_set, j, 0);
+		else {
+			candidatesPtr = isl_set_lower_bound_si(candidatesPtr, isl_dim_set, j, j == i ? 1 : 0);
+			candidatesPtr = isl_set_upper_bound_si(candidatesPtr, isl_dim_set, j, j == i ? numBanks : numBanks - 1);
+		}
+	
+	pointPtr = isl_set_sample_point(isl_set_lexmin(candidatesPtr));
+	column = malloc(dim * sizeof(long));
+	
+	if (column == NULL) {
+		isl_point_free(pointPtr);
+		return isl_stat_error;
+	}
+	
+	outcome = point_coordinates(pointPtr, dim, column);
+	
+	for (int j = 0; j < dim; j++)
+		basis[j * dim + i] = column[j];
+	
+	free(column);
+	
+	return outcome;
+}
+
+isl_stat point_coordinates(isl_point * pointPtr, unsigned dim, long * coordinates) {
+	// Coordinate of the point
+	isl_val * coordinateVal = NULL;
+	
+	if (pointPtr == NULL || isl_point_is_void(pointPtr) != isl_bool_false) {
+		isl_point_free(pointPtr);
+		return isl_stat_error;
+	}
+	
+	for (int j = 0; j < dim; j++) {
+		coordinateVal = isl_point_get_coordinate_val(pointPtr, isl_dim_set, j);
+		coordinates[j] = isl_val_get_num_si(coordinateVal);
+		isl_val_free(coordinateVal);
+	}
+	
+	isl_point_free(pointPtr);
+	
+	return isl_stat_ok;
+}
+
+unsigned long bank_mapping_reduce(bank_mapping * mappingPtr, const long * address, long * quotient) {
+	// Dimensionality of the address space
+	unsigned dim = mappingPtr -> dim;
+	// Address being reduced
+	long reduced[dim];
+	// Quotient of the current dimension
+	long q = 0;
+	// Residue, in mixed radix over the diagonal of the basis
+	unsigned long residue = 0;
+	// Weight of the current dimension in the residue
+	unsigned long radix = 1;
+	
+	memcpy(reduced, address, dim * sizeof(long));
+	
+	for (int i = 0; i < dim; i++) {
+		q = floor_div(reduced[i], mappingPtr -> basis[i * dim + i]);
+		
+		for (int j = i; j < dim; j++)
+			reduced[j] -= q * mappingPtr -> basis[j * dim + i];
+		
+		residue += reduced[i] * radix;
+		radix *= mappingPtr -> basis[i * dim + i];
+		
+		if (quotient != NULL)
+			quotient[i] = q;
+	}
+	
+	return residue;
+}
+
+void bank_mapping_apply(bank_mapping * mappingPtr, const long * address, unsigned * bankPtr, unsigned long * offsetPtr) {
+	// Quotients of the address
+	long quotient[mappingPtr -> dim];
+	
+	*bankPtr = mappingPtr -> bankTable[bank_mapping_reduce(mappingPtr, address, quotient)];
+	*offsetPtr = 0;
+	
+	// Row - major over the ranges of the quotients
+	for (int i = 0; i < mappingPtr -> dim; i++)
+		*offsetPtr = *offsetPtr * (mappingPtr -> quotientMax[i] - mappingPtr -> quotientMin[i] + 1) + quotient[i] - mappingPtr -> quotientMin[i];
+}
+
+unsigned long bank_mapping_capacity(bank_mapping * mappingPtr) {
+	// Words reserved in each bank
+	unsigned long capacity = 1;
+	
+	for (int i = 0; i < mappingPtr -> dim; i++)
+		capacity *= mappingPtr -> quotientMax[i] - mappingPtr -> quotientMin[i] + 1;
+	
+	return capacity;
+}
+
+// Interval arithmetic over the box of the address space: the ranges may be larger than needed, but never smaller
+void quotient_bounds(bank_mapping * mappingPtr) {
+	// Dimensionality of the address space
+	unsigned dim = mappingPtr -> dim;
+	// Range of the reduced coordinate
+	long low = 0, high = 0;
+	// Entry of the basis
+	long h = 0;
+	
+	for (int i = 0; i < dim; i++) {
+		low = mappingPtr -> addressMin[i];
+		high = mappingPtr -> addressMax[i];
+		
+		for (int j = 0; j < i; j++) {
+			h = mappingPtr -> basis[i * dim + j];
+			low -= h > 0 ? h * mappingPtr -> quotientMax[j] : h * mappingPtr -> quotientMin[j];
+			high -= h > 0 ? h * mappingPtr -> quotientMin[j] : h * mappingPtr -> quotientMax[j];
+		}
+		
+		mappingPtr -> quotientMin[i] = floor_div(low, mappingPtr -> basis[i * dim + i]);
+		mappingPtr -> quotientMax[i] = floor_div(high, mappingPtr -> basis[i * dim + i]);
+	}
+}
+
+// The first and the last address of each translate in the address space, whose bank does not depend on the reduction
+isl_stat bank_mapping_checks(bank_mapping * mappingPtr, isl_set ** translatesPtr, isl_set * addressSpacePtr) {
+	// Addresses of a translate in the address space
+	isl_set * addressesPtr = NULL;
+	// Address to check
+	isl_point * pointPtr = NULL;
+	
+	mappingPtr -> numChecks = 0;
+	
+	for (int b = 0; b < mappingPtr -> numBanks; b++) {
+		addressesPtr = isl_set_intersect(isl_set_copy(translatesPtr[b]), isl_set_copy(addressSpacePtr));
+		
+		if (addressesPtr == NULL)
+			return isl_stat_error;
+		
+		for (int extreme = 0; extreme < 2; extreme++) {
+			pointPtr = isl_set_sample_point(extreme == 0 ? isl_set_lexmin(isl_set_copy(addressesPtr)) : isl_set_lexmax(isl_set_copy(addressesPtr)));
+			
+			// A bank with no address of the address space has nothing to check
+			if (point_coordinates(pointPtr, mappingPtr -> dim, mappingPtr -> checkAddress + mappingPtr -> numChecks * mappingPtr -> dim) == isl_stat_error)
+				continue;
+			
+			mappingPtr -> checkBank[mappingPtr -> numChecks++] = b;
+		}
+		
+		isl_set_free(addressesPtr);
+	}
+	
+	return isl_stat_ok;
+}
+
+isl_set * address_space_range(manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks) {
+	// Addresses accessed by any of the tasks
+	isl_union_set * addressesPtr = NULL;
+	
+	for (int i = 0; i < numTasks; i++) {
+		addressesPtr = addressesPtr == NULL ? isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads)) :
+			isl_union_set_union(addressesPtr, isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads)));
+		addressesPtr = isl_union_set_union(addressesPtr, isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayWrites)));
+		addressesPtr = isl_union_set_union(addressesPtr, isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMustWrites)));
+	}
+	
+	return isl_set_coalesce(isl_set_from_union_set(addressesPtr));
+}
+
+isl_stat bank_mapping_generate(FILE * stream, const char * path, bank_mapping * mappingPtr, unsigned latticeIdx) {
+	// Handle to the generated source
+	FILE * sourceHdl = NULL;
+	// Dimensionality of the address space
+	unsigned dim = mappingPtr -> dim;
+	// Number of addresses of the box of the address space
+	unsigned long boxSize = 1;
+	
+	for (int i = 0; i < dim; i++)
+		boxSize *= mappingPtr -> addressMax[i] - mappingPtr -> addressMin[i] + 1;
+	
+	sourceHdl = fopen(path, "w");
+	
+	if (sourceHdl == NULL) {
+		error(stream, "Cannot create the source of the bank mapping");
+		return isl_stat_error;
+	}
+	
+	fprintf(sourceHdl, "/*\n * Bank mapping of the fundamental lattice %u, generated by uma. Compile with\n", latticeIdx);
+	fprintf(sourceHdl, " * -DUMA_BANK_MAP_BENCHMARK to check uma_bank_map on the first and the last address\n");
+	fprintf(sourceHdl, " * of each bank, then to measure its throughput.\n */\n");
+	fprintf(sourceHdl, "#define UMA_DIM %u\n#define UMA_BANKS %u\n#define UMA_BANK_CAPACITY %luUL\n\n", dim, mappingPtr -> numBanks, bank_mapping_capacity(mappingPtr));
+	fprintf(sourceHdl, "static const unsigned umaBankTable[UMA_BANKS] = {");
+	
+	for (int b = 0; b < mappingPtr -> numBanks; b++)
+		fprintf(sourceHdl, "%s%u", b > 0 ? ", " : " ", mappingPtr -> bankTable[b]);
+	
+	fprintf(sourceHdl, " };\n\n");
+	fprintf(sourceHdl, "static inline void uma_bank_map(const long address[UMA_DIM], unsigned * bank, unsigned long * offset) {\n");
+	bank_mapping_generate_reduction(sourceHdl, mappingPtr);
+	fprintf(sourceHdl, "}\n\n");
+	
+	// The micro - benchmark checks the addresses taken from the translates, then scans the whole box of the address space
+	fprintf(sourceHdl, "#ifdef UMA_BANK_MAP_BENCHMARK\n#include <stdio.h>\n#include <time.h>\n\n");
+	
+	if (mappingPtr -> numChecks > 0)
+		bank_mapping_generate_checks(sourceHdl, mappingPtr);
+	
+	fprintf(sourceHdl, "int main(void) {\n\tlong address[UMA_DIM];\n\tunsigned bank = 0;\n\tunsigned long offset = 0, checksum = 0, calls = 0;\n\tstruct timespec start, stop;\n\tdouble seconds = 0;\n\n");
+	
+	if (mappingPtr -> numChecks > 0) {
+		fprintf(sourceHdl, "\tfor (unsigned c = 0; c < UMA_CHECKS; c++) {\n\t\tuma_bank_map(umaCheckAddress[c], &bank, &offset);\n\n");
+		fprintf(sourceHdl, "\t\tif (bank != umaCheckBank[c] || offset >= UMA_BANK_CAPACITY) {\n");
+		fprintf(sourceHdl, "\t\t\tprintf(\"Address %%u mapped to bank %%u at offset %%lu, expected bank %%u\\n\", c, bank, offset, umaCheckBank[c]);\n\t\t\treturn 1;\n\t\t}\n\t}\n\n");
+		fprintf(sourceHdl, "\tprintf(\"%%u addresses mapped to the banks of their translates\\n\", UMA_CHECKS);\n");
+	}
+	
+	fprintf(sourceHdl, "\tclock_gettime(CLOCK_MONOTONIC, &start);\n\n\tfor (unsigned long round = 0; round < %luUL; round++)\n", BENCHMARKMAPPINGS / boxSize > 0 ? BENCHMARKMAPPINGS / boxSize : 1);
+	
+	for (int i = 0; i < dim; i++) {
+		indent(sourceHdl, i + 2);
+		fprintf(sourceHdl, "for (address[%d] = %ldL; address[%d] <= %ldL; address[%d]++)%s\n", i, mappingPtr -> addressMin[i], i, mappingPtr -> addressMax[i], i, i + 1 < dim ? "" : " {");
+	}
+	
+	indent(sourceHdl, dim + 2);
+	fprintf(sourceHdl, "uma_bank_map(address, &bank, &offset);\n");
+	indent(sourceHdl, dim + 2);
+	fprintf(sourceHdl, "checksum += bank ^ offset;\n");
+	indent(sourceHdl, dim + 2);
+	fprintf(sourceHdl, "calls++;\n");
+	indent(sourceHdl, dim + 1);
+	fprintf(sourceHdl, "}\n\n");
+	fprintf(sourceHdl, "\tclock_gettime(CLOCK_MONOTONIC, &stop);\n\tseconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) * 1e-9;\n");
+	fprintf(sourceHdl, "\tprintf(\"%%lu mappings in %%.6f s: %%.2f Mmappings/s (checksum %%lu)\\n\", calls, seconds, calls / seconds * 1e-6, checksum);\n\n\treturn 0;\n}\n#endif\n");
+	
+	if (fclose(sourceHdl) != 0) {
+		error(stream, "Cannot write the source of the bank mapping");
+		return isl_stat_error;
+	}
+	
+	return isl_stat_ok;
+}
+
+// Every constant of the basis is folded in, and the dimensions with a unit or power - of - two diagonal need no division
+void bank_mapping_generate_reduction(FILE * sourceHdl, bank_mapping * mappingPtr) {
+	// Dimensionality of the address space
+	unsigned dim = mappingPtr -> dim;
+	// Entry of the basis
+	long h = 0;
+	// Weight of the current dimension in the residue
+	unsigned long radix = 1;
+	
+	for (int i = 0; i < dim; i++)
+		fprintf(sourceHdl, "\tlong x%d = address[%d];\n", i, i);
+	
+	fprintf(sourceHdl, "\tunsigned long residue = 0;\n");
+	
+	for (int i = 0; i < dim; i++) {
+		h = mappingPtr -> basis[i * dim + i];
+		
+		if (h == 1)
+			fprintf(sourceHdl, "\tlong q%d = x%d;\n", i, i);
+		else if (is_power_of_two(h)) {
+			// The arithmetic shift is a floor division also for negative addresses
+			fprintf(sourceHdl, "\tlong q%d = x%d >> %u;\n", i, i, log_two(h));
+			fprintf(sourceHdl, "\tresidue += (unsigned long)(x%d & %ldL) * %luUL;\n", i, h - 1, radix);
+		} else {
+			fprintf(sourceHdl, "\tlong r%d = ((x%d %% %ldL) + %ldL) %% %ldL;\n", i, i, h, h, h);
+			fprintf(sourceHdl, "\tlong q%d = (x%d - r%d) / %ldL;\n", i, i, i, h);
+			fprintf(sourceHdl, "\tresidue += (unsigned long)r%d * %luUL;\n", i, radix);
+		}
+		
+		for (int j = i + 1; j < dim; j++)
+			if (mappingPtr -> basis[j * dim + i] == 1)
+				fprintf(sourceHdl, "\tx%d -= q%d;\n", j, i);
+			else if (mappingPtr -> basis[j * dim + i] != 0)
+				fprintf(sourceHdl, "\tx%d -= q%d * %ldL;\n", j, i, mappingPtr -> basis[j * dim + i]);
+		
+		radix *= h;
+	}
+	
+	fprintf(sourceHdl, "\n\t*bank = umaBankTable[residue];\n");
+	fprintf(sourceHdl, "\t*offset = ");
+	
+	for (int i = 0; i < dim; i++) {
+		// Stride of the quotient in the row - major order
+		unsigned long stride = 1;
+		
+		for (int j = i + 1; j < dim; j++)
+			stride *= mappingPtr -> quotientMax[j] - mappingPtr -> quotientMin[j] + 1;
+		
+		fprintf(sourceHdl, "%s(unsigned long)(q%d %c %ldL) * %luUL", i > 0 ? " + " : "", i, mappingPtr -> quotientMin[i] > 0 ? '-' : '+', labs(mappingPtr -> quotientMin[i]), stride);
+	}
+	
+	fprintf(sourceHdl, ";\n");
+}
+
+void bank_mapping_generate_checks(FILE * sourceHdl, bank_mapping * mappingPtr) {
+	// Dimensionality of the address space
+	unsigned dim = mappingPtr -> dim;
+	
+	fprintf(sourceHdl, "#define UMA_CHECKS %u\n\n", mappingPtr -> numChecks);
+	fprintf(sourceHdl, "static const long umaCheckAddress[UMA_CHECKS][UMA_DIM] = {\n");
+	
+	for (int c = 0; c < mappingPtr -> numChecks; c++) {
+		fprintf(sourceHdl, "\t{");
+		
+		for (int i = 0; i < dim; i++)
+			fprintf(sourceHdl, "%s%ldL", i > 0 ? ", " : " ", mappingPtr -> checkAddress[c * dim + i]);
+		
+		fprintf(sourceHdl, " }%s\n", c + 1 < mappingPtr -> numChecks ? "," : "");
+	}
+	
+	fprintf(sourceHdl, "};\n\nstatic const unsigned umaCheckBank[UMA_CHECKS] = {");
+	
+	for (int c = 0; c < mappingPtr -> numChecks; c++)
+		fprintf(sourceHdl, "%s%u", c > 0 ? ", " : " ", mappingPtr -> checkBank[c]);
+	
+	fprintf(sourceHdl, " };\n\n");
+}
+
+void indent(FILE * sourceHdl, unsigned depth) {
+	
+	for (int i = 0; i < depth; i++)
+		fputc('\t', sourceHdl);
+}
+
+long floor_div(long a, long b) {
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+unsigned is_power_of_two(long h) {
+	return h > 0 && (h & (h - 1)) == 0;
+}
+
+unsigned log_two(long h) {
+	// Position of the only bit set
+	unsigned log = 0;
+	
+	while (h > 1) {
+		h >>= 1;
+		log++;
+	}
+	
+	return log;
+}
+
+void bank_mapping_free(bank_mapping * mappingPtr) {
+	
+	if (mappingPtr == NULL)
+		return;
+	
+	free(mappingPtr -> basis);
+	free(mappingPtr -> bankTable);
+	free(mappingPtr -> addressMin);
+	free(mappingPtr -> addressMax);
+	free(mappingPtr -> quotientMin);
+	free(mappingPtr -> quotientMax);
+	free(mappingPtr -> checkAddress);
+	free(mappingPtr -> checkBank);
+	free(mappingPtr);
+}
@@ -0,0 +1,42 @@
+/*
+ * Definitions of the generator of the bank mapping function of a lattice. The
+ * lattice is brought to its Hermite normal form, from which a branch - free C
+ * function is emitted mapping a virtual address to its bank and to its offset
+ * inside the bank, together with a micro - benchmark of its throughput which
+ * first checks it on addresses whose bank is known from the translates.
+ */
+
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include<stdio.h>
+
+#include<isl/set.h>
+
+#include "model.h"
+
+// Mapping of a lattice: the columns of the basis are lower triangular, and
+// every address is reduced by them to a residue, which selects the bank
+typedef struct {
+	unsigned dim;
+	unsigned numBanks;
+	long * basis;
+	unsigned * bankTable;
+	long * addressMin;
+	long * addressMax;
+	long * quotientMin;
+	long * quotientMax;
+	// Addresses whose bank is given by the translates containing them
+	unsigned numChecks;
+	long * checkAddress;
+	unsigned * checkBank;
+} bank_mapping;
+
+bank_mapping * bank_mapping_build(FILE *, isl_set **, unsigned, isl_set *);
+void bank_mapping_apply(bank_mapping *, const long *, unsigned *, unsigned long *);
+unsigned long bank_mapping_capacity(bank_mapping *);
+void bank_mapping_free(bank_mapping *);
+isl_set * address_space_range(manipulated_polyhedral_model **, unsigned);
+isl_stat bank_mapping_generate(FILE *, const char *, bank_mapping *, unsigned);
+
+#endif /* CODEGEN_H */
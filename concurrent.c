@@ -5,11 +5,12 @@
 #include<stdlib.h>
 
 #include<isl/union_set.h>
-//#include<barvinok/isl.h>
 
 #include "config.h"
 #include "support.h"
 #include "partitioning.h"
+#include "profiling.h"
+#include "counting.h"
 
 typedef struct {
 	isl_union_set * appliedSchedule;
@@ -20,11 +21,16 @@ typedef struct {
 } linearize_date_params;
 
 typedef struct {
-	unsigned count;
-} set_cardinality_params;
+	manipulated_polyhedral_model * modelPtr;
+	isl_union_map * sliceProcessorsPtr;
+	isl_set ** processorDatasetPtr;
+	unsigned numProcessors;
+} processor_dataset_params;
 
 isl_stat linearize_date(isl_point *, void *);
-isl_stat set_cardinality(isl_point *, void *);
+isl_stat processor_dataset_build(isl_point *, void *);
+isl_set * slice_accesses_union(isl_set *, isl_union_set *, isl_union_map *);
+unsigned long bank_cycles(unsigned long, unsigned long, const bank_ports *);
 
 isl_stat linearize_dates(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks) {
 #ifdef VERBOSE
@@ -83,10 +89,10 @@ isl_stat linearize_dates(FILE * stream, manipulated_polyhedral_model ** modified
 		if (outcome == isl_stat_error)
 			return isl_stat_error;
 		
-		modifiedPolyhedralModelPtr[i] -> linearizedSchedule = isl_union_map_coalesce(linearizationParams -> partialLinearization);
-		
-//		free(linearizationParams);
+		PROFILE_UNION_MAP(PROFILE_LINEARIZATION_COALESCE, linearizationParams -> partialLinearization);
+		PROFILE_TIMED(PROFILE_LINEARIZATION_COALESCE, modifiedPolyhedralModelPtr[i] -> linearizedSchedule = isl_union_map_coalesce(linearizationParams -> partialLinearization));
 		
+
 #ifdef VERBOSE
 		fprintf(stream, "Linearized schedule:\n");
 		printer = isl_printer_print_union_map(printer, modifiedPolyhedralModelPtr[i] -> linearizedSchedule);
@@ -101,6 +107,7 @@ isl_stat linearize_dates(FILE * stream, manipulated_polyhedral_model ** modified
 		isl_printer_free(printer);
 #endif	
 		// Be clean
+		isl_union_set_free(linearizationParams -> appliedSchedule);
 		free(linearizationParams);
 	}
 	
@@ -119,8 +126,8 @@ isl_stat linearize_date (isl_point * vector, void * user) {
 	isl_union_set * singletonPtr = NULL;
 	// Pointer to the set of lexicographically smaller dates
 	isl_union_set * lexLtSetPtr = NULL;
-	// Parameters for the callback function
-	set_cardinality_params * cardParams = NULL;
+	// Number of lexicographically smaller dates
+	unsigned long count = 0;
 	// Pointer to the point representing the linearized date
 	isl_point * datePointPtr = NULL;
 	// Result of a subroutine
@@ -168,7 +175,8 @@ isl_stat linearize_date (isl_point * vector, void * user) {
 	fprintf(stream, "\n");
 #endif
 	
-	lexLtSetPtr = isl_union_map_domain(isl_union_set_lex_lt_union_set(isl_union_set_copy(params -> appliedSchedule), isl_union_set_copy(singletonPtr)));
+	PROFILE_UNION_SET(PROFILE_LEX_LT, params -> appliedSchedule);
+	PROFILE_TIMED(PROFILE_LEX_LT, lexLtSetPtr = isl_union_map_domain(isl_union_set_lex_lt_union_set(isl_union_set_copy(params -> appliedSchedule), isl_union_set_copy(singletonPtr))));
 	
 	if (lexLtSetPtr == NULL)
 		return isl_stat_error;
@@ -186,30 +194,26 @@ isl_stat linearize_date (isl_point * vector, void * user) {
 	fprintf(stream, "\n");
 #endif
 	
-	cardParams = malloc(sizeof(set_cardinality_params));
-	
-	if (cardParams == NULL)
-		return isl_stat_error;
-	
-	cardParams -> count = 0;
-	
-	outcome = isl_union_set_foreach_point (lexLtSetPtr, set_cardinality, (void *)cardParams);
+	PROFILE_UNION_SET(PROFILE_LEX_COUNT, lexLtSetPtr);
+	PROFILE_TIMED(PROFILE_LEX_COUNT, outcome = union_set_count(lexLtSetPtr, &count));
+	isl_union_set_free(lexLtSetPtr);
 	
-	if (outcome == isl_stat_error)
+	if (outcome == isl_stat_error) {
+		isl_union_set_free(singletonPtr);
 		return isl_stat_error;
+	}
 	
 #ifdef MOREVERBOSE
-	fprintf(stream, "Cardinality of the set: %d\n", cardParams -> count);
-//	fprintf(stream, "Barvinok cardinality:\n");
-//	fflush(stream);
-//	isl_pw_qpolynomial_dump(isl_set_card(isl_set_from_union_set(lexLtSetPtr)));
+	fprintf(stream, "Cardinality of the set: %lu\n", count);
 #endif
 	
 	datePointPtr = isl_point_zero(isl_space_set_alloc(isl_union_set_get_ctx(singletonPtr), 0, 1));
-	datePointPtr = isl_point_set_coordinate_val(datePointPtr, isl_dim_set, 0, isl_val_int_from_ui(isl_union_set_get_ctx(singletonPtr), cardParams -> count));
+	datePointPtr = isl_point_set_coordinate_val(datePointPtr, isl_dim_set, 0, isl_val_int_from_ui(isl_union_set_get_ctx(singletonPtr), count));
 	
-	if (datePointPtr == NULL)
+	if (datePointPtr == NULL) {
+		isl_union_set_free(singletonPtr);
 		return isl_stat_error;
+	}
 
 #ifdef MOREVERBOSE
 	fprintf(stream, "Linearized date point: ");
@@ -226,8 +230,10 @@ isl_stat linearize_date (isl_point * vector, void * user) {
 	
 	if (params -> partialLinearization == NULL)
 		params -> partialLinearization = isl_union_map_from_domain_and_range(singletonPtr, isl_union_set_from_point(datePointPtr));
-	else
-		params -> partialLinearization = isl_union_map_union(params -> partialLinearization, isl_union_map_from_domain_and_range(singletonPtr, isl_union_set_from_point(datePointPtr)));
+	else {
+		PROFILE_UNION_MAP(PROFILE_LINEARIZATION_UNION, params -> partialLinearization);
+		PROFILE_TIMED(PROFILE_LINEARIZATION_UNION, params -> partialLinearization = isl_union_map_union(params -> partialLinearization, isl_union_map_from_domain_and_range(singletonPtr, isl_union_set_from_point(datePointPtr))));
+	}
 	
 #ifdef MOREVERBOSE
 	fprintf(stream, "Partial linearization:\n");
@@ -242,23 +248,10 @@ isl_stat linearize_date (isl_point * vector, void * user) {
 	fprintf(stream, "\n");
 #endif
 	
-	//Be clean
-	free(cardParams);
-	isl_union_set_free(lexLtSetPtr);
-
 	return isl_stat_ok;
 }
 
-isl_stat set_cardinality (isl_point * vector, void * user) {
-	// Pointer to the input parameters
-	set_cardinality_params * params = (set_cardinality_params *)user;
-	
-	params -> count += 1;
-	
-	return isl_stat_ok;
-}
-
-isl_set * concurrent_dataset_build(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, isl_union_set ** polyhedralSlicePtr, unsigned numTasks) {
+isl_set * concurrent_dataset_build(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, isl_union_set ** polyhedralSlicePtr, unsigned numTasks, scratch_arena * arenaPtr) {
 	// Array of the datasets of each task
 	isl_set ** datasetPtr = NULL;
 	// Pointer to a part of the dataset of the current task
@@ -268,8 +261,11 @@ isl_set * concurrent_dataset_build(FILE * stream, manipulated_polyhedral_model *
 	isl_printer * printer = NULL;
 #endif
 	isl_set * currentDatasetPtr = NULL; 
+	// Pointer to the range of the accesses, only used for its space
+	isl_set * accessRangePtr = NULL;
 	
-	datasetPtr = malloc(numTasks * sizeof(isl_set *));
+	// The array only lives for the current date
+	datasetPtr = arena_get(arenaPtr, numTasks * sizeof(isl_set *));
 	
 	if(datasetPtr == NULL) {
 		error(stream, "Memory allocation problem for the dataset array");
@@ -280,36 +276,56 @@ isl_set * concurrent_dataset_build(FILE * stream, manipulated_polyhedral_model *
 #ifdef MOREVERBOSE
 		info(stream, "Task %d)", i);
 #endif
-		datasetPtr[i] = isl_set_empty(isl_set_get_space(isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads)))));
+		accessRangePtr = isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads)));
+		datasetPtr[i] = isl_set_empty(isl_set_get_space(accessRangePtr));
+		isl_set_free(accessRangePtr);
 		
 		if (datasetPtr[i] == NULL) {
 			error(stream, "Memory allocation problem for the dataset :(");
+			dataset_array_free(datasetPtr, i);
 			return NULL;
 		} 
 		
-		if (isl_union_map_is_empty(modifiedPolyhedralModelPtr[i] -> remappedMayReads) == isl_bool_false) {
-			partialDatasetPtr = isl_union_set_apply(isl_union_set_copy(polyhedralSlicePtr[i]), isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads));
+		// The merged accesses of the task take a single application
+		if (modifiedPolyhedralModelPtr[i] -> mergedAccesses != NULL)
+			datasetPtr[i] = slice_accesses_union(datasetPtr[i], polyhedralSlicePtr[i], modifiedPolyhedralModelPtr[i] -> mergedAccesses);
+		
+		if (modifiedPolyhedralModelPtr[i] -> mergedAccesses == NULL && isl_union_map_is_empty(modifiedPolyhedralModelPtr[i] -> remappedMayReads) == isl_bool_false) {
+			PROFILE_UNION_SET(PROFILE_DATASET_APPLY, polyhedralSlicePtr[i]);
+			PROFILE_TIMED(PROFILE_DATASET_APPLY, partialDatasetPtr = isl_union_set_apply(isl_union_set_copy(polyhedralSlicePtr[i]), isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads)));
 			
-			if (isl_union_set_is_empty(partialDatasetPtr) == isl_bool_false)
-				datasetPtr[i] = isl_set_union(datasetPtr[i], isl_set_from_union_set(partialDatasetPtr));
+			if (isl_union_set_is_empty(partialDatasetPtr) == isl_bool_false) {
+				PROFILE_SET(PROFILE_DATASET_UNION, datasetPtr[i]);
+				PROFILE_TIMED(PROFILE_DATASET_UNION, datasetPtr[i] = isl_set_union(datasetPtr[i], isl_set_from_union_set(partialDatasetPtr)));
+			} else
+				isl_union_set_free(partialDatasetPtr);
 		}
 		
-		if (isl_union_map_is_empty(modifiedPolyhedralModelPtr[i] -> remappedMayWrites) == isl_bool_false) {
-			partialDatasetPtr = isl_union_set_apply(isl_union_set_copy(polyhedralSlicePtr[i]), isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayWrites));
+		if (modifiedPolyhedralModelPtr[i] -> mergedAccesses == NULL && isl_union_map_is_empty(modifiedPolyhedralModelPtr[i] -> remappedMayWrites) == isl_bool_false) {
+			PROFILE_UNION_SET(PROFILE_DATASET_APPLY, polyhedralSlicePtr[i]);
+			PROFILE_TIMED(PROFILE_DATASET_APPLY, partialDatasetPtr = isl_union_set_apply(isl_union_set_copy(polyhedralSlicePtr[i]), isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayWrites)));
 			
-			if (isl_union_set_is_empty(partialDatasetPtr) == isl_bool_false)
-				datasetPtr[i] = isl_set_union(datasetPtr[i], isl_set_from_union_set(partialDatasetPtr));
+			if (isl_union_set_is_empty(partialDatasetPtr) == isl_bool_false) {
+				PROFILE_SET(PROFILE_DATASET_UNION, datasetPtr[i]);
+				PROFILE_TIMED(PROFILE_DATASET_UNION, datasetPtr[i] = isl_set_union(datasetPtr[i], isl_set_from_union_set(partialDatasetPtr)));
+			} else
+				isl_union_set_free(partialDatasetPtr);
 		}
 		
-		if (isl_union_map_is_empty(modifiedPolyhedralModelPtr[i] -> remappedMustWrites) == isl_bool_false) {
-			partialDatasetPtr = isl_union_set_apply(isl_union_set_copy(polyhedralSlicePtr[i]), isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMustWrites));
+		if (modifiedPolyhedralModelPtr[i] -> mergedAccesses == NULL && isl_union_map_is_empty(modifiedPolyhedralModelPtr[i] -> remappedMustWrites) == isl_bool_false) {
+			PROFILE_UNION_SET(PROFILE_DATASET_APPLY, polyhedralSlicePtr[i]);
+			PROFILE_TIMED(PROFILE_DATASET_APPLY, partialDatasetPtr = isl_union_set_apply(isl_union_set_copy(polyhedralSlicePtr[i]), isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMustWrites)));
 			
-			if (isl_union_set_is_empty(partialDatasetPtr) == isl_bool_false)
-				datasetPtr[i] = isl_set_union(datasetPtr[i], isl_set_from_union_set(partialDatasetPtr));
+			if (isl_union_set_is_empty(partialDatasetPtr) == isl_bool_false) {
+				PROFILE_SET(PROFILE_DATASET_UNION, datasetPtr[i]);
+				PROFILE_TIMED(PROFILE_DATASET_UNION, datasetPtr[i] = isl_set_union(datasetPtr[i], isl_set_from_union_set(partialDatasetPtr)));
+			} else
+				isl_union_set_free(partialDatasetPtr);
 		}
 		
 		if (datasetPtr[i] == NULL) {
 			error(stream, "Problem during dataset construction");
+			dataset_array_free(datasetPtr, i);
 			return NULL;
 		} 
 		
@@ -333,24 +349,32 @@ isl_set * concurrent_dataset_build(FILE * stream, manipulated_polyhedral_model *
 		
 		fprintf(stream, "\n");
 		fflush(stream);
+		isl_printer_free(printer);
 #endif
 	}
 	
 	currentDatasetPtr = datasetPtr[0];
 	
-	for (int i = 1; i < numTasks; i++)
-		currentDatasetPtr = isl_set_union(currentDatasetPtr, datasetPtr[i]);
+	for (int i = 1; i < numTasks; i++) {
+		PROFILE_SET(PROFILE_DATASET_UNION, currentDatasetPtr);
+		PROFILE_TIMED(PROFILE_DATASET_UNION, currentDatasetPtr = isl_set_union(currentDatasetPtr, datasetPtr[i]));
+	}
+	
+	PROFILE_SET(PROFILE_DATASET_COALESCE, currentDatasetPtr);
+	PROFILE_TIMED(PROFILE_DATASET_COALESCE, currentDatasetPtr = isl_set_coalesce(currentDatasetPtr));
 	
-	return isl_set_coalesce(currentDatasetPtr);
+	return currentDatasetPtr;
 }
 
-isl_stat evaluate_fundamental_lattice(FILE * stream, isl_set * concurrentDatasetPtr, isl_set ** translatesPtr, unsigned long * costPtr) {
+isl_stat evaluate_fundamental_lattice(FILE * stream, isl_set * concurrentDatasetPtr, isl_set ** translatesPtr, unsigned numBanks, unsigned long * costPtr, unsigned long * minLoadPtr, unsigned long * pointsPtr) {
 	// Pointer to the Z - polyhedron to be evaluated
 	isl_set * zPolyhedron = NULL;
 	// Maximum number of memory conflicts count for the current fundamental lattice
-	unsigned cost = 0;
-	// Parameters for the callback function
-	set_cardinality_params * cardParams = NULL;
+	unsigned long cost = 0;
+	// Load of the least loaded bank
+	unsigned long minLoad = 0;
+	// Number of points of the Z - polyhedron
+	unsigned long count = 0;
 	// Result of a subroutine
 	isl_stat outcome = isl_stat_ok;
 #ifdef MOREVERBOSE
@@ -358,9 +382,10 @@ isl_stat evaluate_fundamental_lattice(FILE * stream, isl_set * concurrentDataset
 	isl_printer * printer = NULL;
 #endif
 	
-	
-	for (int i = 0; i < NUMBANKS; i++) {
-		zPolyhedron = isl_set_intersect(isl_set_copy(concurrentDatasetPtr), isl_set_copy(translatesPtr[i]));
+	// A lattice with fewer banks than the others ends its translates with NULL
+	for (int i = 0; i < numBanks && translatesPtr[i] != NULL; i++) {
+		PROFILE_SET(PROFILE_LATTICE_INTERSECT, concurrentDatasetPtr);
+		PROFILE_TIMED(PROFILE_LATTICE_INTERSECT, zPolyhedron = isl_set_intersect(isl_set_copy(concurrentDatasetPtr), isl_set_copy(translatesPtr[i])));
 		
 		if (zPolyhedron == NULL) {
 			error(stream, "Error during building the Z - polyhedron");
@@ -383,44 +408,381 @@ isl_stat evaluate_fundamental_lattice(FILE * stream, isl_set * concurrentDataset
 		
 		if(printer == NULL) {
 			error(stream, "Printing problem :(");
+			isl_set_free(zPolyhedron);
 			return isl_stat_error;
 		} 
 		
 		fprintf(stream, "\n");
 		fflush(stream);
+		isl_printer_free(printer);
 #endif
 		
-		cardParams = malloc(sizeof(set_cardinality_params));
-	
-		if (cardParams == NULL)
-			return isl_stat_error;
-	
-		cardParams -> count = 0;
-	
-		outcome = isl_set_foreach_point (zPolyhedron, set_cardinality, (void *)cardParams);
-	
+		PROFILE_SET(PROFILE_LATTICE_COUNT, zPolyhedron);
+		PROFILE_TIMED(PROFILE_LATTICE_COUNT, outcome = set_count(zPolyhedron, &count));
+		isl_set_free(zPolyhedron);
+		
 		if (outcome == isl_stat_error) {
 			error(stream, "Error during counting points in the Z - polyhedron");
 			return isl_stat_error;
 		}
 		
-		cardParams -> count;
-		
 #ifdef MOREVERBOSE
-		fprintf(stream, "Number of points: %u\n", cardParams -> count);
+		fprintf(stream, "Number of points: %lu\n", count);
 		fflush(stream);
 #endif
 		
-		if (cardParams -> count > cost)
-			cost = cardParams -> count;
+		if (count > cost)
+			cost = count;
+		
+		if (i == 0 || count < minLoad)
+			minLoad = count;
+		
+		*pointsPtr += count;
+	}
+	
+#ifdef VERBOSE
+	fprintf(stream, "Cost function value for the current lattice and the current date: %lu\n", cost);
+	fflush(stream);
+#endif
+	
+	*costPtr += cost;
+	
+	if (minLoadPtr != NULL)
+		*minLoadPtr = minLoad;
+	
+	return isl_stat_ok;
+}
+
+// The addresses accessed at the date by each processor, NULL for the idle ones
+isl_set ** processor_datasets_build(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, isl_union_set ** polyhedralSlicePtr, unsigned numTasks, unsigned numProcessors, scratch_arena * arenaPtr) {
+	// Parameters for the callback function
+	processor_dataset_params params;
+	// Pointer to the processors active at the date
+	isl_union_set * processorsPtr = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	params.numProcessors = numProcessors;
+	params.processorDatasetPtr = arena_calloc(arenaPtr, numProcessors, sizeof(isl_set *));
+	
+	if (params.processorDatasetPtr == NULL) {
+		error(stream, "Memory allocation problem for the datasets of the processors");
+		return NULL;
+	}
+	
+	for (int i = 0; i < numTasks && outcome == isl_stat_ok; i++) {
+		params.modelPtr = modifiedPolyhedralModelPtr[i];
+		params.sliceProcessorsPtr = isl_union_map_intersect_domain(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> processorSchedule), isl_union_set_copy(polyhedralSlicePtr[i]));
+		processorsPtr = isl_union_map_range(isl_union_map_copy(params.sliceProcessorsPtr));
+		
+		outcome = isl_union_set_foreach_point(processorsPtr, processor_dataset_build, &params);
+		
+		isl_union_set_free(processorsPtr);
+		isl_union_map_free(params.sliceProcessorsPtr);
+	}
+	
+	if (outcome == isl_stat_error) {
+		error(stream, "Problem during the datasets of the processors");
+		dataset_array_free(params.processorDatasetPtr, numProcessors);
+		return NULL;
+	}
+	
+	return params.processorDatasetPtr;
+}
+
+isl_stat processor_dataset_build(isl_point * pointPtr, void * user) {
+	// Parameters of the datasets
+	processor_dataset_params * params = (processor_dataset_params *)user;
+	// Processor of the point
+	isl_val * processorVal = isl_point_get_coordinate_val(pointPtr, isl_dim_set, 0);
+	// Index of the processor
+	long processor = isl_val_get_num_si(processorVal);
+	// Pointer to the instances of the processor
+	isl_union_set * instancesPtr = NULL;
+	// Pointer to the addresses accessed by the processor
+	isl_union_set * datasetPtr = NULL;
+	
+	isl_val_free(processorVal);
+	
+	if (processor < 0 || processor >= params -> numProcessors) {
+		isl_point_free(pointPtr);
+		return isl_stat_error;
+	}
+	
+	instancesPtr = isl_union_map_domain(isl_union_map_intersect_range(isl_union_map_copy(params -> sliceProcessorsPtr), isl_union_set_from_point(pointPtr)));
+	
+	PROFILE_UNION_SET(PROFILE_DATASET_APPLY, instancesPtr);
+	
+	if (params -> modelPtr -> mergedAccesses != NULL)
+		PROFILE_TIMED(PROFILE_DATASET_APPLY, datasetPtr = isl_union_set_apply(instancesPtr, isl_union_map_copy(params -> modelPtr -> mergedAccesses)));
+	else
+		PROFILE_TIMED(PROFILE_DATASET_APPLY,
+			datasetPtr = isl_union_set_apply(isl_union_set_copy(instancesPtr), isl_union_map_copy(params -> modelPtr -> remappedMayReads));
+			datasetPtr = isl_union_set_union(datasetPtr, isl_union_set_apply(isl_union_set_copy(instancesPtr), isl_union_map_copy(params -> modelPtr -> remappedMayWrites)));
+			datasetPtr = isl_union_set_union(datasetPtr, isl_union_set_apply(instancesPtr, isl_union_map_copy(params -> modelPtr -> remappedMustWrites))));
+	
+	if (datasetPtr == NULL)
+		return isl_stat_error;
+	
+	if (isl_union_set_is_empty(datasetPtr) == isl_bool_true) {
+		isl_union_set_free(datasetPtr);
+		return isl_stat_ok;
+	}
+	
+	params -> processorDatasetPtr[processor] = isl_set_coalesce(isl_set_from_union_set(datasetPtr));
+	
+	return params -> processorDatasetPtr[processor] != NULL ? isl_stat_ok : isl_stat_error;
+}
+
+// The banks serve their requests one after the other, so the latency of a date is the one of the busiest bank
+isl_stat evaluate_fundamental_lattice_numa(FILE * stream, isl_set ** processorDatasetPtr, const bank_latency * latencyPtr, isl_set ** translatesPtr, unsigned long * costPtr, unsigned long * minLoadPtr, unsigned long * pointsPtr) {
+	// Pointer to the Z - polyhedron to be evaluated
+	isl_set * zPolyhedron = NULL;
+	// Latency of the busiest bank
+	unsigned long cost = 0;
+	// Latency of the least busy bank
+	unsigned long minLoad = 0;
+	// Latency of the current bank
+	unsigned long bankLatency = 0;
+	// Number of points of the Z - polyhedron
+	unsigned long count = 0;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	for (int i = 0; i < latencyPtr -> numBanks; i++) {
+		bankLatency = 0;
+		
+		for (int p = 0; p < latencyPtr -> numProcessors; p++) {
+			
+			if (processorDatasetPtr[p] == NULL)
+				continue;
+			
+			PROFILE_SET(PROFILE_LATTICE_INTERSECT, processorDatasetPtr[p]);
+			PROFILE_TIMED(PROFILE_LATTICE_INTERSECT, zPolyhedron = isl_set_intersect(isl_set_copy(processorDatasetPtr[p]), isl_set_copy(translatesPtr[i])));
+			
+			if (zPolyhedron == NULL) {
+				error(stream, "Error during building the Z - polyhedron");
+				return isl_stat_error;
+			}
+			
+			PROFILE_SET(PROFILE_LATTICE_COUNT, zPolyhedron);
+			PROFILE_TIMED(PROFILE_LATTICE_COUNT, outcome = set_count(zPolyhedron, &count));
+			isl_set_free(zPolyhedron);
+			
+			if (outcome == isl_stat_error) {
+				error(stream, "Error during counting points in the Z - polyhedron");
+				return isl_stat_error;
+			}
+			
+			bankLatency += count * latencyPtr -> cycles[p * latencyPtr -> numBanks + i];
+			*pointsPtr += count;
+		}
+		
+		if (bankLatency > cost)
+			cost = bankLatency;
+		
+		if (i == 0 || bankLatency < minLoad)
+			minLoad = bankLatency;
+	}
+	
+#ifdef VERBOSE
+	fprintf(stream, "Memory latency for the current lattice and the current date: %lu\n", cost);
+	fflush(stream);
+#endif
+	
+	*costPtr += cost;
+	
+	if (minLoadPtr != NULL)
+		*minLoadPtr = minLoad;
+	
+	return isl_stat_ok;
+}
+
+// The addresses read and the addresses written at the date, apart
+isl_stat access_datasets_build(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, isl_union_set ** polyhedralSlicePtr, unsigned numTasks, isl_set * concurrentDatasetPtr, isl_set ** readDatasetPtr, isl_set ** writeDatasetPtr) {
+	
+	*readDatasetPtr = isl_set_empty(isl_set_get_space(concurrentDatasetPtr));
+	*writeDatasetPtr = isl_set_empty(isl_set_get_space(concurrentDatasetPtr));
+	
+	for (int i = 0; i < numTasks; i++) {
+		*readDatasetPtr = slice_accesses_union(*readDatasetPtr, polyhedralSlicePtr[i], modifiedPolyhedralModelPtr[i] -> remappedMayReads);
+		*writeDatasetPtr = slice_accesses_union(*writeDatasetPtr, polyhedralSlicePtr[i], modifiedPolyhedralModelPtr[i] -> remappedMayWrites);
+		*writeDatasetPtr = slice_accesses_union(*writeDatasetPtr, polyhedralSlicePtr[i], modifiedPolyhedralModelPtr[i] -> remappedMustWrites);
+	}
+	
+	if (*readDatasetPtr == NULL || *writeDatasetPtr == NULL) {
+		error(stream, "Problem during the read and write datasets");
+		return isl_stat_error;
+	}
+	
+	*readDatasetPtr = isl_set_coalesce(*readDatasetPtr);
+	*writeDatasetPtr = isl_set_coalesce(*writeDatasetPtr);
+	
+	return isl_stat_ok;
+}
+
+// The accesses of each task are merged once, the must - writes being part of the may - writes
+isl_stat accesses_merge(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, unsigned dim, unsigned tagged) {
+	// Relation tagging the addresses read and the addresses written
+	isl_map * tagPtr = NULL;
+	
+	for (int i = 0; i < numTasks; i++) {
+		modifiedPolyhedralModelPtr[i] -> mergedAccesses = isl_union_map_free(modifiedPolyhedralModelPtr[i] -> mergedAccesses);
+		modifiedPolyhedralModelPtr[i] -> taggedAccesses = isl_union_map_free(modifiedPolyhedralModelPtr[i] -> taggedAccesses);
+		modifiedPolyhedralModelPtr[i] -> mergedAccesses = isl_union_map_coalesce(isl_union_map_union(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads), isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayWrites)));
+		
+		if (modifiedPolyhedralModelPtr[i] -> mergedAccesses == NULL) {
+			error(stream, "Error during the merge of the accesses");
+			return isl_stat_error;
+		}
+		
+		if (!tagged)
+			continue;
+		
+		// An address read gets the tag 0 in front of its coordinates, an address written the tag 1
+		tagPtr = isl_map_insert_dims(isl_map_identity(isl_space_map_from_set(isl_space_set_alloc(isl_union_map_get_ctx(modifiedPolyhedralModelPtr[i] -> remappedMayReads), 0, dim))), isl_dim_out, 0, 1);
+		modifiedPolyhedralModelPtr[i] -> taggedAccesses = isl_union_map_union(
+			isl_union_map_apply_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads), isl_union_map_from_map(isl_map_fix_si(isl_map_copy(tagPtr), isl_dim_out, 0, 0))),
+			isl_union_map_apply_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayWrites), isl_union_map_from_map(isl_map_fix_si(tagPtr, isl_dim_out, 0, 1))));
+		modifiedPolyhedralModelPtr[i] -> taggedAccesses = isl_union_map_coalesce(modifiedPolyhedralModelPtr[i] -> taggedAccesses);
+		
+		if (modifiedPolyhedralModelPtr[i] -> taggedAccesses == NULL) {
+			error(stream, "Error during the tagging of the accesses");
+			return isl_stat_error;
+		}
+	}
+	
+	return isl_stat_ok;
+}
+
+// The addresses read and the addresses written at the date, from a single application of the tagged accesses per task
+isl_stat tagged_datasets_build(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, isl_union_set ** polyhedralSlicePtr, unsigned numTasks, isl_set ** readDatasetPtr, isl_set ** writeDatasetPtr) {
+	// Pointer to the tagged addresses accessed at the date
+	isl_set * taggedDatasetPtr = NULL;
+	// Pointer to the range of the tagged accesses, only used for its space
+	isl_set * accessRangePtr = NULL;
+	
+	accessRangePtr = isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[0] -> taggedAccesses)));
+	taggedDatasetPtr = isl_set_empty(isl_set_get_space(accessRangePtr));
+	isl_set_free(accessRangePtr);
+	
+	for (int i = 0; i < numTasks; i++)
+		taggedDatasetPtr = slice_accesses_union(taggedDatasetPtr, polyhedralSlicePtr[i], modifiedPolyhedralModelPtr[i] -> taggedAccesses);
+	
+	*readDatasetPtr = isl_set_coalesce(isl_set_project_out(isl_set_fix_si(isl_set_copy(taggedDatasetPtr), isl_dim_set, 0, 0), isl_dim_set, 0, 1));
+	*writeDatasetPtr = isl_set_coalesce(isl_set_project_out(isl_set_fix_si(taggedDatasetPtr, isl_dim_set, 0, 1), isl_dim_set, 0, 1));
+	
+	if (*readDatasetPtr == NULL || *writeDatasetPtr == NULL) {
+		error(stream, "Problem during the read and write datasets");
+		return isl_stat_error;
+	}
+	
+	return isl_stat_ok;
+}
+
+isl_set * slice_accesses_union(isl_set * datasetPtr, isl_union_set * slicePtr, isl_union_map * accessPtr) {
+	// Pointer to the addresses accessed by the slice
+	isl_union_set * partialDatasetPtr = NULL;
+	
+	if (datasetPtr == NULL || isl_union_map_is_empty(accessPtr) == isl_bool_true)
+		return datasetPtr;
+	
+	PROFILE_UNION_SET(PROFILE_DATASET_APPLY, slicePtr);
+	PROFILE_TIMED(PROFILE_DATASET_APPLY, partialDatasetPtr = isl_union_set_apply(isl_union_set_copy(slicePtr), isl_union_map_copy(accessPtr)));
+	
+	if (isl_union_set_is_empty(partialDatasetPtr) == isl_bool_true) {
+		isl_union_set_free(partialDatasetPtr);
+		return datasetPtr;
+	}
+	
+	PROFILE_SET(PROFILE_DATASET_UNION, datasetPtr);
+	PROFILE_TIMED(PROFILE_DATASET_UNION, datasetPtr = isl_set_union(datasetPtr, isl_set_from_union_set(partialDatasetPtr)));
+	
+	return datasetPtr;
+}
+
+// Reads and writes are served by their own ports and by the shared ones
+unsigned long bank_cycles(unsigned long reads, unsigned long writes, const bank_ports * portsPtr) {
+	// Ports able to serve the reads, the writes and both
+	unsigned long readPorts = portsPtr -> read + portsPtr -> shared;
+	unsigned long writePorts = portsPtr -> write + portsPtr -> shared;
+	unsigned long allPorts = readPorts + portsPtr -> write;
+	// Cycles needed by the bank
+	unsigned long cycles = (reads + writes + allPorts - 1) / allPorts;
+	
+	if ((reads + readPorts - 1) / readPorts > cycles)
+		cycles = (reads + readPorts - 1) / readPorts;
+	
+	if ((writes + writePorts - 1) / writePorts > cycles)
+		cycles = (writes + writePorts - 1) / writePorts;
+	
+	return cycles;
+}
+
+// The cost of a date is the number of cycles its busiest bank needs to serve its reads and its writes
+isl_stat evaluate_fundamental_lattice_ports(FILE * stream, isl_set * readDatasetPtr, isl_set * writeDatasetPtr, isl_set ** translatesPtr, unsigned numBanks, const bank_ports * ports, unsigned long * costPtr, unsigned long * minLoadPtr, unsigned long * pointsPtr) {
+	// Pointer to the Z - polyhedron to be evaluated
+	isl_set * zPolyhedron = NULL;
+	// Cycles of the busiest bank
+	unsigned long cost = 0;
+	// Cycles of the least busy bank
+	unsigned long minLoad = 0;
+	// Cycles of the current bank
+	unsigned long cycles = 0;
+	// Number of reads and of writes in the current bank
+	unsigned long count[2] = {0, 0};
+	// Datasets of the reads and of the writes
+	isl_set * datasetPtr[2] = {readDatasetPtr, writeDatasetPtr};
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	for (int i = 0; i < numBanks; i++) {
+		
+		for (int k = 0; k < 2; k++) {
+			PROFILE_SET(PROFILE_LATTICE_INTERSECT, datasetPtr[k]);
+			PROFILE_TIMED(PROFILE_LATTICE_INTERSECT, zPolyhedron = isl_set_intersect(isl_set_copy(datasetPtr[k]), isl_set_copy(translatesPtr[i])));
+			
+			if (zPolyhedron == NULL) {
+				error(stream, "Error during building the Z - polyhedron");
+				return isl_stat_error;
+			}
+			
+			PROFILE_SET(PROFILE_LATTICE_COUNT, zPolyhedron);
+			PROFILE_TIMED(PROFILE_LATTICE_COUNT, outcome = set_count(zPolyhedron, &(count[k])));
+			isl_set_free(zPolyhedron);
+			
+			if (outcome == isl_stat_error) {
+				error(stream, "Error during counting points in the Z - polyhedron");
+				return isl_stat_error;
+			}
+			
+			*pointsPtr += count[k];
+		}
+		
+		cycles = bank_cycles(count[0], count[1], &(ports[i]));
+		
+		if (cycles > cost)
+			cost = cycles;
+		
+		if (i == 0 || cycles < minLoad)
+			minLoad = cycles;
 	}
 	
 #ifdef VERBOSE
-	fprintf(stream, "Cost function value for the current lattice and the current date: %u\n", cost);
+	fprintf(stream, "Cycles for the current lattice and the current date: %lu\n", cost);
 	fflush(stream);
 #endif
 	
 	*costPtr += cost;
 	
+	if (minLoadPtr != NULL)
+		*minLoadPtr = minLoad;
+	
 	return isl_stat_ok;
-}
\ No newline at end of file
+}
+
+void dataset_array_free(isl_set ** datasetPtr, unsigned numDatasets) {
+	// The array itself belongs to the scratch arena
+	for (int i = 0; i < numDatasets; i++)
+		isl_set_free(datasetPtr[i]);
+}
@@ -2,9 +2,12 @@
  * Architecture - specific definitions 
  */
 
+#include<stddef.h>
+
 #include "config.h"
 
 #define NUMSPACES 4
+#define BANKS 8
 
 const int moreIndent = NUMSPACES;
 const int lessIndent = -NUMSPACES;
@@ -26,4 +29,25 @@ const unsigned PARAMS[2][2] = {
 	{8, 4},
 };
 
-const unsigned NUMBANKS = 8;
\ No newline at end of file
+const unsigned NUMBANKS = BANKS;
+
+const unsigned * const paramsRows[] = {
+	PARAMS[0],
+	PARAMS[1]
+};
+
+// Only the tasks with a row in PARAMS can be configured, the capacity of the banks is unbounded and the single - ported banks are flat and accessed uniformly
+const architecture_config defaultArchitecture = {
+	sizeof(paramsRows) / sizeof(paramsRows[0]),
+	N,
+	NUMPARAMS,
+	paramsRows,
+	BANKS,
+	"../Tests/source-demos/",
+	"../Tests/polyhedral-extraction/outputs/",
+	"./Lattices/",
+	0,
+	{NULL, NULL},
+	0,
+	1
+};
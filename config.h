@@ -14,4 +14,44 @@ extern const unsigned NUMPARAMS[]; // to support for tasks with different parame
 extern const unsigned PARAMS[2][2];
 extern const unsigned NUMBANKS;
 
+// Latency, in cycles, of an access of each processor to each bank; the rows
+// follow the processors of the tasks, task after task
+typedef struct {
+	unsigned numProcessors;
+	unsigned numBanks;
+	const unsigned * cycles;
+} bank_latency;
+
+// Ports of a bank: read - only, write - only and shared between reads and writes
+typedef struct {
+	unsigned read;
+	unsigned write;
+	unsigned shared;
+} bank_ports;
+
+// Timing of the banks; without latencies the accesses are uniform, and
+// without ports every bank has a single shared port
+typedef struct {
+	const bank_latency * latency;
+	const bank_ports * ports;
+} memory_model;
+
+// Architecture - specific parameters grouped, so that they can be given at run time
+typedef struct {
+	unsigned maxTasks;
+	const unsigned * N;
+	const unsigned * numParams;
+	const unsigned * const * params;
+	unsigned numBanks;
+	const char * sourcePath;
+	const char * schedulePath;
+	const char * latticesPath;
+	unsigned long bankCapacity;
+	memory_model memory;
+	unsigned numClusters;
+	unsigned clusterWeight;
+} architecture_config;
+
+extern const architecture_config defaultArchitecture;
+
 #endif /* CONFIG_H */
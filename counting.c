@@ -0,0 +1,148 @@
+/*
+ * Implementation of the counting backend of the integer points of a set
+ */
+#include<isl/set.h>
+#include<isl/union_set.h>
+#include<isl/val.h>
+#ifdef BARVINOK
+#include<isl/polynomial.h>
+#include<barvinok/isl.h>
+#endif
+
+#include "profiling.h"
+#include "counting.h"
+
+#ifdef BARVINOK
+// Largest bounding box still counted by enumeration
+#define ENUMERATIONSIZE 4096
+
+isl_bool set_is_small(isl_set *);
+isl_stat set_count_symbolic(isl_set *, unsigned long *);
+#endif
+isl_stat set_count_enumerated(isl_set *, unsigned long *);
+isl_stat union_set_count_part(isl_set *, void *);
+
+isl_stat set_count(isl_set * set, unsigned long * countPtr) {
+#ifdef BARVINOK
+	// Estimated size of the set
+	isl_bool small = set_is_small(set);
+	
+	if (small == isl_bool_error)
+		return isl_stat_error;
+	
+	if (small == isl_bool_false)
+		return set_count_symbolic(set, countPtr);
+#endif
+	
+	return set_count_enumerated(set, countPtr);
+}
+
+isl_stat union_set_count(isl_union_set * uset, unsigned long * countPtr) {
+	
+	*countPtr = 0;
+	
+	return isl_union_set_foreach_set(uset, union_set_count_part, countPtr);
+}
+
+isl_stat union_set_count_part(isl_set * set, void * user) {
+	// Points of the current part
+	unsigned long count = 0;
+	// Result of a subroutine
+	isl_stat outcome = set_count(set, &count);
+	
+	*((unsigned long *)user) += count;
+	isl_set_free(set);
+	
+	return outcome;
+}
+
+isl_stat set_count_enumerated(isl_set * set, unsigned long * countPtr) {
+	// Number of points of the set
+	isl_val * countVal = NULL;
+	
+	PROFILE_POINT(PROFILE_COUNT_ENUMERATED);
+	countVal = isl_set_count_val(set);
+	
+	if (countVal == NULL)
+		return isl_stat_error;
+	
+	*countPtr = isl_val_get_num_si(countVal);
+	isl_val_free(countVal);
+	
+	return isl_stat_ok;
+}
+
+#ifdef BARVINOK
+isl_bool set_is_small(isl_set * set) {
+	// Bound of the current dimension
+	isl_val * boundVal = NULL;
+	// Extent of the current dimension
+	long extent = 0;
+	// Number of points of the bounding box
+	double boxSize = 1;
+	
+	// The bounding box overestimates the set, never underestimates it
+	for (int i = 0; i < isl_set_dim(set, isl_dim_set); i++) {
+		boundVal = isl_set_dim_max_val(isl_set_copy(set), i);
+		
+		if (boundVal == NULL)
+			return isl_bool_error;
+		
+		// An empty set has no finite bound and nothing to count
+		if (isl_val_is_neginfty(boundVal)) {
+			isl_val_free(boundVal);
+			return isl_bool_true;
+		}
+		
+		if (!isl_val_is_int(boundVal)) {
+			isl_val_free(boundVal);
+			return isl_bool_false;
+		}
+		
+		extent = isl_val_get_num_si(boundVal);
+		isl_val_free(boundVal);
+		boundVal = isl_set_dim_min_val(isl_set_copy(set), i);
+		
+		if (boundVal == NULL)
+			return isl_bool_error;
+		
+		if (!isl_val_is_int(boundVal)) {
+			isl_val_free(boundVal);
+			return isl_bool_false;
+		}
+		
+		extent -= isl_val_get_num_si(boundVal) - 1;
+		isl_val_free(boundVal);
+		boxSize *= extent;
+		
+		if (boxSize > ENUMERATIONSIZE)
+			return isl_bool_false;
+	}
+	
+	return isl_bool_true;
+}
+
+isl_stat set_count_symbolic(isl_set * set, unsigned long * countPtr) {
+	// Cardinality of the set, as a function of its parameters
+	isl_pw_qpolynomial * cardinality = NULL;
+	// Cardinality once evaluated
+	isl_val * countVal = NULL;
+	
+	PROFILE_POINT(PROFILE_COUNT_SYMBOLIC);
+	cardinality = isl_set_card(isl_set_copy(set));
+	
+	if (cardinality == NULL)
+		return isl_stat_error;
+	
+	// The parameters are already eliminated, so any point of their space will do
+	countVal = isl_pw_qpolynomial_eval(cardinality, isl_point_zero(isl_pw_qpolynomial_get_domain_space(cardinality)));
+	
+	if (countVal == NULL)
+		return isl_stat_error;
+	
+	*countPtr = isl_val_get_num_si(countVal);
+	isl_val_free(countVal);
+	
+	return isl_stat_ok;
+}
+#endif /* BARVINOK */
@@ -0,0 +1,17 @@
+/*
+ * Definitions of the counting backend of the integer points of a set. Small
+ * sets are counted by isl itself; when the tool is built with BARVINOK, the
+ * larger ones are counted symbolically, so that the time depends on the
+ * constraints rather than on the number of points.
+ */
+
+#ifndef COUNTING_H
+#define COUNTING_H
+
+#include<isl/set.h>
+#include<isl/union_set.h>
+
+isl_stat set_count(isl_set *, unsigned long *);
+isl_stat union_set_count(isl_union_set *, unsigned long *);
+
+#endif /* COUNTING_H */
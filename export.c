@@ -0,0 +1,263 @@
+/*
+ * Implementation of the machine - readable export of the results. A record of
+ * the temporary file holds the date, the size of its concurrent dataset and
+ * the load of the most loaded bank under each lattice; it is written with a
+ * single append, so that the workers of a sharded run can share the file.
+ */
+#include<stdlib.h>
+#include<limits.h>
+#include<string.h>
+#include<unistd.h>
+#include<fcntl.h>
+
+#include<isl/set.h>
+#include<isl/map.h>
+
+#include "support.h"
+#include "export.h"
+
+// Header of a record, before the loads of the lattices
+#define RECORDHEADER 2
+
+const char * csvExtension = ".csv";
+
+unsigned * export_top_lattices(unsigned long *, unsigned, unsigned *);
+void export_lattice_write(FILE *, result_export *, isl_set **, unsigned);
+isl_stat export_dates_write(FILE *, result_export *, unsigned *, unsigned);
+
+result_export * export_open(FILE * stream, const char * path, unsigned topK, unsigned numLattices) {
+	// Export to be opened
+	result_export * exportPtr = NULL;
+	// Name of the temporary file of the records
+	char recordsPath[] = "/tmp/umaexportXXXXXX";
+	// Length of the path
+	size_t length = strlen(path);
+	
+	exportPtr = malloc(sizeof(result_export));
+	
+	if (exportPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	exportPtr -> path = path;
+	exportPtr -> format = length >= strlen(csvExtension) && strcmp(path + length - strlen(csvExtension), csvExtension) == 0 ? EXPORT_CSV : EXPORT_JSON;
+	exportPtr -> topK = topK < numLattices ? topK : numLattices;
+	exportPtr -> numLattices = numLattices;
+	exportPtr -> recordsHdl = mkstemp(recordsPath);
+	
+	if (exportPtr -> recordsHdl < 0) {
+		error(stream, "Cannot create the temporary file of the export");
+		free(exportPtr);
+		return NULL;
+	}
+	
+	// The file disappears with the last descriptor, even after a crash
+	unlink(recordsPath);
+	fcntl(exportPtr -> recordsHdl, F_SETFL, O_APPEND);
+	
+	return exportPtr;
+}
+
+isl_stat export_date(result_export * exportPtr, unsigned long * record) {
+	// Size of a record
+	size_t recordSize = (RECORDHEADER + exportPtr -> numLattices) * sizeof(unsigned long);
+	
+	return write(exportPtr -> recordsHdl, record, recordSize) == recordSize ? isl_stat_ok : isl_stat_error;
+}
+
+isl_stat export_write(FILE * stream, result_export * exportPtr, unsigned long * cost, unsigned bestLatticeIdx, isl_set *** translatesPtr, unsigned numBanks, bank_usage * usage) {
+	// Handle to the export file
+	FILE * exportHdl = NULL;
+	// Indices of the lattices with the lowest costs
+	unsigned * top = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	top = export_top_lattices(cost, exportPtr -> numLattices, &(exportPtr -> topK));
+	exportHdl = fopen(exportPtr -> path, "w");
+	
+	if (top == NULL || exportHdl == NULL) {
+		free(top);
+		
+		if (exportHdl != NULL)
+			fclose(exportHdl);
+		
+		return isl_stat_error;
+	}
+	
+	if (exportPtr -> format == EXPORT_JSON) {
+		fprintf(exportHdl, "{\n\t\"costs\": [");
+		
+		// The lattices rejected by the capacity analysis have no cost
+		for (int i = 0; i < exportPtr -> numLattices; i++)
+			if (cost[i] == ULONG_MAX)
+				fprintf(exportHdl, "%snull", i > 0 ? ", " : "");
+			else
+				fprintf(exportHdl, "%s%lu", i > 0 ? ", " : "", cost[i]);
+		
+		if (usage != NULL) {
+			fprintf(exportHdl, "],\n\t\"usage\": [\n");
+			
+			for (int i = 0; i < exportPtr -> numLattices; i++)
+				fprintf(exportHdl, "\t\t{\"capacity\": %lu, \"footprint\": %lu, \"max_footprint\": %lu, \"fragmentation\": %.6f}%s\n",
+					usage[i].capacity, usage[i].footprint, usage[i].maxFootprint, usage[i].fragmentation, i + 1 < exportPtr -> numLattices ? "," : "");
+			
+			fprintf(exportHdl, "\t");
+		}
+		
+		fprintf(exportHdl, "],\n\t\"best\": {\"lattice\": %u, \"cost\": %lu, ", bestLatticeIdx, cost[bestLatticeIdx]);
+		export_lattice_write(exportHdl, exportPtr, translatesPtr[bestLatticeIdx], numBanks);
+		fprintf(exportHdl, "},\n\t\"top\": [");
+		
+		for (int k = 0; k < exportPtr -> topK; k++)
+			fprintf(exportHdl, "%s%u", k > 0 ? ", " : "", top[k]);
+		
+		fprintf(exportHdl, "],\n\t\"dates\": [\n");
+		outcome = export_dates_write(exportHdl, exportPtr, top, exportPtr -> topK);
+		fprintf(exportHdl, "\n\t]\n}\n");
+	} else {
+		// One value per row, so that every field shares the same columns
+		fprintf(exportHdl, "kind,lattice,date,bank,value\n");
+		
+		for (int i = 0; i < exportPtr -> numLattices; i++) {
+			if (cost[i] != ULONG_MAX)
+				fprintf(exportHdl, "cost,%d,,,%lu\n", i, cost[i]);
+			
+			if (usage != NULL)
+				fprintf(exportHdl, "capacity,%d,,,%lu\nfootprint,%d,,,%lu\nmax_footprint,%d,,,%lu\nfragmentation,%d,,,%.6f\n",
+					i, usage[i].capacity, i, usage[i].footprint, i, usage[i].maxFootprint, i, usage[i].fragmentation);
+		}
+		
+		fprintf(exportHdl, "best,%u,,,%lu\n", bestLatticeIdx, cost[bestLatticeIdx]);
+		export_lattice_write(exportHdl, exportPtr, translatesPtr[bestLatticeIdx], numBanks);
+		outcome = export_dates_write(exportHdl, exportPtr, top, exportPtr -> topK);
+	}
+	
+	if (ferror(exportHdl))
+		outcome = isl_stat_error;
+	
+	fclose(exportHdl);
+	free(top);
+	
+	return outcome;
+}
+
+// The lattice itself is the set of the differences between two points of the translate of the first bank
+void export_lattice_write(FILE * exportHdl, result_export * exportPtr, isl_set ** translatesPtr, unsigned numBanks) {
+	// Fundamental lattice
+	isl_set * latticePtr = NULL;
+	// Textual form of an isl object
+	char * text = NULL;
+	
+	latticePtr = isl_set_coalesce(isl_map_deltas(isl_map_from_domain_and_range(isl_set_copy(translatesPtr[0]), isl_set_copy(translatesPtr[0]))));
+	text = isl_set_to_str(latticePtr);
+	
+	if (exportPtr -> format == EXPORT_JSON)
+		fprintf(exportHdl, "\"basis\": \"%s\", \"translates\": [", text != NULL ? text : "");
+	else
+		fprintf(exportHdl, "basis,,,,\"%s\"\n", text != NULL ? text : "");
+	
+	free(text);
+	isl_set_free(latticePtr);
+	
+	for (int i = 0; i < numBanks; i++) {
+		text = isl_set_to_str(translatesPtr[i]);
+		
+		if (exportPtr -> format == EXPORT_JSON)
+			fprintf(exportHdl, "%s\"%s\"", i > 0 ? ", " : "", text != NULL ? text : "");
+		else
+			fprintf(exportHdl, "translate,,,%d,\"%s\"\n", i, text != NULL ? text : "");
+		
+		free(text);
+	}
+	
+	if (exportPtr -> format == EXPORT_JSON)
+		fprintf(exportHdl, "]");
+}
+
+isl_stat export_dates_write(FILE * exportHdl, result_export * exportPtr, unsigned * top, unsigned topK) {
+	// Record of the current date
+	unsigned long * record = NULL;
+	// Size of a record
+	size_t recordSize = (RECORDHEADER + exportPtr -> numLattices) * sizeof(unsigned long);
+	// Offset of the current record
+	off_t offset = 0;
+	
+	record = malloc(recordSize);
+	
+	if (record == NULL)
+		return isl_stat_error;
+	
+	// Only one record at a time is held in memory
+	for (offset = 0; pread(exportPtr -> recordsHdl, record, recordSize, offset) == recordSize; offset += recordSize) {
+		if (exportPtr -> format == EXPORT_JSON) {
+			fprintf(exportHdl, "%s\t\t{\"date\": %ld, \"dataset\": %lu, \"loads\": [", offset > 0 ? ",\n" : "", (long)record[0], record[1]);
+			
+			for (int k = 0; k < topK; k++)
+				fprintf(exportHdl, "%s%lu", k > 0 ? ", " : "", record[RECORDHEADER + top[k]]);
+			
+			fprintf(exportHdl, "]}");
+		} else {
+			fprintf(exportHdl, "dataset,,%ld,,%lu\n", (long)record[0], record[1]);
+			
+			for (int k = 0; k < topK; k++)
+				fprintf(exportHdl, "load,%u,%ld,,%lu\n", top[k], (long)record[0], record[RECORDHEADER + top[k]]);
+		}
+	}
+	
+	free(record);
+	
+	return isl_stat_ok;
+}
+
+// The number of lattices kept is small, so a selection is enough
+// The lattices without a cost are never in the top, which is cut to those with one
+unsigned * export_top_lattices(unsigned long * cost, unsigned numLattices, unsigned * topKPtr) {
+	// Indices of the lattices with the lowest costs, in increasing order of cost
+	unsigned * top = NULL;
+	// Whether the lattice is already selected
+	char * selected = NULL;
+	// Number of lattices with a cost
+	unsigned numCosted = 0;
+	// Number of lattices in the top
+	unsigned topK = 0;
+	
+	for (int i = 0; i < numLattices; i++)
+		if (cost[i] != ULONG_MAX)
+			numCosted++;
+	
+	topK = *topKPtr < numCosted ? *topKPtr : numCosted;
+	*topKPtr = topK;
+	top = malloc((topK > 0 ? topK : 1) * sizeof(unsigned));
+	selected = calloc(numLattices > 0 ? numLattices : 1, sizeof(char));
+	
+	if (top == NULL || selected == NULL) {
+		free(top);
+		free(selected);
+		return NULL;
+	}
+	
+	for (int k = 0; k < topK; k++) {
+		top[k] = numLattices;
+		
+		for (int i = 0; i < numLattices; i++)
+			if (!selected[i] && cost[i] != ULONG_MAX && (top[k] == numLattices || cost[i] < cost[top[k]]))
+				top[k] = i;
+		
+		selected[top[k]] = 1;
+	}
+	
+	free(selected);
+	
+	return top;
+}
+
+void export_free(result_export * exportPtr) {
+	
+	if (exportPtr == NULL)
+		return;
+	
+	close(exportPtr -> recordsHdl);
+	free(exportPtr);
+}
@@ -0,0 +1,35 @@
+/*
+ * Definitions of the machine - readable export of the results. The load of
+ * every lattice at every date is appended to an unlinked temporary file while
+ * the dates are evaluated, so that only the profile of the best lattices is
+ * read back, one date at a time, when the export is written.
+ */
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include<stdio.h>
+
+#include<isl/set.h>
+
+#include "capacity.h"
+
+typedef enum {
+	EXPORT_JSON,
+	EXPORT_CSV
+} export_format;
+
+typedef struct {
+	const char * path;
+	export_format format;
+	unsigned topK;
+	unsigned numLattices;
+	int recordsHdl;
+} result_export;
+
+result_export * export_open(FILE *, const char *, unsigned, unsigned);
+isl_stat export_date(result_export *, unsigned long *);
+isl_stat export_write(FILE *, result_export *, unsigned long *, unsigned, isl_set ***, unsigned, bank_usage *);
+void export_free(result_export *);
+
+#endif /* EXPORT_H */
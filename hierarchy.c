@@ -0,0 +1,112 @@
+/*
+ * Implementation of the hierarchical partitioning. The lattices of the
+ * clusters come from the catalog with as many banks as clusters, those of the
+ * banks from the usual one. A bank lattice refines a cluster lattice when it
+ * is one of its sublattices, that is when a translate of the first lies in a
+ * translate of the second. The cost of a pair is the weighted conflicts of
+ * the clusters plus the conflicts of the banks: both levels are sums over the
+ * dates of a term of their own, so each lattice is evaluated once, at its own
+ * level, and the pairs are only combined afterwards.
+ */
+#include<stdlib.h>
+#include<limits.h>
+
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "partitioning.h"
+#include "hierarchy.h"
+
+extern const unsigned parallel_phases;
+
+isl_bool lattice_nested(isl_set **, unsigned, isl_set *);
+
+isl_set *** cluster_lattices_parse(FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, unsigned * numLatticesPtr, unsigned dim) {
+	// Configuration of the clusters, seen as the banks of the outer level
+	architecture_config clusterArch = *archPtr;
+	
+	clusterArch.numBanks = archPtr -> numClusters;
+	
+	return parse_lattices(stream, optionsHdl, &clusterArch, numLatticesPtr, dim);
+}
+
+// The clusters are charged their conflicts, whatever the timing model of the banks
+isl_stat cluster_cost_compute(FILE * stream, phase * phasePtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set * linearizedDatesPtr, isl_set *** clusterTranslatesPtr, unsigned numClusterLattices, const architecture_config * archPtr, unsigned long * clusterCost, unsigned numWorkers) {
+	// Timing model of the clusters
+	memory_model clusterMemory = {NULL, NULL};
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	if (numWorkers > 1)
+		outcome = cost_function_compute_sharded(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearizedDatesPtr, clusterTranslatesPtr, numClusterLattices, archPtr -> numClusters, &clusterMemory, clusterCost, NULL, numWorkers, NULL);
+	else
+		outcome = cost_function_compute(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearizedDatesPtr, clusterTranslatesPtr, numClusterLattices, archPtr -> numClusters, &clusterMemory, clusterCost, NULL, NULL, NULL);
+	
+	// Both levels run the same phases
+	phasePtr -> phase_num -= parallel_phases;
+	
+	return outcome;
+}
+
+isl_bool lattice_nested(isl_set ** clusterTranslatesPtr, unsigned numClusters, isl_set * bankTranslatePtr) {
+	// Result of a subroutine
+	isl_bool outcome = isl_bool_false;
+	
+	for (int c = 0; c < numClusters && outcome == isl_bool_false; c++)
+		outcome = isl_set_is_subset(bankTranslatePtr, clusterTranslatesPtr[c]);
+	
+	return outcome;
+}
+
+// The cost of each bank lattice becomes the one of its best pair, the lattices without any being rejected
+unsigned hierarchy_combine(FILE * stream, isl_set *** clusterTranslatesPtr, unsigned numClusterLattices, unsigned long * clusterCost, isl_set *** translatesPtr, unsigned numLattices, unsigned long * cost, const architecture_config * archPtr, unsigned * partner) {
+	// Number of nested pairs
+	unsigned numPairs = 0;
+	// Number of bank lattices with a cluster lattice
+	unsigned numFeasible = 0;
+	// Result of a subroutine
+	isl_bool nested = isl_bool_false;
+	
+	for (int j = 0; j < numLattices; j++) {
+		partner[j] = UINT_MAX;
+		
+		if (translatesPtr[j] == NULL || cost[j] == ULONG_MAX)
+			continue;
+		
+		for (int i = 0; i < numClusterLattices; i++) {
+			
+			if (clusterCost[i] == ULONG_MAX)
+				continue;
+			
+			nested = lattice_nested(clusterTranslatesPtr[i], archPtr -> numClusters, translatesPtr[j][0]);
+			
+			if (nested == isl_bool_error) {
+				error(stream, "Error during the comparison of the lattices");
+				return 0;
+			}
+			
+			if (nested == isl_bool_false)
+				continue;
+			
+			numPairs++;
+			
+			// The conflicts of the banks are the same whatever the cluster lattice
+			if (partner[j] == UINT_MAX || clusterCost[i] < clusterCost[partner[j]])
+				partner[j] = i;
+		}
+		
+		if (partner[j] == UINT_MAX) {
+			lattice_reject(translatesPtr, j, archPtr -> numBanks);
+			cost[j] = ULONG_MAX;
+			continue;
+		}
+		
+		cost[j] += archPtr -> clusterWeight * clusterCost[partner[j]];
+		numFeasible++;
+	}
+	
+	info(stream, "Nested pairs of lattices: %d", numPairs);
+	
+	return numFeasible;
+}
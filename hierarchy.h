@@ -0,0 +1,23 @@
+/*
+ * Definitions of the hierarchical partitioning, where the banks are grouped
+ * in clusters: an outer lattice spreads the addresses over the clusters and a
+ * nested one over the banks of the clusters.
+ */
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include<stdio.h>
+
+#include<isl/ctx.h>
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+
+isl_set *** cluster_lattices_parse(FILE *, isl_ctx *, const architecture_config *, unsigned *, unsigned);
+isl_stat cluster_cost_compute(FILE *, phase *, manipulated_polyhedral_model **, unsigned, isl_set *, isl_set ***, unsigned, const architecture_config *, unsigned long *, unsigned);
+unsigned hierarchy_combine(FILE *, isl_set ***, unsigned, unsigned long *, isl_set ***, unsigned, unsigned long *, const architecture_config *, unsigned *);
+
+#endif /* HIERARCHY_H */
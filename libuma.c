@@ -0,0 +1,258 @@
+/*
+ * Implementation of the embeddable interface of the lattice - based memory
+ * partitioning technique
+ */
+#include<stdlib.h>
+#include<stdio.h>
+#include<unistd.h>
+
+#include<pet.h>
+#include<isl/set.h>
+#include<isl/schedule.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+#include "partitioning.h"
+#include "libuma.h"
+
+pet_scop * task_scop_build(FILE *, isl_ctx *, const architecture_config *, const uma_task *);
+
+isl_ctx * uma_ctx_alloc(void) {
+	return isl_ctx_alloc_with_pet_options();
+}
+
+int uma_partition(isl_ctx * optionsHdl, const architecture_config * archPtr, FILE * logHdl, const uma_task * tasks, unsigned numTasks, uma_result * resultPtr) {
+	// Handle to the log stream
+	FILE * stream = logHdl;
+	// Pointer to the current phase, only used for the log
+	phase * phasePtr = NULL;
+	// Array of the original polyhedral models of each task
+	pet_scop ** polyhedralModelPtr = NULL;
+	// Array containing the manipulated version of the polyhedral models of each task
+	manipulated_polyhedral_model ** modifiedPolyhedralModelPtr = NULL;
+	// Array of the lattices
+	isl_set *** translatesPtr = NULL;
+	// Set of all the linearized dates across the concurrent tasks
+	isl_set * linearizedDatesPtr = NULL;
+	// Return value
+	int outcome = -1;
+	
+	resultPtr -> dimAddressSpace = 0;
+	resultPtr -> numLattices = 0;
+	resultPtr -> cost = NULL;
+	resultPtr -> bestLatticeIdx = 0;
+	resultPtr -> bestCost = 0;
+	
+	if (archPtr == NULL)
+		archPtr = &defaultArchitecture;
+	
+	if (optionsHdl == NULL || numTasks == 0 || numTasks > archPtr -> maxTasks)
+		return -1;
+	
+	// Without a log stream the messages are discarded
+	if (stream == NULL) {
+		stream = fopen("/dev/null", "w");
+		
+		if (stream == NULL)
+			return -1;
+	}
+	
+	phasePtr = start(stream);
+	polyhedralModelPtr = calloc(numTasks, sizeof(pet_scop *));
+	
+	if (phasePtr == NULL || polyhedralModelPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	// 1) Polyhedral models
+	for (int i = 0; i < numTasks; i++) {
+		polyhedralModelPtr[i] = tasks[i].scop != NULL ? tasks[i].scop : task_scop_build(stream, optionsHdl, archPtr, &tasks[i]);
+		
+		if (polyhedralModelPtr[i] == NULL) {
+			error(stream, "Error during parsing input files");
+			goto cleanup;
+		}
+	}
+	
+	complete_phase(stream, phasePtr);
+	
+	// 2) Virtual memory allocation
+	new_phase(stream, phasePtr);
+	
+	modifiedPolyhedralModelPtr = manipulated_polyhedral_model_array_alloc(numTasks);
+	
+	if (modifiedPolyhedralModelPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	if (virtual_allocation(stream, optionsHdl, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, &(resultPtr -> dimAddressSpace), &defaultPlacement) == isl_stat_error) {
+		error(stream, "Error during virtual address space allocation");
+		goto cleanup;
+	}
+	
+	// 3) Reading the lattices with all the translates
+	new_phase(stream, phasePtr);
+	
+	translatesPtr = parse_lattices(stream, optionsHdl, archPtr, &(resultPtr -> numLattices), resultPtr -> dimAddressSpace);
+	
+	if (translatesPtr == NULL) {
+		error(stream, "Error during parsing lattices :(");
+		resultPtr -> numLattices = 0;
+		goto cleanup;
+	}
+	
+	complete_phase(stream, phasePtr);
+	
+	// 4) Building the physical schedule
+	new_phase(stream, phasePtr);
+	
+	if (physical_schedule(stream, optionsHdl, archPtr, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks) == isl_stat_error) {
+		error(stream, "Error during physical schedule building");
+		goto cleanup;
+	}
+	
+	complete_phase(stream, phasePtr);
+	
+	// 5) Building the linearized schedule
+	new_phase(stream, phasePtr);
+	
+	if (eliminate_parameters(stream, archPtr, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks) == isl_stat_error) {
+		error(stream, "Error during parameter projection out");
+		goto cleanup;
+	}
+	
+	if (linearize_dates(stream, modifiedPolyhedralModelPtr, numTasks) == isl_stat_error) {
+		error(stream, "Error during dates linearization");
+		goto cleanup;
+	}
+	
+	linearizedDatesPtr = linearized_dates_union(stream, modifiedPolyhedralModelPtr, numTasks);
+	
+	if (linearizedDatesPtr == NULL) {
+		error(stream, "Error during dates union");
+		goto cleanup;
+	}
+	
+	complete_phase(stream, phasePtr);
+	
+	// 6) - 8) Concurrent part, for each one of the linearized dates
+	resultPtr -> cost = malloc(resultPtr -> numLattices * sizeof(unsigned long));
+	
+	if (resultPtr -> cost == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	if (cost_function_compute(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearizedDatesPtr, translatesPtr, resultPtr -> numLattices, archPtr -> numBanks, &(archPtr -> memory), resultPtr -> cost, NULL, NULL, NULL) == isl_stat_error) {
+		error(stream, "Error during the concurrent part");
+		goto cleanup;
+	}
+	
+	// 9) Cost function evaluation
+	new_phase(stream, phasePtr);
+	
+	resultPtr -> bestLatticeIdx = best_lattice(stream, resultPtr -> cost, resultPtr -> numLattices, &(resultPtr -> bestCost));
+	
+	complete_phase(stream, phasePtr);
+	
+	outcome = 0;
+
+cleanup:
+	if (outcome < 0) {
+		if (phasePtr != NULL)
+			fail_phase(stream, phasePtr);
+		
+		free(resultPtr -> cost);
+		resultPtr -> cost = NULL;
+	}
+	
+	isl_set_free(linearizedDatesPtr);
+	
+	if (translatesPtr != NULL)
+		lattices_free(translatesPtr, resultPtr -> numLattices, archPtr -> numBanks);
+	
+	if (modifiedPolyhedralModelPtr != NULL)
+		manipulated_polyhedral_model_array_free(modifiedPolyhedralModelPtr, numTasks);
+	
+	// Only the polyhedral models built here are released
+	if (polyhedralModelPtr != NULL)
+		for (int i = 0; i < numTasks; i++)
+			if (tasks[i].scop == NULL)
+				pet_scop_free(polyhedralModelPtr[i]);
+	
+	free(polyhedralModelPtr);
+	phase_free(phasePtr);
+	
+	if (stream != logHdl)
+		fclose(stream);
+	
+	return outcome;
+}
+
+void uma_result_free(uma_result * resultPtr) {
+	free(resultPtr -> cost);
+	resultPtr -> cost = NULL;
+	resultPtr -> numLattices = 0;
+}
+
+pet_scop * task_scop_build(FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, const uma_task * taskPtr) {
+	// Polyhedral model of the task
+	pet_scop * scop = NULL;
+	// Name of the task, as expected by the parser
+	char * name = (char *)taskPtr -> name;
+	// Name of the temporary file holding the in - memory source
+	char fileName[] = "/tmp/libumaXXXXXX.c";
+	// Descriptor of the temporary file
+	int fileHdl = -1;
+	// Handle to the temporary file
+	FILE * sourceHdl = NULL;
+	
+	if (taskPtr -> source == NULL) {
+		// pet only extracts from files, so the configured directories are used
+		if (name == NULL || parse_input(stream, optionsHdl, archPtr, &name, &scop, 1) == isl_stat_error)
+			return NULL;
+	} else {
+		fileHdl = mkstemps(fileName, 2);
+		
+		if (fileHdl < 0) {
+			error(stream, "Cannot create a temporary source file");
+			return NULL;
+		}
+		
+		sourceHdl = fdopen(fileHdl, "w");
+		
+		if (sourceHdl == NULL) {
+			close(fileHdl);
+			unlink(fileName);
+			return NULL;
+		}
+		
+		fputs(taskPtr -> source, sourceHdl);
+		fclose(sourceHdl);
+		
+		scop = pet_scop_extract_from_C_source(optionsHdl, fileName, NULL);
+		unlink(fileName);
+		
+		if (scop == NULL) {
+			error(stream, "Sorry, there is something wrong with the pet library :(");
+			return NULL;
+		}
+	}
+	
+	// An in - memory schedule replaces the one of the source
+	if (taskPtr -> schedule != NULL) {
+		isl_schedule_free(scop -> schedule);
+		scop -> schedule = isl_schedule_read_from_str(optionsHdl, taskPtr -> schedule);
+		
+		if (scop -> schedule == NULL) {
+			error(stream, "Problems when reading a schedule");
+			pet_scop_free(scop);
+			return NULL;
+		}
+	}
+	
+	return scop;
+}
@@ -0,0 +1,40 @@
+/*
+ * Definitions of the embeddable interface of the lattice - based memory
+ * partitioning technique. These functions never terminate the process and
+ * keep no global state, so that they can be called concurrently as long as
+ * each caller works with its own isl context.
+ */
+
+#ifndef LIBUMA_H
+#define LIBUMA_H
+
+#include<stdio.h>
+
+#include<pet.h>
+#include<isl/ctx.h>
+
+#include "config.h"
+
+// A task is described either by its name, to be found in the directories of
+// the configuration, or by its in - memory source and schedule, or by an
+// already extracted polyhedral model, which is only borrowed
+typedef struct {
+	const char * name;
+	const char * source;
+	const char * schedule;
+	pet_scop * scop;
+} uma_task;
+
+typedef struct {
+	unsigned dimAddressSpace;
+	unsigned numLattices;
+	unsigned long * cost;
+	unsigned bestLatticeIdx;
+	unsigned long bestCost;
+} uma_result;
+
+isl_ctx * uma_ctx_alloc(void);
+int uma_partition(isl_ctx *, const architecture_config *, FILE *, const uma_task *, unsigned, uma_result *);
+void uma_result_free(uma_result *);
+
+#endif /* LIBUMA_H */
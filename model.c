@@ -28,6 +28,16 @@ manipulated_polyhedral_model ** manipulated_polyhedral_model_array_alloc(unsigne
 			
 			return NULL;
 		}
+		
+		array[i] -> instanceSet = NULL;
+		array[i] -> flattenedSchedule = NULL;
+		array[i] -> remappedMayReads = NULL;
+		array[i] -> remappedMayWrites = NULL;
+		array[i] -> remappedMustWrites = NULL;
+		array[i] -> linearizedSchedule = NULL;
+		array[i] -> processorSchedule = NULL;
+		array[i] -> mergedAccesses = NULL;
+		array[i] -> taggedAccesses = NULL;
 	}
 	
 	return array;
@@ -35,8 +45,18 @@ manipulated_polyhedral_model ** manipulated_polyhedral_model_array_alloc(unsigne
 }
 
 void manipulated_polyhedral_model_array_free(manipulated_polyhedral_model ** array, unsigned numTasks) {
-	for (int i = 0; i < numTasks; i++)
+	for (int i = 0; i < numTasks; i++) {
+		isl_union_set_free(array[i] -> instanceSet);
+		isl_union_map_free(array[i] -> flattenedSchedule);
+		isl_union_map_free(array[i] -> remappedMayReads);
+		isl_union_map_free(array[i] -> remappedMayWrites);
+		isl_union_map_free(array[i] -> remappedMustWrites);
+		isl_union_map_free(array[i] -> linearizedSchedule);
+		isl_union_map_free(array[i] -> processorSchedule);
+		isl_union_map_free(array[i] -> mergedAccesses);
+		isl_union_map_free(array[i] -> taggedAccesses);
 		free(array[i]);
+	}
 	
 	free(array);
 }
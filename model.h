@@ -14,8 +14,20 @@ typedef struct {
 	isl_union_map * remappedMayWrites;
 	isl_union_map * remappedMustWrites;
 	isl_union_map * linearizedSchedule;
+	isl_union_map * processorSchedule;
+	isl_union_map * mergedAccesses;
+	isl_union_map * taggedAccesses;
 } manipulated_polyhedral_model; 
 
+// Placement of the arrays in the virtual address space: each array has its own
+// coordinate of the policy dimension and is shifted along its first dimension
+// by its index times the offset, unless the arrays of each task share the
+// coordinate of the task and are interleaved along their first dimension
+typedef struct {
+	unsigned interleaved;
+	unsigned offset;
+} placement_policy;
+
 manipulated_polyhedral_model ** manipulated_polyhedral_model_array_alloc(unsigned);
 void manipulated_polyhedral_model_array_free(manipulated_polyhedral_model ** , unsigned);
 
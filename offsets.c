@@ -0,0 +1,448 @@
+/*
+ * Implementation of the search over the start offsets of the tasks. A task
+ * accesses the same addresses at its own dates whatever its offset, so the
+ * dataset of each date of each task is built once; a set of offsets only
+ * decides which datasets meet at each global date. The dates where a single
+ * task runs cost what they cost alone, which is computed once per lattice,
+ * and a lattice stops being evaluated under a set of offsets as soon as its
+ * conflicts reach the best ones found so far. Each date of a task keeps the
+ * datasets its timing model needs: the addresses accessed, the addresses read
+ * and written apart for the ports, or those of each processor for the
+ * latencies.
+ */
+#include<stdlib.h>
+#include<limits.h>
+
+#include<isl/set.h>
+#include<isl/union_set.h>
+#include<isl/union_map.h>
+#include<isl/aff.h>
+
+#include "config.h"
+#include "support.h"
+#include "partitioning.h"
+#include "counting.h"
+#include "offsets.h"
+
+// Initial size of the scratch arena of the datasets of a task
+#define OFFSETSARENASIZE 4096
+
+typedef struct {
+	FILE * stream;
+	manipulated_polyhedral_model ** modelPtr;
+	const memory_model * memoryPtr;
+	unsigned numSlots;
+	isl_set ** datasetPtr;
+	scratch_arena * arenaPtr;
+} task_dataset_params;
+
+typedef struct {
+	FILE * stream;
+	unsigned numTasks;
+	const memory_model * memoryPtr;
+	unsigned numSlots;
+	isl_set *** datasetPtr;
+	isl_set ** dateDatasetPtr;
+	unsigned long * numDates;
+	unsigned long ** soloCost;
+	isl_set *** translatesPtr;
+	unsigned numLattices;
+	unsigned numBanks;
+	unsigned long * runCost;
+	unsigned long points;
+} offset_search;
+
+unsigned memory_slots(const memory_model *);
+isl_set ** task_datasets_build(FILE *, manipulated_polyhedral_model **, const memory_model *, unsigned long *);
+isl_stat task_dataset_build(isl_point *, void *);
+isl_stat offsets_datasets_merge(offset_search *, unsigned *, unsigned long);
+isl_stat offsets_lattice_evaluate(offset_search *, isl_set **, unsigned, unsigned long *);
+isl_stat offsets_evaluate(offset_search *, unsigned *, unsigned long);
+
+// Number of datasets kept for each date under the timing model
+unsigned memory_slots(const memory_model * memoryPtr) {
+	
+	if (memoryPtr -> latency != NULL)
+		return memoryPtr -> latency -> numProcessors;
+	
+	return memoryPtr -> ports != NULL ? 2 : 1;
+}
+
+isl_set ** task_datasets_build(FILE * stream, manipulated_polyhedral_model ** modelPtr, const memory_model * memoryPtr, unsigned long * numDatesPtr) {
+	// Parameters for the callback function
+	task_dataset_params params;
+	// Linearized dates of the task
+	isl_set * datesPtr = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_error;
+	
+	params.stream = stream;
+	params.modelPtr = modelPtr;
+	params.memoryPtr = memoryPtr;
+	params.numSlots = memory_slots(memoryPtr);
+	params.datasetPtr = NULL;
+	params.arenaPtr = arena_alloc(OFFSETSARENASIZE);
+	datesPtr = isl_set_from_union_set(isl_union_map_range(isl_union_map_copy((*modelPtr) -> linearizedSchedule)));
+	
+	// The dates of a task are numbered from 0 without gaps
+	if (params.arenaPtr == NULL || datesPtr == NULL || set_count(datesPtr, numDatesPtr) == isl_stat_error)
+		goto cleanup;
+	
+	params.datasetPtr = calloc(*numDatesPtr * params.numSlots, sizeof(isl_set *));
+	
+	if (params.datasetPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	outcome = isl_set_foreach_point(datesPtr, task_dataset_build, &params);
+	
+	if (outcome == isl_stat_error) {
+		dataset_array_free(params.datasetPtr, *numDatesPtr * params.numSlots);
+		free(params.datasetPtr);
+		params.datasetPtr = NULL;
+	}
+
+cleanup:
+	isl_set_free(datesPtr);
+	
+	if (params.arenaPtr != NULL)
+		arena_free(params.arenaPtr);
+	
+	return params.datasetPtr;
+}
+
+isl_stat task_dataset_build(isl_point * pointPtr, void * user) {
+	// Pointer to the input parameters
+	task_dataset_params * params = (task_dataset_params *)user;
+	// Coordinate of the linearized date
+	isl_val * dateVal = isl_point_get_coordinate_val(pointPtr, isl_dim_set, 0);
+	// Index of the date
+	long date = isl_val_get_num_si(dateVal);
+	// Polyhedral slice of the task at the date
+	isl_union_set * slicePtr = NULL;
+	// Datasets of the date
+	isl_set ** slotsPtr = params -> datasetPtr + date * params -> numSlots;
+	// Datasets of the processors, in the scratch arena
+	isl_set ** processorDatasetPtr = NULL;
+	// Addresses accessed at the date, when the ports only need them for their space
+	isl_set * datasetPtr = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_error;
+	
+	isl_val_free(dateVal);
+	slicePtr = polyhedral_slice_build(params -> stream, isl_union_map_copy((*params -> modelPtr) -> flattenedSchedule), isl_union_map_copy((*params -> modelPtr) -> linearizedSchedule), pointPtr);
+	isl_point_free(pointPtr);
+	
+	if (slicePtr == NULL) {
+		error(params -> stream, "Error during polyhedral slices building");
+		return isl_stat_error;
+	}
+	
+	// The same datasets as the concurrent part builds for the timing model
+	if (params -> memoryPtr -> latency != NULL) {
+		processorDatasetPtr = processor_datasets_build(params -> stream, params -> modelPtr, &slicePtr, 1, params -> numSlots, params -> arenaPtr);
+		
+		if (processorDatasetPtr != NULL) {
+			for (int p = 0; p < params -> numSlots; p++)
+				slotsPtr[p] = processorDatasetPtr[p];
+			
+			outcome = isl_stat_ok;
+		}
+	} else if (params -> memoryPtr -> ports != NULL && (*params -> modelPtr) -> taggedAccesses != NULL)
+		outcome = tagged_datasets_build(params -> stream, params -> modelPtr, &slicePtr, 1, &(slotsPtr[0]), &(slotsPtr[1]));
+	else if (params -> memoryPtr -> ports != NULL) {
+		datasetPtr = concurrent_dataset_build(params -> stream, params -> modelPtr, &slicePtr, 1, params -> arenaPtr);
+		
+		if (datasetPtr != NULL)
+			outcome = access_datasets_build(params -> stream, params -> modelPtr, &slicePtr, 1, datasetPtr, &(slotsPtr[0]), &(slotsPtr[1]));
+		
+		isl_set_free(datasetPtr);
+	} else {
+		slotsPtr[0] = concurrent_dataset_build(params -> stream, params -> modelPtr, &slicePtr, 1, params -> arenaPtr);
+		outcome = slotsPtr[0] != NULL ? isl_stat_ok : isl_stat_error;
+	}
+	
+	isl_union_set_free(slicePtr);
+	arena_reset(params -> arenaPtr);
+	
+	if (outcome == isl_stat_error)
+		error(params -> stream, "Error during concurrent dataset building");
+	
+	return outcome;
+}
+
+// The datasets of the tasks running at the date are merged slot by slot
+isl_stat offsets_datasets_merge(offset_search * searchPtr, unsigned * offsets, unsigned long t) {
+	// Dataset of a task at the date
+	isl_set * taskDatasetPtr = NULL;
+	
+	for (int s = 0; s < searchPtr -> numSlots; s++) {
+		searchPtr -> dateDatasetPtr[s] = NULL;
+		
+		for (int i = 0; i < searchPtr -> numTasks; i++) {
+			
+			if (t < offsets[i] || t >= offsets[i] + searchPtr -> numDates[i])
+				continue;
+			
+			taskDatasetPtr = searchPtr -> datasetPtr[i][(t - offsets[i]) * searchPtr -> numSlots + s];
+			
+			// An idle processor has no dataset
+			if (taskDatasetPtr == NULL)
+				continue;
+			
+			if (searchPtr -> dateDatasetPtr[s] == NULL)
+				searchPtr -> dateDatasetPtr[s] = isl_set_copy(taskDatasetPtr);
+			else if ((searchPtr -> dateDatasetPtr[s] = isl_set_union(searchPtr -> dateDatasetPtr[s], isl_set_copy(taskDatasetPtr))) == NULL) {
+				dataset_array_free(searchPtr -> dateDatasetPtr, s);
+				return isl_stat_error;
+			}
+		}
+		
+		if (searchPtr -> dateDatasetPtr[s] != NULL)
+			searchPtr -> dateDatasetPtr[s] = isl_set_coalesce(searchPtr -> dateDatasetPtr[s]);
+	}
+	
+	return isl_stat_ok;
+}
+
+// The lattice is charged what the timing model charges, as in the concurrent part
+isl_stat offsets_lattice_evaluate(offset_search * searchPtr, isl_set ** slotsPtr, unsigned l, unsigned long * costPtr) {
+	
+	if (searchPtr -> memoryPtr -> latency != NULL)
+		return evaluate_fundamental_lattice_numa(searchPtr -> stream, slotsPtr, searchPtr -> memoryPtr -> latency, searchPtr -> translatesPtr[l], costPtr, NULL, &(searchPtr -> points));
+	
+	if (searchPtr -> memoryPtr -> ports != NULL)
+		return evaluate_fundamental_lattice_ports(searchPtr -> stream, slotsPtr[0], slotsPtr[1], searchPtr -> translatesPtr[l], searchPtr -> numBanks, searchPtr -> memoryPtr -> ports, costPtr, NULL, &(searchPtr -> points));
+	
+	return evaluate_fundamental_lattice(searchPtr -> stream, slotsPtr[0], searchPtr -> translatesPtr[l], searchPtr -> numBanks, costPtr, NULL, &(searchPtr -> points));
+}
+
+// Charges each lattice the conflicts of the offsets, giving up on those reaching the bound
+isl_stat offsets_evaluate(offset_search * searchPtr, unsigned * offsets, unsigned long bound) {
+	// Number of global dates covered by the offsets
+	unsigned long span = 0;
+	// Number of lattices still below the bound
+	unsigned alive = 0;
+	// Number of tasks running at the current date and the last of them
+	unsigned active = 0;
+	unsigned lastTask = 0;
+	// Datasets of the current date, those of the task when it runs alone
+	isl_set ** slotsPtr = NULL;
+	// Conflicts of a date when its task runs alone
+	unsigned long * soloPtr = NULL;
+	
+	for (int i = 0; i < searchPtr -> numTasks; i++)
+		if (offsets[i] + searchPtr -> numDates[i] > span)
+			span = offsets[i] + searchPtr -> numDates[i];
+	
+	for (int l = 0; l < searchPtr -> numLattices; l++) {
+		searchPtr -> runCost[l] = searchPtr -> translatesPtr[l] != NULL ? 0 : ULONG_MAX;
+		alive += searchPtr -> translatesPtr[l] != NULL ? 1 : 0;
+	}
+	
+	for (unsigned long t = 0; t < span && alive > 0; t++) {
+		active = 0;
+		
+		for (int i = 0; i < searchPtr -> numTasks; i++)
+			if (t >= offsets[i] && t < offsets[i] + searchPtr -> numDates[i]) {
+				active += 1;
+				lastTask = i;
+			}
+		
+		if (active == 0)
+			continue;
+		
+		if (active > 1 && offsets_datasets_merge(searchPtr, offsets, t) == isl_stat_error)
+			return isl_stat_error;
+		
+		slotsPtr = active > 1 ? searchPtr -> dateDatasetPtr : searchPtr -> datasetPtr[lastTask] + (t - offsets[lastTask]) * searchPtr -> numSlots;
+		
+		for (int l = 0; l < searchPtr -> numLattices; l++) {
+			if (searchPtr -> runCost[l] == ULONG_MAX)
+				continue;
+			
+			if (active > 1) {
+				if (offsets_lattice_evaluate(searchPtr, slotsPtr, l, &(searchPtr -> runCost[l])) == isl_stat_error) {
+					dataset_array_free(slotsPtr, searchPtr -> numSlots);
+					return isl_stat_error;
+				}
+			} else {
+				soloPtr = &(searchPtr -> soloCost[lastTask][(t - offsets[lastTask]) * searchPtr -> numLattices + l]);
+				
+				if (*soloPtr == ULONG_MAX) {
+					*soloPtr = 0;
+					
+					if (offsets_lattice_evaluate(searchPtr, slotsPtr, l, soloPtr) == isl_stat_error)
+						return isl_stat_error;
+				}
+				
+				searchPtr -> runCost[l] += *soloPtr;
+			}
+			
+			// The costs only grow with the dates
+			if (searchPtr -> runCost[l] >= bound) {
+				searchPtr -> runCost[l] = ULONG_MAX;
+				alive -= 1;
+			}
+		}
+		
+		if (active > 1)
+			dataset_array_free(slotsPtr, searchPtr -> numSlots);
+	}
+	
+	return isl_stat_ok;
+}
+
+unsigned * offsets_search(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, const memory_model * memoryPtr, unsigned maxOffset) {
+	// State of the search
+	offset_search search;
+	// Offsets being evaluated and best ones
+	unsigned * offsets = NULL;
+	unsigned * bestOffsets = NULL;
+	// Smallest offset of the current set, one of them being 0
+	unsigned minOffset = 0;
+	// Best lattice and its conflicts
+	unsigned bestLatticeIdx = 0;
+	unsigned long bestCost = ULONG_MAX;
+	// Number of sets of offsets evaluated
+	unsigned numEvaluated = 0;
+	// Task whose offset is being advanced
+	int k = 0;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_error;
+	
+	search.stream = stream;
+	search.numTasks = numTasks;
+	search.memoryPtr = memoryPtr;
+	search.numSlots = memory_slots(memoryPtr);
+	search.translatesPtr = translatesPtr;
+	search.numLattices = numLattices;
+	search.numBanks = numBanks;
+	search.points = 0;
+	search.datasetPtr = calloc(numTasks, sizeof(isl_set **));
+	search.dateDatasetPtr = calloc(search.numSlots, sizeof(isl_set *));
+	search.numDates = calloc(numTasks, sizeof(unsigned long));
+	search.soloCost = calloc(numTasks, sizeof(unsigned long *));
+	search.runCost = malloc(numLattices * sizeof(unsigned long));
+	offsets = calloc(numTasks, sizeof(unsigned));
+	bestOffsets = calloc(numTasks, sizeof(unsigned));
+	
+	if (search.datasetPtr == NULL || search.dateDatasetPtr == NULL || search.numDates == NULL || search.soloCost == NULL || search.runCost == NULL || offsets == NULL || bestOffsets == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	// The datasets of the tasks do not depend on their offsets
+	for (int i = 0; i < numTasks; i++) {
+		search.datasetPtr[i] = task_datasets_build(stream, &(modifiedPolyhedralModelPtr[i]), memoryPtr, &(search.numDates[i]));
+		
+		if (search.datasetPtr[i] == NULL) {
+			error(stream, "Error during the datasets of the tasks");
+			goto cleanup;
+		}
+		
+		search.soloCost[i] = malloc(search.numDates[i] * numLattices * sizeof(unsigned long));
+		
+		if (search.soloCost[i] == NULL) {
+			error(stream, "Memory allocation problem :(");
+			goto cleanup;
+		}
+		
+		for (unsigned long j = 0; j < search.numDates[i] * numLattices; j++)
+			search.soloCost[i][j] = ULONG_MAX;
+	}
+	
+	// Every combination in [0, maxOffset] starting some task at 0, the others being shifts of it
+	do {
+		minOffset = offsets[0];
+		
+		for (int i = 1; i < numTasks; i++)
+			if (offsets[i] < minOffset)
+				minOffset = offsets[i];
+		
+		if (minOffset == 0) {
+			if (offsets_evaluate(&search, offsets, bestCost) == isl_stat_error) {
+				error(stream, "Error during the evaluation of the offsets");
+				goto cleanup;
+			}
+			
+			numEvaluated += 1;
+			
+			// The ties go to the smaller offsets, met first
+			for (int l = 0; l < numLattices; l++)
+				if (search.runCost[l] < bestCost) {
+					bestCost = search.runCost[l];
+					bestLatticeIdx = l;
+					
+					for (int i = 0; i < numTasks; i++)
+						bestOffsets[i] = offsets[i];
+				}
+		}
+		
+		for (k = 0; k < numTasks && ++offsets[k] > maxOffset; k++)
+			offsets[k] = 0;
+	} while (k < numTasks);
+	
+	if (bestCost == ULONG_MAX) {
+		error(stream, "No lattice left to stagger the tasks");
+		goto cleanup;
+	}
+	
+	info(stream, "Sets of start offsets evaluated: %d", numEvaluated);
+	fprintf(stream, "The start offsets with the fewest conflicts are");
+	
+	for (int i = 0; i < numTasks; i++)
+		fprintf(stream, " %u", bestOffsets[i]);
+	
+	fprintf(stream, ", with the lattice number %u and a cost of %lu\n", bestLatticeIdx, bestCost);
+	fflush(stream);
+	outcome = isl_stat_ok;
+
+cleanup:
+	if (search.datasetPtr != NULL)
+		for (int i = 0; i < numTasks; i++)
+			if (search.datasetPtr[i] != NULL) {
+				dataset_array_free(search.datasetPtr[i], search.numDates[i] * search.numSlots);
+				free(search.datasetPtr[i]);
+			}
+	
+	if (search.soloCost != NULL)
+		for (int i = 0; i < numTasks; i++)
+			free(search.soloCost[i]);
+	
+	free(search.datasetPtr);
+	free(search.dateDatasetPtr);
+	free(search.numDates);
+	free(search.soloCost);
+	free(search.runCost);
+	free(offsets);
+	
+	if (outcome == isl_stat_error) {
+		free(bestOffsets);
+		return NULL;
+	}
+	
+	return bestOffsets;
+}
+
+isl_stat offsets_apply(FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, unsigned * offsets) {
+	// Shift of the linearized dates of a task
+	isl_aff * shiftPtr = NULL;
+	
+	for (int i = 0; i < numTasks; i++) {
+		if (offsets[i] == 0)
+			continue;
+		
+		shiftPtr = isl_aff_var_on_domain(isl_local_space_from_space(isl_space_set_alloc(isl_union_map_get_ctx(modifiedPolyhedralModelPtr[i] -> linearizedSchedule), 0, 1)), isl_dim_set, 0);
+		shiftPtr = isl_aff_add_constant_si(shiftPtr, offsets[i]);
+		modifiedPolyhedralModelPtr[i] -> linearizedSchedule = isl_union_map_apply_range(modifiedPolyhedralModelPtr[i] -> linearizedSchedule, isl_union_map_from_map(isl_map_from_aff(shiftPtr)));
+		
+		if (modifiedPolyhedralModelPtr[i] -> linearizedSchedule == NULL) {
+			error(stream, "Error during the shift of the linearized schedule");
+			return isl_stat_error;
+		}
+	}
+	
+	return isl_stat_ok;
+}
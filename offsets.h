@@ -0,0 +1,21 @@
+/*
+ * Definitions of the joint search over the start offsets of the tasks and the
+ * lattice. Each task is delayed by a number of linearized dates, and the
+ * offsets with the lowest cost under their best lattice, in the timing model
+ * of the banks, are kept.
+ */
+
+#ifndef OFFSETS_H
+#define OFFSETS_H
+
+#include<stdio.h>
+
+#include<isl/set.h>
+
+#include "config.h"
+#include "model.h"
+
+unsigned * offsets_search(FILE *, manipulated_polyhedral_model **, unsigned, isl_set ***, unsigned, unsigned, const memory_model *, unsigned);
+isl_stat offsets_apply(FILE *, manipulated_polyhedral_model **, unsigned, unsigned *);
+
+#endif /* OFFSETS_H */
@@ -15,6 +15,7 @@
 #include "config.h"
 #include "support.h"
 #include "partitioning.h"
+#include "profiling.h"
 
 typedef struct {
 	union {
@@ -22,22 +23,23 @@ typedef struct {
 		isl_union_set * uset;
 	} bounded;
 	unsigned taskNum;
+	const architecture_config * archPtr;
 #ifdef MOREVERBOSE
 	isl_printer * printer;
 #endif
 } add_parameter_constraint_params;
 
 #ifndef MOREVERBOSE
-isl_union_map * eliminate_parameters_map(isl_union_map *, unsigned);
-isl_union_set * eliminate_parameters_set(isl_union_set *, unsigned);
+isl_union_map * eliminate_parameters_map(const architecture_config *, isl_union_map *, unsigned);
+isl_union_set * eliminate_parameters_set(const architecture_config *, isl_union_set *, unsigned);
 #else
-isl_union_map * eliminate_parameters_map(isl_printer *, isl_union_map *, unsigned);
-isl_union_set * eliminate_parameters_set(isl_printer *, isl_union_set *, unsigned);
+isl_union_map * eliminate_parameters_map(isl_printer *, const architecture_config *, isl_union_map *, unsigned);
+isl_union_set * eliminate_parameters_set(isl_printer *, const architecture_config *, isl_union_set *, unsigned);
 #endif
 isl_stat add_parameter_constraint_map (isl_map *, void *);
 isl_stat add_parameter_constraint_set (isl_set *, void *);
 
-isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModel, unsigned numTasks) {
+isl_stat eliminate_parameters (FILE * stream, const architecture_config * archPtr, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModel, unsigned numTasks) {
 	
 #ifdef MOREVERBOSE
 	// Pointer to the printer
@@ -48,7 +50,7 @@ isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, ma
 #ifdef MOREVERBOSE
 		info(stream, "Task %d)", i);
 		
-		printer = isl_printer_to_file(isl_union_set_get_ctx(pet_scop_get_instance_set(polyhedralModelPtr[i])), stream);
+		printer = isl_printer_to_file(isl_union_map_get_ctx(modifiedPolyhedralModel[i] -> flattenedSchedule), stream);
 		
 		if(printer == NULL) {
 			error(stream, "Memory allocation problem :(");
@@ -59,9 +61,9 @@ isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, ma
 #endif
 		
 #ifndef MOREVERBOSE
-		modifiedPolyhedralModel[i] -> instanceSet = eliminate_parameters_set(pet_scop_get_instance_set(polyhedralModelPtr[i]), i);
+		modifiedPolyhedralModel[i] -> instanceSet = eliminate_parameters_set(archPtr, pet_scop_get_instance_set(polyhedralModelPtr[i]), i);
 #else
-		modifiedPolyhedralModel[i] -> instanceSet = eliminate_parameters_set(printer, pet_scop_get_instance_set(polyhedralModelPtr[i]), i);
+		modifiedPolyhedralModel[i] -> instanceSet = eliminate_parameters_set(printer, archPtr, pet_scop_get_instance_set(polyhedralModelPtr[i]), i);
 #endif
 		
 		if (modifiedPolyhedralModel[i] -> instanceSet == NULL)
@@ -81,9 +83,9 @@ isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, ma
 #endif
 		
 #ifndef MOREVERBOSE
-		modifiedPolyhedralModel[i] -> flattenedSchedule = eliminate_parameters_map (modifiedPolyhedralModel[i] -> flattenedSchedule, i);
+		modifiedPolyhedralModel[i] -> flattenedSchedule = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> flattenedSchedule, i);
 #else
-		modifiedPolyhedralModel[i] -> flattenedSchedule = eliminate_parameters_map (printer, modifiedPolyhedralModel[i] -> flattenedSchedule, i);
+		modifiedPolyhedralModel[i] -> flattenedSchedule = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> flattenedSchedule, i);
 #endif
 		
 		if (modifiedPolyhedralModel[i] -> flattenedSchedule == NULL)
@@ -103,9 +105,9 @@ isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, ma
 #endif
 		
 #ifndef MOREVERBOSE
-		modifiedPolyhedralModel[i] -> remappedMayReads = eliminate_parameters_map (modifiedPolyhedralModel[i] -> remappedMayReads, i);
+		modifiedPolyhedralModel[i] -> remappedMayReads = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> remappedMayReads, i);
 #else
-		modifiedPolyhedralModel[i] -> remappedMayReads = eliminate_parameters_map (printer, modifiedPolyhedralModel[i] -> remappedMayReads, i);
+		modifiedPolyhedralModel[i] -> remappedMayReads = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> remappedMayReads, i);
 #endif
 		
 		if (modifiedPolyhedralModel[i] -> remappedMayReads == NULL)
@@ -125,9 +127,9 @@ isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, ma
 #endif
 		
 #ifndef MOREVERBOSE
-		modifiedPolyhedralModel[i] -> remappedMayWrites = eliminate_parameters_map (modifiedPolyhedralModel[i] -> remappedMayWrites, i);
+		modifiedPolyhedralModel[i] -> remappedMayWrites = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> remappedMayWrites, i);
 #else
-		modifiedPolyhedralModel[i] -> remappedMayWrites = eliminate_parameters_map (printer, modifiedPolyhedralModel[i] -> remappedMayWrites, i);
+		modifiedPolyhedralModel[i] -> remappedMayWrites = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> remappedMayWrites, i);
 #endif
 		
 		if (modifiedPolyhedralModel[i] -> remappedMayWrites == NULL)
@@ -147,14 +149,26 @@ isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, ma
 #endif
 		
 #ifndef MOREVERBOSE
-		modifiedPolyhedralModel[i] -> remappedMustWrites = eliminate_parameters_map (modifiedPolyhedralModel[i] -> remappedMustWrites, i);
+		modifiedPolyhedralModel[i] -> remappedMustWrites = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> remappedMustWrites, i);
 #else
-		modifiedPolyhedralModel[i] -> remappedMustWrites = eliminate_parameters_map (printer, modifiedPolyhedralModel[i] -> remappedMustWrites, i);
+		modifiedPolyhedralModel[i] -> remappedMustWrites = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> remappedMustWrites, i);
 #endif
 		
 		if (modifiedPolyhedralModel[i] -> remappedMustWrites == NULL)
 			return isl_stat_error;
 		
+		// Without latencies no processor schedule is built
+		if (archPtr -> memory.latency != NULL) {
+#ifndef MOREVERBOSE
+			modifiedPolyhedralModel[i] -> processorSchedule = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> processorSchedule, i);
+#else
+			modifiedPolyhedralModel[i] -> processorSchedule = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> processorSchedule, i);
+#endif
+			
+			if (modifiedPolyhedralModel[i] -> processorSchedule == NULL)
+				return isl_stat_error;
+		}
+		
 #ifdef MOREVERBOSE
 		fprintf(stream, "Constrained must writes:\n");
 		fflush(stream);
@@ -176,10 +190,52 @@ isl_stat eliminate_parameters (FILE * stream, pet_scop ** polyhedralModelPtr, ma
 	
 }
 
+// Only the accesses are bounded, for a placement of the arrays applied to an already bounded model
+isl_stat eliminate_parameters_accesses (FILE * stream, const architecture_config * archPtr, manipulated_polyhedral_model ** modifiedPolyhedralModel, unsigned numTasks) {
+	
+#ifdef MOREVERBOSE
+	// Pointer to the printer
+	isl_printer * printer = NULL;
+#endif
+	
+	for (int i = 0; i < numTasks; i++) {
+#ifdef MOREVERBOSE
+		info(stream, "Task %d)", i);
+		
+		printer = isl_printer_to_file(isl_union_map_get_ctx(modifiedPolyhedralModel[i] -> remappedMayReads), stream);
+		
+		if(printer == NULL) {
+			error(stream, "Memory allocation problem :(");
+			return isl_stat_error;
+		} 
+		
+		isl_printer_set_indent(printer, moreIndent);
+#endif
+		
 #ifndef MOREVERBOSE
-isl_union_map * eliminate_parameters_map(isl_union_map * umap, unsigned taskNum) {
+		modifiedPolyhedralModel[i] -> remappedMayReads = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> remappedMayReads, i);
+		modifiedPolyhedralModel[i] -> remappedMayWrites = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> remappedMayWrites, i);
+		modifiedPolyhedralModel[i] -> remappedMustWrites = eliminate_parameters_map (archPtr, modifiedPolyhedralModel[i] -> remappedMustWrites, i);
 #else
-isl_union_map * eliminate_parameters_map(isl_printer * printer, isl_union_map * umap, unsigned taskNum) {
+		modifiedPolyhedralModel[i] -> remappedMayReads = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> remappedMayReads, i);
+		modifiedPolyhedralModel[i] -> remappedMayWrites = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> remappedMayWrites, i);
+		modifiedPolyhedralModel[i] -> remappedMustWrites = eliminate_parameters_map (printer, archPtr, modifiedPolyhedralModel[i] -> remappedMustWrites, i);
+		
+		isl_printer_free(printer);
+#endif
+		
+		if (modifiedPolyhedralModel[i] -> remappedMayReads == NULL || modifiedPolyhedralModel[i] -> remappedMayWrites == NULL || modifiedPolyhedralModel[i] -> remappedMustWrites == NULL)
+			return isl_stat_error;
+	}
+	
+	return isl_stat_ok;
+	
+}
+
+#ifndef MOREVERBOSE
+isl_union_map * eliminate_parameters_map(const architecture_config * archPtr, isl_union_map * umap, unsigned taskNum) {
+#else
+isl_union_map * eliminate_parameters_map(isl_printer * printer, const architecture_config * archPtr, isl_union_map * umap, unsigned taskNum) {
 	// Handle to the output stream
 	FILE * stream = NULL;
 #endif
@@ -198,20 +254,27 @@ isl_union_map * eliminate_parameters_map(isl_printer * printer, isl_union_map *
 	// Initialization of the parameters
 	params -> bounded.umap = NULL;
 	params -> taskNum = taskNum;	
+	params -> archPtr = archPtr;
 #ifdef MOREVERBOSE
 	params -> printer = printer; 
 #endif
 	
 	outcome = isl_union_map_foreach_map(umap, add_parameter_constraint_map, params);
 	
-	if (outcome == isl_stat_error)
+	if (outcome == isl_stat_error) {
+		isl_union_map_free(params -> bounded.umap);
+		isl_union_map_free(umap);
+		free(params);
 		return NULL;
+	}
 	
 	if (params -> bounded.umap != NULL)
 		returnMap = params -> bounded.umap;
 	else // builds an empty map in the same space of the given union map
 		returnMap = isl_union_map_empty(isl_space_alloc(isl_union_map_get_ctx(umap), 0,0,0));
-		
+	
+	// The given union map is replaced by the bounded one
+	isl_union_map_free(umap);
 	free(params);
 	
 #ifdef MOREVERBOSE
@@ -262,7 +325,7 @@ isl_stat add_parameter_constraint_map (isl_map * map, void * user) {
 	if (localSpacePtr == NULL)
 		return isl_stat_error;
 	
-	for (int i = 0; i < NUMPARAMS[params -> taskNum]; i++) {
+	for (int i = 0; i < params -> archPtr -> numParams[params -> taskNum]; i++) {
 	
 		parameterConstraintPtr = isl_constraint_alloc_equality(isl_local_space_copy(localSpacePtr));
 		
@@ -270,11 +333,13 @@ isl_stat add_parameter_constraint_map (isl_map * map, void * user) {
 			return isl_stat_error;
 		
 		parameterConstraintPtr = isl_constraint_set_coefficient_si(parameterConstraintPtr, isl_dim_param, i, 1);
-		parameterConstraintPtr = isl_constraint_set_constant_si(parameterConstraintPtr, -PARAMS[params -> taskNum][i]);
+		parameterConstraintPtr = isl_constraint_set_constant_si(parameterConstraintPtr, -params -> archPtr -> params[params -> taskNum][i]);
 		map = isl_map_add_constraint(map, parameterConstraintPtr);
 	}
 	
-	map = isl_map_project_out(map, isl_dim_param, 0, NUMPARAMS[params -> taskNum]);
+	isl_local_space_free(localSpacePtr);
+	
+	PROFILE_TIMED(PROFILE_PARAMETERS_PROJECT, map = isl_map_project_out(map, isl_dim_param, 0, params -> archPtr -> numParams[params -> taskNum]));
 	
 #ifdef MOREVERBOSE
 	fprintf(stream, "Map bounded:\n");
@@ -292,17 +357,19 @@ isl_stat add_parameter_constraint_map (isl_map * map, void * user) {
 	// To pass out the modified map
 	if (params -> bounded.umap == NULL)
 		params -> bounded.umap = isl_union_map_from_map(map);
-	else 
-		params -> bounded.umap = isl_union_map_union(params -> bounded.umap, isl_union_map_from_map(map));
+	else {
+		PROFILE_UNION_MAP(PROFILE_PARAMETERS_UNION, params -> bounded.umap);
+		PROFILE_TIMED(PROFILE_PARAMETERS_UNION, params -> bounded.umap = isl_union_map_union(params -> bounded.umap, isl_union_map_from_map(map)));
+	}
 	
 	return isl_stat_ok;
 	
 }
 
 #ifndef MOREVERBOSE
-isl_union_set * eliminate_parameters_set(isl_union_set * uset, unsigned taskNum) {
+isl_union_set * eliminate_parameters_set(const architecture_config * archPtr, isl_union_set * uset, unsigned taskNum) {
 #else
-isl_union_set * eliminate_parameters_set(isl_printer * printer, isl_union_set * uset, unsigned taskNum) {
+isl_union_set * eliminate_parameters_set(isl_printer * printer, const architecture_config * archPtr, isl_union_set * uset, unsigned taskNum) {
 	// Handle to the output stream
 	FILE * stream = NULL;
 #endif
@@ -321,6 +388,7 @@ isl_union_set * eliminate_parameters_set(isl_printer * printer, isl_union_set *
 	// Initialization of the parameters
 	params -> bounded.uset = NULL;
 	params -> taskNum = taskNum;
+	params -> archPtr = archPtr;
 	
 #ifdef MOREVERBOSE
 	params -> printer = printer;
@@ -328,8 +396,12 @@ isl_union_set * eliminate_parameters_set(isl_printer * printer, isl_union_set *
 	
 	outcome = isl_union_set_foreach_set(uset, add_parameter_constraint_set, params);
 	
-	if (outcome == isl_stat_error)
+	if (outcome == isl_stat_error) {
+		isl_union_set_free(params -> bounded.uset);
+		isl_union_set_free(uset);
+		free(params);
 		return NULL;
+	}
 	
 #ifdef MOREVERBOSE
 	stream = isl_printer_get_file(printer);
@@ -348,11 +420,14 @@ isl_union_set * eliminate_parameters_set(isl_printer * printer, isl_union_set *
 	returnSet = params -> bounded.uset;
 	free(params);
 	
-	if (returnSet != NULL)
-		return returnSet;
-	else { // builds an empty map in the same space of the given union map
-		return isl_union_set_empty(isl_space_set_alloc(isl_union_set_get_ctx(uset), 0,0));
-	}
+	// builds an empty set in the same space of the given union set
+	if (returnSet == NULL)
+		returnSet = isl_union_set_empty(isl_space_set_alloc(isl_union_set_get_ctx(uset), 0,0));
+	
+	// The given union set is replaced by the bounded one
+	isl_union_set_free(uset);
+	
+	return returnSet;
 
 }
 
@@ -388,7 +463,7 @@ isl_stat add_parameter_constraint_set (isl_set * set, void * user) {
 	if (localSpacePtr == NULL)
 		return isl_stat_error;
 	
-	for (int i = 0; i < NUMPARAMS[params -> taskNum]; i++) {
+	for (int i = 0; i < params -> archPtr -> numParams[params -> taskNum]; i++) {
 	
 		parameterConstraintPtr = isl_constraint_alloc_equality(isl_local_space_copy(localSpacePtr));
 		
@@ -396,11 +471,14 @@ isl_stat add_parameter_constraint_set (isl_set * set, void * user) {
 			return isl_stat_error;
 		
 		parameterConstraintPtr = isl_constraint_set_coefficient_si(parameterConstraintPtr, isl_dim_param, i, 1);
-		parameterConstraintPtr = isl_constraint_set_constant_si(parameterConstraintPtr, -PARAMS[params -> taskNum][i]);
+		parameterConstraintPtr = isl_constraint_set_constant_si(parameterConstraintPtr, -params -> archPtr -> params[params -> taskNum][i]);
 		set = isl_set_add_constraint(set, parameterConstraintPtr);
 	}
 	
-	set = isl_set_project_out(set, isl_dim_param, 0, NUMPARAMS[params -> taskNum]);
+	isl_local_space_free(localSpacePtr);
+	
+	PROFILE_SET(PROFILE_PARAMETERS_PROJECT, set);
+	PROFILE_TIMED(PROFILE_PARAMETERS_PROJECT, set = isl_set_project_out(set, isl_dim_param, 0, params -> archPtr -> numParams[params -> taskNum]));
 	
 #ifdef MOREVERBOSE
 	fprintf(stream, "Set bounded:\n");
@@ -418,8 +496,10 @@ isl_stat add_parameter_constraint_set (isl_set * set, void * user) {
 	// To pass out the modified set
 	if (params -> bounded.uset == NULL)
 		params -> bounded.uset = isl_union_set_from_set(set);
-	else 
-		params -> bounded.uset = isl_union_set_union(params -> bounded.uset, isl_union_set_from_set(set));
+	else {
+		PROFILE_UNION_SET(PROFILE_PARAMETERS_UNION, params -> bounded.uset);
+		PROFILE_TIMED(PROFILE_PARAMETERS_UNION, params -> bounded.uset = isl_union_set_union(params -> bounded.uset, isl_union_set_from_set(set)));
+	}
 	
 	return isl_stat_ok;
 	
@@ -0,0 +1,262 @@
+/*
+ * Implementation of the exploration of several numbers of banks. The
+ * catalogs are merged in a single one with room for the largest number of
+ * banks, the lattices with fewer banks ending their translates with NULL, so
+ * that the concurrent part builds the datasets of each date once for all of
+ * them. Since the timing models describe the banks of the configuration,
+ * the lattices are charged their conflicts.
+ */
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "partitioning.h"
+#include "capacity.h"
+#include "ranking.h"
+#include "pareto.h"
+
+typedef struct {
+	unsigned numBanks;
+	unsigned latticeIdx;
+	unsigned long cost;
+	unsigned long worstDate;
+} pareto_point;
+
+isl_set *** catalog_append(FILE *, isl_ctx *, const architecture_config *, unsigned, unsigned, isl_set *, isl_set ***, unsigned *, unsigned);
+int pareto_dominates(pareto_point *, pareto_point *);
+
+int bank_counts_parse(const char * text, unsigned ** countsPtr) {
+	// Number of bank counts read
+	int numCounts = 0;
+	// End of the current count
+	char * endPtr = NULL;
+	// Current count
+	unsigned long count = 0;
+	// Counts resized for the current one
+	unsigned * resizedPtr = NULL;
+	
+	*countsPtr = NULL;
+	
+	while (*text != '\0') {
+		count = strtoul(text, &endPtr, 10);
+		
+		if (endPtr == text || count < 2 || count > UINT_MAX || (*endPtr != ',' && *endPtr != '\0')) {
+			free(*countsPtr);
+			*countsPtr = NULL;
+			return -1;
+		}
+		
+		resizedPtr = realloc(*countsPtr, (numCounts + 1) * sizeof(unsigned));
+		
+		if (resizedPtr == NULL) {
+			free(*countsPtr);
+			*countsPtr = NULL;
+			return -1;
+		}
+		
+		*countsPtr = resizedPtr;
+		(*countsPtr)[numCounts++] = count;
+		text = *endPtr == ',' ? endPtr + 1 : endPtr;
+	}
+	
+	return numCounts;
+}
+
+// The lattices of a bank count join the merged catalog, resized to the largest count; on failure the merged catalog is released
+isl_set *** catalog_append(FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, unsigned numBanks, unsigned maxBanks, isl_set * addressSpacePtr, isl_set *** mergedPtr, unsigned * numMergedPtr, unsigned dim) {
+	// Configuration with the bank count
+	architecture_config countArch = *archPtr;
+	// Lattices of the bank count
+	isl_set *** translatesPtr = NULL;
+	// Number of lattices of the bank count
+	unsigned numLattices = 0;
+	// Storage needed in the banks under each lattice
+	bank_usage * usage = NULL;
+	// Resized merged catalog
+	isl_set *** resizedPtr = NULL;
+	
+	countArch.numBanks = numBanks;
+	translatesPtr = parse_lattices(stream, optionsHdl, &countArch, &numLattices, dim);
+	
+	if (translatesPtr == NULL)
+		goto failure;
+	
+	// The capacity of the banks holds whatever their number
+	usage = addressSpacePtr != NULL ? lattices_capacity_analyse(stream, translatesPtr, numLattices, numBanks, addressSpacePtr) : NULL;
+	
+	if (usage != NULL)
+		lattices_capacity_filter(stream, translatesPtr, usage, numLattices, numBanks, archPtr -> bankCapacity);
+	
+	free(usage);
+	resizedPtr = realloc(mergedPtr, (*numMergedPtr + numLattices) * sizeof(isl_set **));
+	
+	if (resizedPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		lattices_free(translatesPtr, numLattices, numBanks);
+		goto failure;
+	}
+	
+	mergedPtr = resizedPtr;
+	
+	for (int i = 0; i < numLattices; i++) {
+		resizedPtr[*numMergedPtr + i] = NULL;
+		
+		if (translatesPtr[i] == NULL)
+			continue;
+		
+		resizedPtr[*numMergedPtr + i] = realloc(translatesPtr[i], maxBanks * sizeof(isl_set *));
+		
+		// The lattices already moved belong to the merged catalog, the others still to the one of the count
+		if (resizedPtr[*numMergedPtr + i] == NULL) {
+			error(stream, "Memory allocation problem :(");
+			*numMergedPtr += i;
+			lattices_free(translatesPtr, numLattices, numBanks);
+			goto failure;
+		}
+		
+		translatesPtr[i] = NULL;
+		
+		for (int j = numBanks; j < maxBanks; j++)
+			resizedPtr[*numMergedPtr + i][j] = NULL;
+	}
+	
+	*numMergedPtr += numLattices;
+	free(translatesPtr);
+	
+	return resizedPtr;
+
+failure:
+	if (mergedPtr != NULL)
+		lattices_free(mergedPtr, *numMergedPtr, maxBanks);
+	
+	*numMergedPtr = 0;
+	
+	return NULL;
+}
+
+int pareto_dominates(pareto_point * firstPtr, pareto_point * secondPtr) {
+	
+	if (firstPtr -> numBanks > secondPtr -> numBanks || firstPtr -> cost > secondPtr -> cost || firstPtr -> worstDate > secondPtr -> worstDate)
+		return 0;
+	
+	return firstPtr -> numBanks < secondPtr -> numBanks || firstPtr -> cost < secondPtr -> cost || firstPtr -> worstDate < secondPtr -> worstDate;
+}
+
+isl_stat pareto_explore(FILE * stream, phase * phasePtr, isl_ctx * optionsHdl, const architecture_config * archPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set * linearizedDatesPtr, unsigned dim, isl_set * addressSpacePtr, unsigned * bankCounts, unsigned numCounts, unsigned numWorkers) {
+	// Merged catalog of all the bank counts
+	isl_set *** translatesPtr = NULL;
+	// Number of lattices of the merged catalog
+	unsigned numLattices = 0;
+	// First lattice of each bank count in the merged catalog
+	unsigned * firstLattice = NULL;
+	// Largest number of banks
+	unsigned maxBanks = 0;
+	// Timing model of the banks
+	memory_model uniformMemory = {NULL, NULL};
+	// Array of cost function values for each lattice
+	unsigned long * cost = NULL;
+	// Secondary metrics of each lattice
+	lattice_metrics * metrics = NULL;
+	// Best lattice of each bank count
+	pareto_point * points = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_error;
+	
+	for (int k = 0; k < numCounts; k++)
+		if (bankCounts[k] > maxBanks)
+			maxBanks = bankCounts[k];
+	
+	firstLattice = malloc((numCounts + 1) * sizeof(unsigned));
+	points = calloc(numCounts, sizeof(pareto_point));
+	
+	if (firstLattice == NULL || points == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	for (int k = 0; k < numCounts; k++) {
+		firstLattice[k] = numLattices;
+		translatesPtr = catalog_append(stream, optionsHdl, archPtr, bankCounts[k], maxBanks, addressSpacePtr, translatesPtr, &numLattices, dim);
+		
+		if (translatesPtr == NULL) {
+			error(stream, "Error during parsing lattices :(");
+			goto cleanup;
+		}
+	}
+	
+	firstLattice[numCounts] = numLattices;
+	info(stream, "Lattices of all the bank counts: %d", numLattices);
+	
+	// 6) - 8) The datasets of each date are built once for all the bank counts
+	cost = malloc(numLattices * sizeof(unsigned long));
+	metrics = malloc(numLattices * sizeof(lattice_metrics));
+	
+	if (cost == NULL || metrics == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	if (numWorkers > 1)
+		outcome = cost_function_compute_sharded(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearizedDatesPtr, translatesPtr, numLattices, maxBanks, &uniformMemory, cost, metrics, numWorkers, NULL);
+	else
+		outcome = cost_function_compute(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearizedDatesPtr, translatesPtr, numLattices, maxBanks, &uniformMemory, cost, metrics, NULL, NULL);
+	
+	if (outcome == isl_stat_error) {
+		error(stream, "Error during the concurrent part");
+		goto cleanup;
+	}
+	
+	// 9) Best lattice of each bank count and Pareto front
+	new_phase(stream, phasePtr);
+	
+	for (int k = 0; k < numCounts; k++) {
+		points[k].numBanks = bankCounts[k];
+		points[k].latticeIdx = UINT_MAX;
+		points[k].cost = ULONG_MAX;
+		points[k].worstDate = ULONG_MAX;
+		
+		for (unsigned i = firstLattice[k]; i < firstLattice[k + 1]; i++)
+			if (cost[i] != ULONG_MAX && (points[k].latticeIdx == UINT_MAX || cost[i] < points[k].cost)) {
+				points[k].latticeIdx = i - firstLattice[k];
+				points[k].cost = cost[i];
+				points[k].worstDate = metrics[i].worstDate;
+			}
+	}
+	
+	complete_phase(stream, phasePtr);
+	
+	fprintf(stream, "%-6s %-10s %14s %14s %8s\n", "Banks", "Lattice", "Cost", "Worst date", "Pareto");
+	
+	for (int k = 0; k < numCounts; k++) {
+		// Whether another bank count is at least as good on every criterion and better on one
+		int dominated = 0;
+		
+		if (points[k].latticeIdx == UINT_MAX) {
+			fprintf(stream, "%-6u %-10s %14s %14s %8s\n", points[k].numBanks, "-", "-", "-", "");
+			continue;
+		}
+		
+		for (int h = 0; h < numCounts && !dominated; h++)
+			dominated = h != k && points[h].latticeIdx != UINT_MAX && pareto_dominates(&(points[h]), &(points[k]));
+		
+		fprintf(stream, "%-6u %-10u %14lu %14lu %8s\n", points[k].numBanks, points[k].latticeIdx, points[k].cost, points[k].worstDate, dominated ? "" : "*");
+	}
+	
+	fflush(stream);
+	outcome = isl_stat_ok;
+
+cleanup:
+	if (translatesPtr != NULL)
+		lattices_free(translatesPtr, numLattices, maxBanks);
+	
+	free(firstLattice);
+	free(points);
+	free(cost);
+	free(metrics);
+	
+	return outcome;
+}
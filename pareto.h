@@ -0,0 +1,23 @@
+/*
+ * Definitions of the exploration of several numbers of banks in one run. The
+ * catalogs of all the bank counts are evaluated on the same concurrent
+ * datasets, and the best lattice of each count is compared with the others
+ * on the number of banks, the cost and the conflicts of the worst date.
+ */
+
+#ifndef PARETO_H
+#define PARETO_H
+
+#include<stdio.h>
+
+#include<isl/ctx.h>
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+
+int bank_counts_parse(const char *, unsigned **);
+isl_stat pareto_explore(FILE *, phase *, isl_ctx *, const architecture_config *, manipulated_polyhedral_model **, unsigned, isl_set *, unsigned, isl_set *, unsigned *, unsigned, unsigned);
+
+#endif /* PARETO_H */
@@ -6,23 +6,23 @@
  */
 #include<stdlib.h>
 #include<string.h>
+#include<limits.h>
 
 #include "config.h"
 #include "support.h"
 #include "partitioning.h"
 
-#define DIMSTRING 100
+#define DIMSTRING 1024
 
-const char * sourceRelativePath = "../Tests/source-demos/";
 const char * sourceExtension = ".c";
-const char * scheduleRelativePath = "../Tests/polyhedral-extraction/outputs/"; 
 const char * scheduleExtension = ".isl.schedule";
-const char * latticesRelativePath = "./Lattices/";
 const char * numLatticesSuffix = "numLattices";
 const char * latticesExtension = ".txt";
 const char * latticesFormat = "%s%i_dim%i_lattice%i_translate%i%s";
+// Keywords of the directories in the architecture file, in the order of the configuration
+const char * archKeywords[] = {"sources", "schedules", "lattices"};
 
-isl_stat parse_input(FILE * stream, isl_ctx * optionsHdl, char ** tasks, pet_scop ** polyhedralModelPtr, unsigned numTasks) {
+isl_stat parse_input(FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, char ** tasks, pet_scop ** polyhedralModelPtr, unsigned numTasks) {
 	// File name with relative path
 	char * fileName;
 	// Handle to the file containing the modified schedule
@@ -30,11 +30,12 @@ isl_stat parse_input(FILE * stream, isl_ctx * optionsHdl, char ** tasks, pet_sco
 	
 	for (int i = 0; i < numTasks; i++) {
 		fileName = malloc(DIMSTRING * sizeof(char));
-		fileName[0] = '\0';
 		
-		strcat(fileName, sourceRelativePath);
-		strcat(fileName, tasks[i]);
-		strcat(fileName, sourceExtension);
+		if (fileName == NULL || snprintf(fileName, DIMSTRING, "%s%s%s", archPtr -> sourcePath, tasks[i], sourceExtension) >= DIMSTRING) {
+			error(stream, "Problem when building the name of the source file");
+			free(fileName);
+			return isl_stat_error;
+		}
 		
 #ifdef VERBOSE
 		fprintf(stream, "Parsing file %s\n", fileName);
@@ -57,11 +58,12 @@ isl_stat parse_input(FILE * stream, isl_ctx * optionsHdl, char ** tasks, pet_sco
 		free(fileName);
 		
 		fileName = malloc(DIMSTRING * sizeof(char));
-		fileName[0] = '\0';
 		
-		strcat(fileName, scheduleRelativePath);
-		strcat(fileName, tasks[i]);
-		strcat(fileName, scheduleExtension);
+		if (fileName == NULL || snprintf(fileName, DIMSTRING, "%s%s%s", archPtr -> schedulePath, tasks[i], scheduleExtension) >= DIMSTRING) {
+			error(stream, "Problem when building the name of the schedule file");
+			free(fileName);
+			return isl_stat_error;
+		}
 		
 #ifdef VERBOSE
 		fprintf(stream, "Reading file %s\n", fileName);
@@ -73,6 +75,7 @@ isl_stat parse_input(FILE * stream, isl_ctx * optionsHdl, char ** tasks, pet_sco
 			return isl_stat_error;
 		}
 		
+		isl_schedule_free(polyhedralModelPtr[i] -> schedule);
 		polyhedralModelPtr[i] -> schedule = isl_schedule_read_from_file(optionsHdl, filePtr);
 		
 #ifdef MOREVERBOSE
@@ -89,7 +92,7 @@ isl_stat parse_input(FILE * stream, isl_ctx * optionsHdl, char ** tasks, pet_sco
 	return isl_stat_ok;
 }
 
-isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, unsigned * numLatticesPtr, unsigned dim) {
+isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, unsigned * numLatticesPtr, unsigned dim) {
 	// Array of the lattices
 	isl_set *** translatesPtr = NULL;
 	// Handle to the file containing a lattice
@@ -109,7 +112,7 @@ isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, unsigned * numL
 		return NULL;
 	}
 	
-	if (sprintf(latticeFileName, "%s%i_dim%i_%s%s", latticesRelativePath, NUMBANKS, dim, numLatticesSuffix, latticesExtension) < 0) {
+	if (snprintf(latticeFileName, DIMSTRING, "%s%i_dim%i_%s%s", archPtr -> latticesPath, archPtr -> numBanks, dim, numLatticesSuffix, latticesExtension) >= DIMSTRING) {
 		error(stream, "Problem when building the name of the file containing the number of lattices");
 		return NULL;
 	}
@@ -144,7 +147,7 @@ isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, unsigned * numL
 	
 	// Now we read all the translates for all the lattices
 	for (int i = 1; i <= *numLatticesPtr; i++) {
-		translatesPtr[i-1] = malloc (NUMBANKS * sizeof(isl_set *));
+		translatesPtr[i-1] = malloc (archPtr -> numBanks * sizeof(isl_set *));
 		
 		
 		if (translatesPtr[i-1] == NULL) {
@@ -152,7 +155,7 @@ isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, unsigned * numL
 			return NULL;
 		}
 		
-		for (int j = 1; j <= NUMBANKS; j++) {
+		for (int j = 1; j <= archPtr -> numBanks; j++) {
 			latticeFileName = malloc (DIMSTRING * sizeof(char));
 			
 			if (latticeFileName == NULL) {
@@ -160,8 +163,8 @@ isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, unsigned * numL
 				return NULL;
 			}
 			
-			if (sprintf(latticeFileName, latticesFormat, 
-				latticesRelativePath, NUMBANKS,dim,  i, j, latticesExtension) < 0) {
+			if (snprintf(latticeFileName, DIMSTRING, latticesFormat, 
+				archPtr -> latticesPath, archPtr -> numBanks, dim,  i, j, latticesExtension) >= DIMSTRING) {
 				error(stream, "Problem when building the name of the file containing the number of lattices");
 				return NULL;
 			}
@@ -199,6 +202,7 @@ isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, unsigned * numL
 			
 			fprintf(stream, "\n");
 			fflush(stream);
+			isl_printer_free(printer);
 #endif
 			
 			fclose(latticeHdl);
@@ -206,10 +210,407 @@ isl_set *** parse_lattices (FILE * stream, isl_ctx * optionsHdl, unsigned * numL
 		}
 		
 	}
-#ifdef MOREVERBOSE
-	isl_printer_free(printer);
-#endif
+	
 	return translatesPtr;
 }
 
+void lattices_free (isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks) {
+	for (int i = 0; i < numLattices; i++) {
+		// The lattices rejected by the capacity analysis are already released
+		if (translatesPtr[i] == NULL)
+			continue;
+		
+		for (int j = 0; j < numBanks; j++)
+			isl_set_free(translatesPtr[i][j]);
+		
+		free(translatesPtr[i]);
+	}
+	
+	free(translatesPtr);
+}
+
+// The lattice is dropped from the search, but keeps its index in the catalog
+void lattice_reject (isl_set *** translatesPtr, unsigned latticeIdx, unsigned numBanks) {
+	
+	for (int j = 0; j < numBanks; j++)
+		isl_set_free(translatesPtr[latticeIdx][j]);
+	
+	free(translatesPtr[latticeIdx]);
+	translatesPtr[latticeIdx] = NULL;
+}
 
+architecture_config * parse_architecture (FILE * stream, const char * fileName) {
+	// Configuration under building
+	architecture_config * archPtr = NULL;
+	// Handle to the file of the configuration
+	FILE * archHdl = NULL;
+	// Line currently read
+	char line[DIMSTRING];
+	// Keyword of the current line
+	char keyword[DIMSTRING];
+	// Value of the current line, for the keywords with a single value
+	char value[DIMSTRING];
+	// Number of processors of each task
+	unsigned * processors = NULL;
+	// Number of parameters of each task
+	unsigned * numParams = NULL;
+	// Values of the parameters of each task
+	unsigned ** params = NULL;
+	// Number of tasks configured
+	unsigned numTasks = 0;
+	// Number of banks
+	unsigned numBanks = defaultArchitecture.numBanks;
+	// Words of each bank
+	unsigned long bankCapacity = defaultArchitecture.bankCapacity;
+	// Number of clusters of banks and weight of their conflicts
+	unsigned numClusters = defaultArchitecture.numClusters;
+	unsigned clusterWeight = defaultArchitecture.clusterWeight;
+	// Directories of the inputs
+	const char * paths[3] = {defaultArchitecture.sourcePath, defaultArchitecture.schedulePath, defaultArchitecture.latticesPath};
+	// Owned copies of the directories given in the file
+	char * ownedPaths[3] = {NULL, NULL, NULL};
+	// Position in the current line
+	int position = 0;
+	// Characters consumed by the last conversion
+	int consumed = 0;
+	// Value of a parameter
+	unsigned parameter = 0;
+	// Latencies of the processors, a row per latency line
+	unsigned * cycles = NULL;
+	// Number of latency lines
+	unsigned numRows = 0;
+	// Number of latencies read
+	unsigned numCycles = 0;
+	// Latency matrix of the configuration
+	bank_latency * latencyPtr = NULL;
+	// Port lines, four values each: read, write and shared ports, then the bank or all of them
+	unsigned * portLines = NULL;
+	// Number of port lines
+	unsigned numPortLines = 0;
+	// Ports of each bank
+	bank_ports * ports = NULL;
+	// Block returned by the last reallocation, the previous one being released on failure
+	void * resizedPtr = NULL;
+	
+	archHdl = fopen(fileName, "r");
+	
+	if (archHdl == NULL) {
+		error(stream, "File not found");
+		return NULL;
+	}
+	
+	while (fgets(line, DIMSTRING, archHdl) != NULL) {
+		// Empty lines and comments
+		if (sscanf(line, "%s%n", keyword, &position) != 1 || keyword[0] == '#')
+			continue;
+		
+		if (strcmp(keyword, "task") == 0) {
+			resizedPtr = realloc(processors, (numTasks + 1) * sizeof(unsigned));
+			
+			if (resizedPtr == NULL) {
+				error(stream, "Memory allocation problem :(");
+				goto failure;
+			}
+			
+			processors = resizedPtr;
+			resizedPtr = realloc(numParams, (numTasks + 1) * sizeof(unsigned));
+			
+			if (resizedPtr == NULL) {
+				error(stream, "Memory allocation problem :(");
+				goto failure;
+			}
+			
+			numParams = resizedPtr;
+			resizedPtr = realloc(params, (numTasks + 1) * sizeof(unsigned *));
+			
+			if (resizedPtr == NULL) {
+				error(stream, "Memory allocation problem :(");
+				goto failure;
+			}
+			
+			params = resizedPtr;
+			numParams[numTasks] = 0;
+			params[numTasks] = NULL;
+			numTasks++;
+			
+			if (sscanf(line + position, "%u%n", &(processors[numTasks - 1]), &consumed) != 1 || processors[numTasks - 1] == 0) {
+				error(stream, "A task needs a positive number of processors");
+				goto failure;
+			}
+			
+			position += consumed;
+			
+			while (sscanf(line + position, "%u%n", &parameter, &consumed) == 1) {
+				resizedPtr = realloc(params[numTasks - 1], (numParams[numTasks - 1] + 1) * sizeof(unsigned));
+				
+				if (resizedPtr == NULL) {
+					error(stream, "Memory allocation problem :(");
+					goto failure;
+				}
+				
+				params[numTasks - 1] = resizedPtr;
+				params[numTasks - 1][numParams[numTasks - 1]++] = parameter;
+				position += consumed;
+			}
+			
+			continue;
+		}
+		
+		if (strcmp(keyword, "banks") == 0) {
+			if (sscanf(line + position, "%u", &numBanks) != 1 || numBanks == 0) {
+				error(stream, "The number of banks must be positive");
+				goto failure;
+			}
+			
+			continue;
+		}
+		
+		if (strcmp(keyword, "capacity") == 0) {
+			if (sscanf(line + position, "%lu", &bankCapacity) != 1 || bankCapacity == 0) {
+				error(stream, "The capacity of the banks must be positive");
+				goto failure;
+			}
+			
+			continue;
+		}
+		
+		if (strcmp(keyword, "clusters") == 0) {
+			if (sscanf(line + position, "%u%n", &numClusters, &consumed) != 1 || numClusters < 2) {
+				error(stream, "There must be at least two clusters");
+				goto failure;
+			}
+			
+			if (sscanf(line + position + consumed, "%u", &clusterWeight) != 1)
+				clusterWeight = 1;
+			
+			continue;
+		}
+		
+		if (strcmp(keyword, "ports") == 0) {
+			resizedPtr = realloc(portLines, (numPortLines + 1) * 4 * sizeof(unsigned));
+			
+			if (resizedPtr == NULL) {
+				error(stream, "Memory allocation problem :(");
+				goto failure;
+			}
+			
+			portLines = resizedPtr;
+			
+			if (sscanf(line + position, "%u %u %u%n", &(portLines[4 * numPortLines]), &(portLines[4 * numPortLines + 1]), &(portLines[4 * numPortLines + 2]), &consumed) != 3) {
+				error(stream, "A ports line needs the read, write and shared ports");
+				goto failure;
+			}
+			
+			// Without a bank the line is about all of them
+			if (sscanf(line + position + consumed, "%u", &(portLines[4 * numPortLines + 3])) != 1)
+				portLines[4 * numPortLines + 3] = UINT_MAX;
+			
+			numPortLines++;
+			continue;
+		}
+		
+		if (strcmp(keyword, "latency") == 0) {
+			numRows++;
+			
+			while (sscanf(line + position, "%u%n", &parameter, &consumed) == 1) {
+				resizedPtr = realloc(cycles, (numCycles + 1) * sizeof(unsigned));
+				
+				if (resizedPtr == NULL) {
+					error(stream, "Memory allocation problem :(");
+					goto failure;
+				}
+				
+				cycles = resizedPtr;
+				cycles[numCycles++] = parameter;
+				position += consumed;
+			}
+			
+			continue;
+		}
+		
+		for (int i = 0; i < 3; i++) {
+			if (strcmp(keyword, archKeywords[i]) != 0)
+				continue;
+			
+			if (sscanf(line + position, "%s", value) != 1) {
+				error(stream, "Missing directory in the architecture file");
+				goto failure;
+			}
+			
+			free(ownedPaths[i]);
+			ownedPaths[i] = strdup(value);
+			
+			if (ownedPaths[i] == NULL) {
+				error(stream, "Memory allocation problem :(");
+				goto failure;
+			}
+			
+			paths[i] = ownedPaths[i];
+			keyword[0] = '\0';
+		}
+		
+		if (keyword[0] != '\0') {
+			error(stream, "Unknown keyword in the architecture file");
+			goto failure;
+		}
+	}
+	
+	fclose(archHdl);
+	archHdl = NULL;
+	
+	// Every processor needs the latency of every bank
+	if (numRows > 0) {
+		if (numCycles != numRows * numBanks) {
+			error(stream, "A latency line needs a latency for each bank");
+			goto failure;
+		}
+		
+		latencyPtr = malloc(sizeof(bank_latency));
+		
+		if (latencyPtr == NULL) {
+			error(stream, "Memory allocation problem :(");
+			goto failure;
+		}
+		
+		latencyPtr -> numProcessors = numRows;
+		latencyPtr -> numBanks = numBanks;
+		latencyPtr -> cycles = cycles;
+	}
+	
+	// Every cluster holds the same number of banks, at least two
+	if (numClusters > 0 && (numBanks % numClusters != 0 || numBanks == numClusters)) {
+		error(stream, "The banks cannot be split evenly in the clusters");
+		goto failure;
+	}
+	
+	// The lines apply in order, the banks without any keeping a single shared port
+	if (numPortLines > 0) {
+		if (numRows > 0) {
+			error(stream, "The latencies and the ports of the banks cannot be combined");
+			goto failure;
+		}
+		
+		ports = malloc(numBanks * sizeof(bank_ports));
+		
+		if (ports == NULL) {
+			error(stream, "Memory allocation problem :(");
+			goto failure;
+		}
+		
+		for (int j = 0; j < numBanks; j++) {
+			ports[j].read = 0;
+			ports[j].write = 0;
+			ports[j].shared = 1;
+		}
+		
+		for (int i = 0; i < numPortLines; i++)
+			for (int j = 0; j < numBanks; j++)
+				if (portLines[4 * i + 3] == UINT_MAX || portLines[4 * i + 3] == j) {
+					ports[j].read = portLines[4 * i];
+					ports[j].write = portLines[4 * i + 1];
+					ports[j].shared = portLines[4 * i + 2];
+				}
+		
+		for (int i = 0; i < numPortLines; i++)
+			if (portLines[4 * i + 3] != UINT_MAX && portLines[4 * i + 3] >= numBanks) {
+				error(stream, "A ports line refers to a bank which does not exist");
+				goto failure;
+			}
+		
+		for (int j = 0; j < numBanks; j++)
+			if (ports[j].read + ports[j].shared == 0 || ports[j].write + ports[j].shared == 0) {
+				error(stream, "Every bank needs a port for the reads and one for the writes");
+				goto failure;
+			}
+		
+		free(portLines);
+		portLines = NULL;
+	}
+	
+	archPtr = malloc(sizeof(architecture_config));
+	
+	if (archPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto failure;
+	}
+	
+	// The directories are always owned, so that the configuration can be released uniformly
+	for (int i = 0; i < 3; i++)
+		if (ownedPaths[i] == NULL && (ownedPaths[i] = strdup(paths[i])) == NULL) {
+			error(stream, "Memory allocation problem :(");
+			goto failure;
+		}
+	
+	// Without any task the tasks of the default configuration are kept
+	if (numTasks == 0) {
+		archPtr -> maxTasks = defaultArchitecture.maxTasks;
+		archPtr -> N = defaultArchitecture.N;
+		archPtr -> numParams = defaultArchitecture.numParams;
+		archPtr -> params = defaultArchitecture.params;
+	} else {
+		archPtr -> maxTasks = numTasks;
+		archPtr -> N = processors;
+		archPtr -> numParams = numParams;
+		archPtr -> params = (const unsigned * const *)params;
+	}
+	
+	archPtr -> numBanks = numBanks;
+	archPtr -> bankCapacity = bankCapacity;
+	archPtr -> memory.latency = latencyPtr;
+	archPtr -> memory.ports = ports;
+	archPtr -> numClusters = numClusters;
+	archPtr -> clusterWeight = clusterWeight;
+	archPtr -> sourcePath = ownedPaths[0];
+	archPtr -> schedulePath = ownedPaths[1];
+	archPtr -> latticesPath = ownedPaths[2];
+	
+	return archPtr;
+	
+failure:
+	if (archHdl != NULL)
+		fclose(archHdl);
+	
+	for (int i = 0; i < numTasks && params != NULL; i++)
+		free(params[i]);
+	
+	for (int i = 0; i < 3; i++)
+		free(ownedPaths[i]);
+	
+	free(processors);
+	free(numParams);
+	free(params);
+	free(cycles);
+	free(latencyPtr);
+	free(portLines);
+	free(ports);
+	free(archPtr);
+	
+	return NULL;
+}
+
+void architecture_free (architecture_config * archPtr) {
+	
+	if (archPtr == NULL || archPtr == &defaultArchitecture)
+		return;
+	
+	if (archPtr -> N != defaultArchitecture.N) {
+		for (int i = 0; i < archPtr -> maxTasks; i++)
+			free((unsigned *)archPtr -> params[i]);
+		
+		free((unsigned *)archPtr -> N);
+		free((unsigned *)archPtr -> numParams);
+		free((unsigned **)archPtr -> params);
+	}
+	
+	if (archPtr -> memory.latency != NULL) {
+		free((unsigned *)archPtr -> memory.latency -> cycles);
+		free((bank_latency *)archPtr -> memory.latency);
+	}
+	
+	free((bank_ports *)archPtr -> memory.ports);
+	
+	free((char *)archPtr -> sourcePath);
+	free((char *)archPtr -> schedulePath);
+	free((char *)archPtr -> latticesPath);
+	free(archPtr);
+}
@@ -9,16 +9,41 @@
 #include<pet.h>
 #include<isl/ctx.h>
 
+#include "config.h"
 #include "model.h"
+#include "support.h"
+#include "arena.h"
+#include "checkpoint.h"
+#include "export.h"
+#include "ranking.h"
 
-isl_stat parse_input(FILE *, isl_ctx *, char**,  pet_scop **, unsigned);
-isl_stat virtual_allocation (FILE *, isl_ctx *, pet_scop **, manipulated_polyhedral_model **, unsigned, unsigned *);
-isl_set *** parse_lattices (FILE *, isl_ctx *, unsigned *, unsigned); 
-isl_stat physical_schedule (FILE *, isl_ctx *, pet_scop **, manipulated_polyhedral_model **, unsigned);
-isl_stat eliminate_parameters (FILE *, pet_scop **, manipulated_polyhedral_model **, unsigned);
+extern const placement_policy defaultPlacement;
+
+isl_stat parse_input(FILE *, isl_ctx *, const architecture_config *, char**,  pet_scop **, unsigned);
+isl_stat virtual_allocation (FILE *, isl_ctx *, pet_scop **, manipulated_polyhedral_model **, unsigned, unsigned *, const placement_policy *);
+isl_set *** parse_lattices (FILE *, isl_ctx *, const architecture_config *, unsigned *, unsigned); 
+void lattices_free (isl_set ***, unsigned, unsigned);
+void lattice_reject (isl_set ***, unsigned, unsigned);
+architecture_config * parse_architecture (FILE *, const char *);
+void architecture_free (architecture_config *);
+isl_stat physical_schedule (FILE *, isl_ctx *, const architecture_config *, pet_scop **, manipulated_polyhedral_model **, unsigned);
+isl_stat eliminate_parameters (FILE *, const architecture_config *, pet_scop **, manipulated_polyhedral_model **, unsigned);
+isl_stat eliminate_parameters_accesses (FILE *, const architecture_config *, manipulated_polyhedral_model **, unsigned);
 isl_stat linearize_dates (FILE *, manipulated_polyhedral_model **, unsigned);
 isl_union_set * polyhedral_slice_build (FILE *, isl_union_map *, isl_union_map *, isl_point *);
-isl_set * concurrent_dataset_build (FILE *, manipulated_polyhedral_model **, isl_union_set **, unsigned);
-isl_stat evaluate_fundamental_lattice(FILE *, isl_set *, isl_set **, unsigned long *);
+isl_set * concurrent_dataset_build (FILE *, manipulated_polyhedral_model **, isl_union_set **, unsigned, scratch_arena *);
+isl_stat evaluate_fundamental_lattice(FILE *, isl_set *, isl_set **, unsigned, unsigned long *, unsigned long *, unsigned long *);
+isl_set ** processor_datasets_build (FILE *, manipulated_polyhedral_model **, isl_union_set **, unsigned, unsigned, scratch_arena *);
+isl_stat evaluate_fundamental_lattice_numa(FILE *, isl_set **, const bank_latency *, isl_set **, unsigned long *, unsigned long *, unsigned long *);
+isl_stat access_datasets_build (FILE *, manipulated_polyhedral_model **, isl_union_set **, unsigned, isl_set *, isl_set **, isl_set **);
+isl_stat accesses_merge (FILE *, manipulated_polyhedral_model **, unsigned, unsigned, unsigned);
+isl_stat tagged_datasets_build (FILE *, manipulated_polyhedral_model **, isl_union_set **, unsigned, isl_set **, isl_set **);
+isl_stat evaluate_fundamental_lattice_ports(FILE *, isl_set *, isl_set *, isl_set **, unsigned, const bank_ports *, unsigned long *, unsigned long *, unsigned long *);
+void dataset_array_free(isl_set **, unsigned);
+isl_set * linearized_dates_union (FILE *, manipulated_polyhedral_model **, unsigned);
+isl_stat cost_function_compute (FILE *, phase *, manipulated_polyhedral_model **, unsigned, isl_set *, isl_set ***, unsigned, unsigned, const memory_model *, unsigned long *, lattice_metrics *, checkpoint *, result_export *);
+isl_set * shard_dates(isl_set *, long, long);
+isl_stat cost_function_compute_sharded (FILE *, phase *, manipulated_polyhedral_model **, unsigned, isl_set *, isl_set ***, unsigned, unsigned, const memory_model *, unsigned long *, lattice_metrics *, unsigned, result_export *);
+unsigned best_lattice (FILE *, unsigned long *, unsigned, unsigned long *);
 
 #endif /* PARTITIONING_H_ */
@@ -0,0 +1,450 @@
+#ifdef MOREVERBOSE
+#define VERBOSE
+#endif
+/*
+ * Implementation of the functions chaining the building functions of the
+ * lattice - based memory partitioning technique, shared by the command - line
+ * and the server front - ends
+ */
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+
+#include<isl/set.h>
+#include<isl/union_set.h>
+#include<isl/union_map.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+#include "partitioning.h"
+#include "profiling.h"
+#include "counting.h"
+#include "anytime.h"
+
+// Number of phases performed for each one of the linearized dates
+const unsigned parallel_phases = 3;
+
+// Seconds between two progress lines
+#define PROGRESSINTERVAL 2.0
+// Initial size of the scratch arena of the per - date temporaries
+#define ARENASIZE 4096
+
+typedef struct {
+	phase * phasePtr;
+	FILE * stream;
+	unsigned numTasks;
+	manipulated_polyhedral_model ** modifiedPolyhedralModelPtr;
+	isl_set *** translatesPtr;
+	unsigned long * cost;
+	lattice_metrics * metrics;
+	unsigned numLattices;
+	unsigned numBanks;
+	const memory_model * memoryPtr;
+	scratch_arena * arenaPtr;
+	checkpoint * checkpointPtr;
+	result_export * exportPtr;
+} concurrent_part_params;
+
+isl_stat concurrent_part(isl_point *, void *);
+isl_stat date_count(isl_point *, void *);
+
+isl_set * linearized_dates_union (FILE * stream, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks) {
+#ifdef VERBOSE
+	// Pointer to the printer
+	isl_printer * printer = NULL;
+#endif
+	// Set of all the linearized dates across the concurrent tasks
+	isl_set * linearizedDatesPtr = NULL;
+	
+	linearizedDatesPtr = isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[0] -> linearizedSchedule)));
+	
+	if (linearizedDatesPtr == NULL)
+		return NULL;
+	
+	for (int i = 1; i < numTasks; i++)
+		linearizedDatesPtr = isl_set_union(linearizedDatesPtr, isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> linearizedSchedule))));
+	
+	PROFILE_SET(PROFILE_DATES_COALESCE, linearizedDatesPtr);
+	PROFILE_TIMED(PROFILE_DATES_COALESCE, linearizedDatesPtr = isl_set_coalesce(linearizedDatesPtr));
+	
+	if (linearizedDatesPtr == NULL)
+		return NULL;
+
+#ifdef VERBOSE
+	fprintf(stream, "Unified linearized schedule space:\n");
+	fflush(stream);
+	printer = isl_printer_to_file(isl_set_get_ctx(linearizedDatesPtr), stream);
+	
+	if(printer == NULL) {
+		error(stream, "Memory allocation problem :(");
+		isl_set_free(linearizedDatesPtr);
+		return NULL;
+	}
+	
+	printer = isl_printer_print_set(printer, linearizedDatesPtr);
+	
+	if(printer == NULL) {
+		error(stream, "Printing problem :(");
+		isl_set_free(linearizedDatesPtr);
+		return NULL;
+	}
+	
+	fprintf(stream, "\n");
+	
+	isl_printer_free(printer);
+#endif
+	
+	return linearizedDatesPtr;
+}
+
+isl_stat cost_function_compute (FILE * stream, phase * phasePtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set * linearizedDatesPtr, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, const memory_model * memoryPtr, unsigned long * cost, lattice_metrics * metrics, checkpoint * checkpointPtr, result_export * exportPtr) {
+	// Parameters for the callback function
+	concurrent_part_params * params = NULL;
+	// Dates still to be evaluated
+	isl_set * remainingDatesPtr = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	params = malloc(sizeof(concurrent_part_params));
+	
+	if (params == NULL) {
+		error(stream, "Memory allocation problem for the parameters of the concurrent part:(");
+		return isl_stat_error;
+	}
+	
+	params -> phasePtr = phasePtr;
+	params -> stream = stream;
+	params -> numTasks = numTasks;
+	params -> modifiedPolyhedralModelPtr = modifiedPolyhedralModelPtr;
+	params -> translatesPtr = translatesPtr;
+	params -> numLattices = numLattices;
+	params -> numBanks = numBanks;
+	params -> memoryPtr = memoryPtr;
+	params -> cost = cost;
+	params -> metrics = metrics;
+	params -> arenaPtr = arena_alloc(ARENASIZE);
+	params -> checkpointPtr = checkpointPtr;
+	params -> exportPtr = exportPtr;
+	
+	if (params -> arenaPtr == NULL) {
+		error(stream, "Memory allocation problem for the scratch arena :(");
+		free(params);
+		return isl_stat_error;
+	}
+	
+	// A rejected lattice can never be the best one
+	for (int i = 0; i < numLattices; i++)
+		params -> cost[i] = translatesPtr[i] != NULL ? 0 : ULONG_MAX;
+	
+	if (metrics != NULL)
+		memset(metrics, 0, numLattices * sizeof(lattice_metrics));
+	
+	// A resumed run starts from the costs of the checkpoint and skips its dates
+	if (checkpointPtr != NULL)
+		remainingDatesPtr = checkpoint_resume(stream, checkpointPtr, linearizedDatesPtr, modifiedPolyhedralModelPtr, cost, metrics, numLattices, phasePtr -> statsPtr);
+	else
+		remainingDatesPtr = isl_set_copy(linearizedDatesPtr);
+	
+	// The lattices rejected since the checkpoint was written stay rejected
+	for (int i = 0; i < numLattices; i++)
+		if (translatesPtr[i] == NULL)
+			params -> cost[i] = ULONG_MAX;
+	
+	if (remainingDatesPtr == NULL) {
+		arena_free(params -> arenaPtr);
+		free(params);
+		return isl_stat_error;
+	}
+	
+	if (phasePtr -> progressPtr != NULL) {
+		// The total number of dates is needed for the estimated time of arrival
+		unsigned long numDates = 0;
+		
+		isl_set_foreach_point(remainingDatesPtr, date_count, &numDates);
+		progress_begin(phasePtr -> progressPtr, numDates, PROGRESSINTERVAL);
+	}
+	
+	// This part must be iterated for each one of the linearized dates
+	outcome = isl_set_foreach_point(remainingDatesPtr, concurrent_part, (void *)params);
+	
+	phasePtr -> phase_num += parallel_phases;
+	
+	if (phasePtr -> progressPtr != NULL)
+		progress_end(stream, phasePtr -> progressPtr);
+	
+	// Be clean
+	isl_set_free(remainingDatesPtr);
+	arena_free(params -> arenaPtr);
+	free(params);
+	
+	return outcome;
+}
+
+unsigned best_lattice (FILE * stream, unsigned long * cost, unsigned numLattices, unsigned long * bestCostPtr) {
+	// Index of the best fundamental lattice
+	unsigned bestLatticeIdx = 0;
+
+#ifdef VERBOSE
+	fprintf(stream, "F. lattice #\t Cost function value\n");
+	
+	for (int i = 0; i < numLattices; i++)
+		fprintf(stream, "%u) \t\t %lu\n", i, cost[i]);
+	
+	fflush(stream);
+#endif
+	
+	*bestCostPtr = cost[0];
+
+#ifdef MOREVERBOSE
+	fprintf(stream, "Cost function value for the fundamental lattice %u: \t %lu\n", 0, cost[0]);
+	fflush(stream);
+#endif
+	
+	for (int i = 1; i < numLattices; i++)
+		if (cost[i] < *bestCostPtr) {
+			*bestCostPtr = cost[i];
+			bestLatticeIdx = i;
+
+#ifdef MOREVERBOSE
+			fprintf(stream, "Cost function value for the fundamental lattice %u: \t %lu\n", i, cost[i]);
+			fflush(stream);
+#endif
+		}
+	
+	return bestLatticeIdx;
+}
+
+isl_stat concurrent_part(isl_point * pointPtr, void * user) {
+	// Pointer to the input parameters
+	concurrent_part_params * params = (concurrent_part_params *)user;
+	// Pointer to the printer
+	isl_printer * printer = NULL;
+	// Pointer to the phase of the current point
+	phase phasePoint = *params -> phasePtr;
+	// Pointer to the array of the polyhedral slices
+	isl_union_set ** polyhedralSlicePtr = NULL;
+	// Pointer to the concurrent dataset
+	isl_set * concurrentDatasetPtr = NULL;
+	// Array of the datasets of each processor, for the non - uniform model
+	isl_set ** processorDatasetPtr = NULL;
+	// Pointers to the addresses read and to the addresses written, for the port - aware model
+	isl_set * readDatasetPtr = NULL;
+	isl_set * writeDatasetPtr = NULL;
+	// Coordinate of the linearized date
+	isl_val * dateVal = NULL;
+	// Record of the date for the export: date, size of the dataset and load of each lattice
+	unsigned long * record = NULL;
+	// Conflicts of the date under the current lattice
+	unsigned long dateCost = 0;
+	// Load of the least loaded bank of the date under the current lattice
+	unsigned long minLoad = 0;
+	// Result of the evaluation of a lattice
+	isl_stat evaluation = isl_stat_ok;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_error;
+	
+	// An anytime search stops at the first date past its budget
+	if (anytime_expired()) {
+		isl_point_free(pointPtr);
+		return isl_stat_error;
+	}
+	
+	params -> phasePtr -> statsPtr -> dates += 1;
+	
+	// In the quiet modes the banners of each date are not printed
+	phasePoint.quiet = params -> phasePtr -> quietDates;
+	
+	if (phasePoint.quiet == 0) {
+		dateVal = isl_point_get_coordinate_val(pointPtr, isl_dim_set, 0);
+		info (params -> stream, "Linearized date: %d", isl_val_get_num_si(dateVal));
+		isl_val_free(dateVal);
+	}
+	
+	printer = isl_printer_to_file(isl_point_get_ctx(pointPtr), params -> stream);
+	
+	// 6) Polyhedral slices building
+	new_phase(params -> stream, &(phasePoint));
+	
+	// Zeroed, so that the slices built until an error can be released
+	polyhedralSlicePtr = arena_calloc (params -> arenaPtr, params -> numTasks, sizeof(isl_union_set *));
+	
+	if (polyhedralSlicePtr == NULL) {
+		error(params -> stream, "Memory allocation problem for the polyhedral slices");
+		goto cleanup;
+	}
+	
+	for (int i = 0; i < params -> numTasks; i++) {
+
+#ifdef MOREVERBOSE
+		info(params -> stream, "Task %d)", i);
+#endif
+		
+		polyhedralSlicePtr[i] = polyhedral_slice_build (params -> stream, isl_union_map_copy(params -> modifiedPolyhedralModelPtr[i] -> flattenedSchedule), isl_union_map_copy(params -> modifiedPolyhedralModelPtr[i] -> linearizedSchedule), pointPtr);
+		
+		if (polyhedralSlicePtr[i] == NULL) {
+			error(params -> stream, "Error during polyhedral slices building");
+			goto cleanup;
+		}
+
+#ifdef MOREVERBOSE
+		printer = isl_printer_set_indent(printer, moreIndent);
+		fprintf(params -> stream, "Polyhedral slice of task %d:\n", i);
+		printer = isl_printer_print_union_set(printer, polyhedralSlicePtr[i]);
+		
+		if(printer == NULL) {
+			error(params -> stream, "Printing problem :(");
+			goto cleanup;
+		}
+		
+		fprintf(params -> stream, "\n");
+		fflush(params -> stream);
+#endif
+	}
+	
+	complete_phase(params -> stream, &(phasePoint));
+	
+	// 7) Concurrent dataset building
+	new_phase(params -> stream, &(phasePoint));
+	
+	// With tagged accesses the addresses read and written give the concurrent dataset, from a single application per task
+	if (params -> memoryPtr -> ports != NULL && params -> modifiedPolyhedralModelPtr[0] -> taggedAccesses != NULL) {
+		if (tagged_datasets_build(params -> stream, params -> modifiedPolyhedralModelPtr, polyhedralSlicePtr, params -> numTasks, &readDatasetPtr, &writeDatasetPtr) == isl_stat_error)
+			goto cleanup;
+		
+		concurrentDatasetPtr = isl_set_coalesce(isl_set_union(isl_set_copy(readDatasetPtr), isl_set_copy(writeDatasetPtr)));
+	} else
+		concurrentDatasetPtr = concurrent_dataset_build(params -> stream, params -> modifiedPolyhedralModelPtr, polyhedralSlicePtr, params -> numTasks, params -> arenaPtr);
+	
+	if (concurrentDatasetPtr == NULL) {
+		error(params -> stream, "Error during concurrent dataset building");
+		goto cleanup;
+	}
+	
+	// The non - uniform model needs to know which processor accesses each address
+	if (params -> memoryPtr -> latency != NULL) {
+		processorDatasetPtr = processor_datasets_build(params -> stream, params -> modifiedPolyhedralModelPtr, polyhedralSlicePtr, params -> numTasks, params -> memoryPtr -> latency -> numProcessors, params -> arenaPtr);
+		
+		if (processorDatasetPtr == NULL)
+			goto cleanup;
+	} else if (params -> memoryPtr -> ports != NULL && readDatasetPtr == NULL && access_datasets_build(params -> stream, params -> modifiedPolyhedralModelPtr, polyhedralSlicePtr, params -> numTasks, concurrentDatasetPtr, &readDatasetPtr, &writeDatasetPtr) == isl_stat_error)
+		goto cleanup;
+
+#ifdef VERBOSE
+	fprintf(params -> stream, "Concurrent dataset:\n");
+	printer = isl_printer_print_set(printer, concurrentDatasetPtr);
+	
+	if(printer == NULL) {
+		error(params -> stream, "Printing problem :(");
+		goto cleanup;
+	}
+	
+	fprintf(params -> stream, "\n");
+	fflush(params -> stream);
+#endif
+	
+	complete_phase(params -> stream, &(phasePoint));
+	
+	if (params -> exportPtr != NULL) {
+		record = arena_get(params -> arenaPtr, (2 + params -> numLattices) * sizeof(unsigned long));
+		dateVal = isl_point_get_coordinate_val(pointPtr, isl_dim_set, 0);
+		
+		if (record == NULL || dateVal == NULL || set_count(concurrentDatasetPtr, &(record[1])) == isl_stat_error) {
+			error(params -> stream, "Error during the record of the date");
+			isl_val_free(dateVal);
+			goto cleanup;
+		}
+		
+		record[0] = isl_val_get_num_si(dateVal);
+		isl_val_free(dateVal);
+	}
+	
+	// 8) Cost function computation for the current date
+	new_phase(params -> stream, &(phasePoint));
+	
+	for (int i = 0; i < params -> numLattices; i++) {
+#ifdef VERBOSE
+		info(params -> stream, "Fundamental lattice %u)", i);
+#endif
+		
+		if (params -> translatesPtr[i] == NULL) {
+			if (record != NULL)
+				record[2 + i] = 0;
+			
+			continue;
+		}
+		
+		// The conflicts of the date are what the lattice adds to its cost
+		dateCost = params -> cost[i];
+		
+		// The non - uniform model charges the memory latency and the port - aware one the cycles, rather than the conflicts
+		if (params -> memoryPtr -> latency != NULL)
+			evaluation = evaluate_fundamental_lattice_numa(params -> stream, processorDatasetPtr, params -> memoryPtr -> latency, params -> translatesPtr[i], &(params -> cost[i]), &minLoad, &(params -> phasePtr -> statsPtr -> points));
+		else if (params -> memoryPtr -> ports != NULL)
+			evaluation = evaluate_fundamental_lattice_ports(params -> stream, readDatasetPtr, writeDatasetPtr, params -> translatesPtr[i], params -> numBanks, params -> memoryPtr -> ports, &(params -> cost[i]), &minLoad, &(params -> phasePtr -> statsPtr -> points));
+		else
+			evaluation = evaluate_fundamental_lattice(params -> stream, concurrentDatasetPtr, params -> translatesPtr[i], params -> numBanks, &(params -> cost[i]), &minLoad, &(params -> phasePtr -> statsPtr -> points));
+		
+		if (evaluation == isl_stat_error) {
+			error(params -> stream, "Error during the evaluation of the cost function");
+			goto cleanup;
+		}
+		
+		dateCost = params -> cost[i] - dateCost;
+		
+		if (record != NULL)
+			record[2 + i] = dateCost;
+		
+		if (params -> metrics != NULL)
+			lattice_metrics_date(&(params -> metrics[i]), dateCost, minLoad);
+		
+		params -> phasePtr -> statsPtr -> lattices += 1;
+	}
+	
+	if (record != NULL && export_date(params -> exportPtr, record) == isl_stat_error) {
+		error(params -> stream, "Error during the export of the date");
+		goto cleanup;
+	}
+	
+	complete_phase(params -> stream, &(phasePoint));
+	
+	if (params -> phasePtr -> progressPtr != NULL)
+		progress_update(params -> stream, params -> phasePtr -> progressPtr, 1, params -> numLattices);
+	
+	// The date counts as evaluated only once all the lattices are charged
+	if (params -> checkpointPtr != NULL && checkpoint_date_done(params -> stream, params -> checkpointPtr, pointPtr) == isl_stat_error) {
+		error(params -> stream, "Error during the checkpoint of the date");
+		goto cleanup;
+	}
+	
+	outcome = isl_stat_ok;
+
+cleanup:
+	// Nothing built for a date outlives it
+	if (polyhedralSlicePtr != NULL)
+		for (int i = 0; i < params -> numTasks; i++)
+			isl_union_set_free(polyhedralSlicePtr[i]);
+	
+	if (processorDatasetPtr != NULL)
+		dataset_array_free(processorDatasetPtr, params -> memoryPtr -> latency -> numProcessors);
+	
+	arena_reset(params -> arenaPtr);
+	isl_set_free(readDatasetPtr);
+	isl_set_free(writeDatasetPtr);
+	isl_set_free(concurrentDatasetPtr);
+	isl_printer_free(printer);
+	isl_point_free(pointPtr);
+	
+	if (params -> phasePtr -> checkMemory)
+		memory_date_record(params -> phasePtr);
+	
+	return outcome;
+}
+
+isl_stat date_count(isl_point * pointPtr, void * user) {
+	
+	*((unsigned long *)user) += 1;
+	isl_point_free(pointPtr);
+	
+	return isl_stat_ok;
+}
@@ -0,0 +1,169 @@
+#ifdef MOREVERBOSE
+#define VERBOSE
+#endif
+/*
+ * Implementation of the search over the placements of the arrays. The
+ * schedules do not depend on where the arrays lie, so each candidate shares
+ * the linearization and only remaps and bounds the accesses again before the
+ * concurrent part. The candidates give each array its own coordinate with a
+ * shift of its first dimension, from 0 to the given offset, or interleave the
+ * arrays of each task. The capacity depends on the placement, so each
+ * candidate leaves out the lattices which do not fit in the banks under it.
+ */
+#include<stdlib.h>
+#include<limits.h>
+
+#include<pet.h>
+#include<isl/set.h>
+#include<isl/union_set.h>
+#include<isl/union_map.h>
+
+#include "config.h"
+#include "support.h"
+#include "partitioning.h"
+#include "codegen.h"
+#include "capacity.h"
+#include "placement.h"
+
+extern const unsigned parallel_phases;
+
+isl_stat placement_allocate(FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, unsigned dim, const placement_policy * policyPtr) {
+	// Dimensionality of the address space under the placement
+	unsigned placementDim = 0;
+	
+	for (int i = 0; i < numTasks; i++) {
+		modifiedPolyhedralModelPtr[i] -> remappedMayReads = isl_union_map_free(modifiedPolyhedralModelPtr[i] -> remappedMayReads);
+		modifiedPolyhedralModelPtr[i] -> remappedMayWrites = isl_union_map_free(modifiedPolyhedralModelPtr[i] -> remappedMayWrites);
+		modifiedPolyhedralModelPtr[i] -> remappedMustWrites = isl_union_map_free(modifiedPolyhedralModelPtr[i] -> remappedMustWrites);
+		// The merged accesses would still follow the former placement
+		modifiedPolyhedralModelPtr[i] -> mergedAccesses = isl_union_map_free(modifiedPolyhedralModelPtr[i] -> mergedAccesses);
+		modifiedPolyhedralModelPtr[i] -> taggedAccesses = isl_union_map_free(modifiedPolyhedralModelPtr[i] -> taggedAccesses);
+	}
+	
+	if (virtual_allocation(stream, optionsHdl, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, &placementDim, policyPtr) == isl_stat_error) {
+		error(stream, "Error during virtual address space allocation");
+		return isl_stat_error;
+	}
+	
+	// The lattices were read for the dimensionality of the first allocation
+	if (placementDim != dim) {
+		error(stream, "The placement changes the dimensionality of the address space");
+		return isl_stat_error;
+	}
+	
+	if (eliminate_parameters_accesses(stream, archPtr, modifiedPolyhedralModelPtr, numTasks) == isl_stat_error) {
+		error(stream, "Error during parameter projection out");
+		return isl_stat_error;
+	}
+	
+	return isl_stat_ok;
+}
+
+isl_stat placement_search(FILE * stream, phase * phasePtr, isl_ctx * optionsHdl, const architecture_config * archPtr, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, unsigned dim, isl_set * linearizedDatesPtr, isl_set *** translatesPtr, unsigned numLattices, unsigned maxOffset, unsigned numWorkers, placement_policy * bestPolicyPtr) {
+	// Placement being evaluated
+	placement_policy policy = {0, 0};
+	// Models of the tasks under the candidate placement
+	manipulated_polyhedral_model ** candidateModelPtr = NULL;
+	// Addresses accessed under the candidate placement
+	isl_set * addressSpacePtr = NULL;
+	// Lattices fitting in the banks under the candidate placement
+	isl_set *** feasiblePtr = NULL;
+	// Array of cost function values of the candidate for each lattice
+	unsigned long * cost = NULL;
+	// Best lattice of the candidate and its cost
+	unsigned latticeIdx = 0;
+	unsigned long latticeCost = 0;
+	// Best placement so far
+	unsigned bestLatticeIdx = 0;
+	unsigned long bestCost = ULONG_MAX;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	
+	cost = malloc(numLattices * sizeof(unsigned long));
+	
+	if (cost == NULL) {
+		error(stream, "Memory allocation problem :(");
+		return isl_stat_error;
+	}
+	
+	// The interleaved arrays are not shifted, which could make them overlap
+	for (policy.interleaved = 0; policy.interleaved <= 1 && outcome == isl_stat_ok; policy.interleaved++)
+		for (policy.offset = 0; policy.offset <= (policy.interleaved ? 0 : maxOffset) && outcome == isl_stat_ok; policy.offset++) {
+			candidateModelPtr = manipulated_polyhedral_model_array_alloc(numTasks);
+			
+			if (candidateModelPtr == NULL) {
+				error(stream, "Memory allocation problem :(");
+				outcome = isl_stat_error;
+				break;
+			}
+			
+			// The schedules are shared by all the candidates
+			for (int i = 0; i < numTasks; i++) {
+				candidateModelPtr[i] -> instanceSet = isl_union_set_copy(modifiedPolyhedralModelPtr[i] -> instanceSet);
+				candidateModelPtr[i] -> flattenedSchedule = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> flattenedSchedule);
+				candidateModelPtr[i] -> linearizedSchedule = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> linearizedSchedule);
+				candidateModelPtr[i] -> processorSchedule = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> processorSchedule);
+			}
+			
+			outcome = placement_allocate(stream, optionsHdl, archPtr, polyhedralModelPtr, candidateModelPtr, numTasks, dim, &policy);
+			
+			// The lattices which would be rejected under this placement cannot win it
+			if (outcome == isl_stat_ok && archPtr -> bankCapacity > 0) {
+				addressSpacePtr = address_space_range(candidateModelPtr, numTasks);
+				feasiblePtr = addressSpacePtr != NULL ? lattices_capacity_view(stream, translatesPtr, numLattices, archPtr -> numBanks, archPtr -> bankCapacity, addressSpacePtr) : NULL;
+				addressSpacePtr = isl_set_free(addressSpacePtr);
+				
+				if (feasiblePtr == NULL) {
+					error(stream, "Error during the capacity analysis");
+					outcome = isl_stat_error;
+				}
+			}
+			
+			if (outcome == isl_stat_ok && numWorkers > 1)
+				outcome = cost_function_compute_sharded(stream, phasePtr, candidateModelPtr, numTasks, linearizedDatesPtr, feasiblePtr != NULL ? feasiblePtr : translatesPtr, numLattices, archPtr -> numBanks, &(archPtr -> memory), cost, NULL, numWorkers, NULL);
+			else if (outcome == isl_stat_ok)
+				outcome = cost_function_compute(stream, phasePtr, candidateModelPtr, numTasks, linearizedDatesPtr, feasiblePtr != NULL ? feasiblePtr : translatesPtr, numLattices, archPtr -> numBanks, &(archPtr -> memory), cost, NULL, NULL, NULL);
+			
+			manipulated_polyhedral_model_array_free(candidateModelPtr, numTasks);
+			free(feasiblePtr);
+			feasiblePtr = NULL;
+			
+			if (outcome == isl_stat_error)
+				break;
+			
+			// The phases of the candidates are not those of the run
+			phasePtr -> phase_num -= parallel_phases;
+			latticeIdx = best_lattice(stream, cost, numLattices, &latticeCost);
+			
+#ifdef VERBOSE
+			fprintf(stream, "Placement %s, offset %u: lattice %u with a cost of %lu\n", policy.interleaved ? "interleaved" : "separate", policy.offset, latticeIdx, latticeCost);
+#endif
+			
+			// The ties go to the placements met first, the simplest ones
+			if (latticeCost < bestCost) {
+				bestCost = latticeCost;
+				bestLatticeIdx = latticeIdx;
+				*bestPolicyPtr = policy;
+			}
+		}
+	
+	free(cost);
+	
+	if (outcome == isl_stat_error)
+		return isl_stat_error;
+	
+	if (bestCost == ULONG_MAX) {
+		error(stream, "No lattice fits in the banks under any placement");
+		return isl_stat_error;
+	}
+	
+	if (bestPolicyPtr -> interleaved)
+		fprintf(stream, "The placement with the fewest conflicts interleaves the arrays of each task");
+	else
+		fprintf(stream, "The placement with the fewest conflicts gives each array its own coordinate, shifted by %u", bestPolicyPtr -> offset);
+	
+	fprintf(stream, ", with the lattice number %u and a cost of %lu\n", bestLatticeIdx, bestCost);
+	fflush(stream);
+	
+	return isl_stat_ok;
+}
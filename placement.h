@@ -0,0 +1,22 @@
+/*
+ * Definitions of the joint search over the placement of the arrays in the
+ * virtual address space and the lattice.
+ */
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include<stdio.h>
+
+#include<pet.h>
+#include<isl/ctx.h>
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+
+isl_stat placement_allocate(FILE *, isl_ctx *, const architecture_config *, pet_scop **, manipulated_polyhedral_model **, unsigned, unsigned, const placement_policy *);
+isl_stat placement_search(FILE *, phase *, isl_ctx *, const architecture_config *, pet_scop **, manipulated_polyhedral_model **, unsigned, unsigned, isl_set *, isl_set ***, unsigned, unsigned, unsigned, placement_policy *);
+
+#endif /* PLACEMENT_H */
@@ -11,13 +11,14 @@
 #include "support.h"
 #include "model.h"
 #include "partitioning.h"
+#include "profiling.h"
 
 #define GO_ON isl_bool_true
 #define STOP isl_bool_false
 
 isl_bool findOutermostParallel (__isl_keep isl_schedule_node *, void *);
 
-isl_stat physical_schedule (FILE * stream, isl_ctx * optionsHdl, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks) {
+isl_stat physical_schedule (FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks) {
 	// Dimensionality of the domain of the schedule of the current task
 	unsigned scheduleDim = 0;
 	// Depth of the parallel dimension of the current task
@@ -38,6 +39,12 @@ isl_stat physical_schedule (FILE * stream, isl_ctx * optionsHdl, pet_scop ** pol
 	isl_multi_aff * physicalScheduleFunctionPtr = NULL;
 	// Pointer to the physical schedule dimension currently build
 	isl_aff * physicalScheduleDimensionPtr = NULL;
+	// Pointer to the range of the original schedule, only used for its space
+	isl_set * scheduleRangePtr = NULL;
+	// Pointer to the processor of an instance as a function of its schedule
+	isl_aff * processorPtr = NULL;
+	// First processor of the current task, the processors being numbered across the tasks
+	unsigned firstProcessor = 0;
 	
 	for (int i = 0; i < numTasks; i++) {
 		scheduleTreePtr = pet_scop_get_schedule(polyhedralModelPtr[i]);
@@ -76,7 +83,11 @@ isl_stat physical_schedule (FILE * stream, isl_ctx * optionsHdl, pet_scop ** pol
 		
 		fprintf(stream, "\n");
 #endif
-		scheduleSpacePtr = isl_set_get_space(isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(schedulePtr))));
+		isl_schedule_free(scheduleTreePtr);
+		
+		scheduleRangePtr = isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(schedulePtr)));
+		scheduleSpacePtr = isl_set_get_space(scheduleRangePtr);
+		isl_set_free(scheduleRangePtr);
 		
 		if (scheduleSpacePtr == NULL)
 			return isl_stat_error;	
@@ -100,8 +111,21 @@ isl_stat physical_schedule (FILE * stream, isl_ctx * optionsHdl, pet_scop ** pol
 		
 		fprintf(stream, "\n");
 #endif
-		// The space of the multiple affine function is obtained by artificially building the universal relation between two copies of the schedule set
-		physicalScheduleFunctionPtr = isl_multi_aff_identity(isl_map_get_space(isl_map_from_domain_and_range(isl_set_universe(isl_space_copy(scheduleSpacePtr)), isl_set_universe(isl_space_copy(scheduleSpacePtr)))));
+		// The processor of an instance is the position of its parallel iterator in its group of N, only needed by the latencies
+		if (archPtr -> memory.latency != NULL) {
+			processorPtr = isl_aff_var_on_domain(isl_local_space_from_space(isl_space_copy(scheduleSpacePtr)), isl_dim_set, parallelIteratorPos);
+			processorPtr = isl_aff_mod_val(processorPtr, isl_val_int_from_si(optionsHdl, archPtr -> N[i]));
+			processorPtr = isl_aff_add_constant_si(processorPtr, firstProcessor);
+			modifiedPolyhedralModelPtr[i] -> processorSchedule = isl_union_map_apply_range(isl_union_map_copy(schedulePtr), isl_union_map_from_map(isl_map_from_aff(processorPtr)));
+			
+			if (modifiedPolyhedralModelPtr[i] -> processorSchedule == NULL)
+				return isl_stat_error;
+		}
+		
+		firstProcessor += archPtr -> N[i];
+		
+		// The space of the multiple affine function is the one of the relation between two copies of the schedule set
+		physicalScheduleFunctionPtr = isl_multi_aff_identity(isl_space_map_from_set(scheduleSpacePtr));
 		
 		if (physicalScheduleFunctionPtr == NULL)
 			return isl_stat_error;
@@ -138,7 +162,7 @@ isl_stat physical_schedule (FILE * stream, isl_ctx * optionsHdl, pet_scop ** pol
 		fprintf(stream, "\n");
 #endif
 		
-		physicalScheduleDimensionPtr = isl_aff_set_coefficient_val(physicalScheduleDimensionPtr, isl_dim_in, parallelIteratorPos, isl_val_inv(isl_val_int_from_si(optionsHdl, N[i])));
+		physicalScheduleDimensionPtr = isl_aff_set_coefficient_val(physicalScheduleDimensionPtr, isl_dim_in, parallelIteratorPos, isl_val_inv(isl_val_int_from_si(optionsHdl, archPtr -> N[i])));
 		physicalScheduleDimensionPtr = isl_aff_floor(physicalScheduleDimensionPtr);
 		
 #ifdef MOREVERBOSE
@@ -186,6 +210,12 @@ isl_stat physical_schedule (FILE * stream, isl_ctx * optionsHdl, pet_scop ** pol
 #endif
 	}
 	
+	// The non - uniform model charges every processor with its own latencies
+	if (archPtr -> memory.latency != NULL && firstProcessor > archPtr -> memory.latency -> numProcessors) {
+		error(stream, "The latency matrix needs a row for each processor");
+		return isl_stat_error;
+	}
+	
 	return isl_stat_ok;
 }
 
@@ -197,7 +227,8 @@ isl_union_set * polyhedral_slice_build (FILE * stream, isl_union_map * flattened
 	// Pointer to the singleton set of the point
 	isl_union_set * vectorSetPtr = NULL;
 	
-	vectorSetPtr = isl_union_map_domain(isl_union_map_intersect_range(linearizedSchedulePtr, isl_union_set_from_point(isl_point_copy(datePtr))));
+	PROFILE_UNION_MAP(PROFILE_SLICE_DATES, linearizedSchedulePtr);
+	PROFILE_TIMED(PROFILE_SLICE_DATES, vectorSetPtr = isl_union_map_domain(isl_union_map_intersect_range(linearizedSchedulePtr, isl_union_set_from_point(isl_point_copy(datePtr)))));
 	
 	if(vectorSetPtr == NULL)
 		return NULL;
@@ -227,7 +258,10 @@ isl_union_set * polyhedral_slice_build (FILE * stream, isl_union_map * flattened
 	isl_printer_free(printer);
 #endif
 	
-	return isl_union_map_domain(isl_union_map_intersect_range(flattenedSchedulePtr, vectorSetPtr));
+	PROFILE_UNION_MAP(PROFILE_SLICE_INSTANCES, flattenedSchedulePtr);
+	PROFILE_TIMED(PROFILE_SLICE_INSTANCES, vectorSetPtr = isl_union_map_domain(isl_union_map_intersect_range(flattenedSchedulePtr, vectorSetPtr)));
+	
+	return vectorSetPtr;
 }
 
 
@@ -0,0 +1,263 @@
+#ifdef MOREVERBOSE
+#define VERBOSE
+#endif
+/*
+ * Implementation of the search over the numbers of processors. The polyhedral
+ * models and the virtual allocation do not depend on them, so each candidate
+ * starts from copies of the remapped accesses and only rebuilds the physical
+ * schedule, the parameter elimination, the linearization and the concurrent
+ * part. The cost of a lattice being the cycles the banks need over all the
+ * dates, the candidate whose best lattice costs the least has the highest
+ * throughput. The addresses accessed do not depend on the numbers of
+ * processors either, so the lattices which do not fit in the banks are left
+ * out of every candidate.
+ */
+#include<stdlib.h>
+#include<limits.h>
+
+#include<pet.h>
+#include<isl/set.h>
+#include<isl/union_map.h>
+
+#include "config.h"
+#include "support.h"
+#include "partitioning.h"
+#include "codegen.h"
+#include "capacity.h"
+#include "processors.h"
+
+extern const unsigned parallel_phases;
+
+isl_set * processors_address_space(FILE *, const architecture_config *, manipulated_polyhedral_model **, unsigned);
+isl_stat processors_evaluate(FILE *, phase *, isl_ctx *, const architecture_config *, pet_scop **, manipulated_polyhedral_model **, unsigned, isl_set ***, unsigned, unsigned long *, unsigned, unsigned *, unsigned long *);
+
+// The addresses accessed by the tasks, from bounded copies of the accesses which are still parametric
+isl_set * processors_address_space(FILE * stream, const architecture_config * archPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks) {
+	// Models holding the bounded accesses
+	manipulated_polyhedral_model ** boundedModelPtr = NULL;
+	// Addresses accessed by any of the tasks
+	isl_set * addressSpacePtr = NULL;
+	
+	boundedModelPtr = manipulated_polyhedral_model_array_alloc(numTasks);
+	
+	if (boundedModelPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	for (int i = 0; i < numTasks; i++) {
+		boundedModelPtr[i] -> remappedMayReads = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads);
+		boundedModelPtr[i] -> remappedMayWrites = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayWrites);
+		boundedModelPtr[i] -> remappedMustWrites = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMustWrites);
+	}
+	
+	if (eliminate_parameters_accesses(stream, archPtr, boundedModelPtr, numTasks) == isl_stat_ok)
+		addressSpacePtr = address_space_range(boundedModelPtr, numTasks);
+	
+	manipulated_polyhedral_model_array_free(boundedModelPtr, numTasks);
+	
+	return addressSpacePtr;
+}
+
+isl_stat processors_evaluate(FILE * stream, phase * phasePtr, isl_ctx * optionsHdl, const architecture_config * candidateArchPtr, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set *** translatesPtr, unsigned numLattices, unsigned long * cost, unsigned numWorkers, unsigned * bestLatticeIdxPtr, unsigned long * bestCostPtr) {
+	// Models of the tasks under the candidate numbers of processors
+	manipulated_polyhedral_model ** candidateModelPtr = NULL;
+	// Set of all the linearized dates of the candidate
+	isl_set * linearizedDatesPtr = NULL;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_error;
+	
+	candidateModelPtr = manipulated_polyhedral_model_array_alloc(numTasks);
+	
+	if (candidateModelPtr == NULL) {
+		error(stream, "Memory allocation problem :(");
+		return isl_stat_error;
+	}
+	
+	// The virtual allocation is shared by all the candidates
+	for (int i = 0; i < numTasks; i++) {
+		candidateModelPtr[i] -> remappedMayReads = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayReads);
+		candidateModelPtr[i] -> remappedMayWrites = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMayWrites);
+		candidateModelPtr[i] -> remappedMustWrites = isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> remappedMustWrites);
+	}
+	
+	if (physical_schedule(stream, optionsHdl, candidateArchPtr, polyhedralModelPtr, candidateModelPtr, numTasks) == isl_stat_error) {
+		error(stream, "Error during physical schedule building");
+		goto cleanup;
+	}
+	
+	if (eliminate_parameters(stream, candidateArchPtr, polyhedralModelPtr, candidateModelPtr, numTasks) == isl_stat_error) {
+		error(stream, "Error during parameter projection out");
+		goto cleanup;
+	}
+	
+	if (linearize_dates(stream, candidateModelPtr, numTasks) == isl_stat_error) {
+		error(stream, "Error during dates linearization");
+		goto cleanup;
+	}
+	
+	linearizedDatesPtr = linearized_dates_union(stream, candidateModelPtr, numTasks);
+	
+	if (linearizedDatesPtr == NULL) {
+		error(stream, "Error during dates union");
+		goto cleanup;
+	}
+	
+	if (numWorkers > 1)
+		outcome = cost_function_compute_sharded(stream, phasePtr, candidateModelPtr, numTasks, linearizedDatesPtr, translatesPtr, numLattices, candidateArchPtr -> numBanks, &(candidateArchPtr -> memory), cost, NULL, numWorkers, NULL);
+	else
+		outcome = cost_function_compute(stream, phasePtr, candidateModelPtr, numTasks, linearizedDatesPtr, translatesPtr, numLattices, candidateArchPtr -> numBanks, &(candidateArchPtr -> memory), cost, NULL, NULL, NULL);
+	
+	// The phases of the candidates are not those of the run
+	phasePtr -> phase_num -= parallel_phases;
+	
+	if (outcome == isl_stat_error) {
+		error(stream, "Error during the concurrent part");
+		goto cleanup;
+	}
+	
+	*bestLatticeIdxPtr = best_lattice(stream, cost, numLattices, bestCostPtr);
+
+cleanup:
+	isl_set_free(linearizedDatesPtr);
+	manipulated_polyhedral_model_array_free(candidateModelPtr, numTasks);
+	
+	return outcome;
+}
+
+unsigned * processors_search(FILE * stream, phase * phasePtr, isl_ctx * optionsHdl, const architecture_config * archPtr, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set *** translatesPtr, unsigned numLattices, unsigned budget, unsigned numWorkers) {
+	// Configuration of the candidate
+	architecture_config candidateArch = *archPtr;
+	// Numbers of processors being evaluated and best ones
+	unsigned * candidate = NULL;
+	unsigned * bestCandidate = NULL;
+	// Total number of processors of the candidate
+	unsigned total = 0;
+	// Array of cost function values of the candidate for each lattice
+	unsigned long * cost = NULL;
+	// Best lattice of the candidate and its cost
+	unsigned latticeIdx = 0;
+	unsigned long latticeCost = 0;
+	// Best candidate so far
+	unsigned bestLatticeIdx = 0;
+	unsigned long bestCost = ULONG_MAX;
+	unsigned bestTotal = 0;
+	// Number of candidates evaluated
+	unsigned numEvaluated = 0;
+	// Task whose number of processors is being advanced
+	int k = 0;
+	// Addresses accessed by the tasks
+	isl_set * addressSpacePtr = NULL;
+	// Lattices fitting in the banks, the others being left out of the search
+	isl_set *** feasiblePtr = NULL;
+	
+	// Every processor needs its row of latencies
+	if (archPtr -> memory.latency != NULL && budget > archPtr -> memory.latency -> numProcessors) {
+		warning(stream, "The budget of processors is cut to the rows of the latency matrix");
+		budget = archPtr -> memory.latency -> numProcessors;
+	}
+	
+	if (budget < numTasks) {
+		error(stream, "The budget of processors leaves a task without processor");
+		return NULL;
+	}
+	
+	candidate = malloc(numTasks * sizeof(unsigned));
+	bestCandidate = malloc(numTasks * sizeof(unsigned));
+	cost = malloc(numLattices * sizeof(unsigned long));
+	
+	if (candidate == NULL || bestCandidate == NULL || cost == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto failure;
+	}
+	
+	// The capacity does not depend on the numbers of processors, so it is analysed once
+	if (archPtr -> bankCapacity > 0) {
+		addressSpacePtr = processors_address_space(stream, archPtr, modifiedPolyhedralModelPtr, numTasks);
+		
+		if (addressSpacePtr == NULL) {
+			error(stream, "Error during the address space of the tasks");
+			goto failure;
+		}
+		
+		feasiblePtr = lattices_capacity_view(stream, translatesPtr, numLattices, archPtr -> numBanks, archPtr -> bankCapacity, addressSpacePtr);
+		isl_set_free(addressSpacePtr);
+		
+		if (feasiblePtr == NULL) {
+			error(stream, "Error during the capacity analysis");
+			goto failure;
+		}
+		
+		translatesPtr = feasiblePtr;
+	}
+	
+	for (int i = 0; i < numTasks; i++)
+		candidate[i] = 1;
+	
+	candidateArch.N = candidate;
+	
+	// Every vector of at least one processor per task within the budget
+	do {
+		total = 0;
+		
+		for (int i = 0; i < numTasks; i++)
+			total += candidate[i];
+		
+		if (total <= budget) {
+			if (processors_evaluate(stream, phasePtr, optionsHdl, &candidateArch, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, translatesPtr, numLattices, cost, numWorkers, &latticeIdx, &latticeCost) == isl_stat_error)
+				goto failure;
+			
+			numEvaluated += 1;
+			
+#ifdef VERBOSE
+			fprintf(stream, "Processors");
+			
+			for (int i = 0; i < numTasks; i++)
+				fprintf(stream, " %u", candidate[i]);
+			
+			fprintf(stream, ": lattice %u with a cost of %lu\n", latticeIdx, latticeCost);
+#endif
+			
+			// The ties go to the candidate with fewer processors
+			if (latticeCost < bestCost || (latticeCost == bestCost && total < bestTotal)) {
+				bestCost = latticeCost;
+				bestLatticeIdx = latticeIdx;
+				bestTotal = total;
+				
+				for (int i = 0; i < numTasks; i++)
+					bestCandidate[i] = candidate[i];
+			}
+		}
+		
+		for (k = 0; k < numTasks && ++candidate[k] > budget - numTasks + 1; k++)
+			candidate[k] = 1;
+	} while (k < numTasks);
+	
+	if (bestCost == ULONG_MAX) {
+		error(stream, "No lattice fitting in the banks to compare the numbers of processors");
+		goto failure;
+	}
+	
+	info(stream, "Numbers of processors evaluated: %d", numEvaluated);
+	fprintf(stream, "The numbers of processors with the highest throughput are");
+	
+	for (int i = 0; i < numTasks; i++)
+		fprintf(stream, " %u", bestCandidate[i]);
+	
+	fprintf(stream, ", with the lattice number %u and a cost of %lu\n", bestLatticeIdx, bestCost);
+	fflush(stream);
+	
+	free(candidate);
+	free(cost);
+	free(feasiblePtr);
+	
+	return bestCandidate;
+
+failure:
+	free(candidate);
+	free(bestCandidate);
+	free(cost);
+	free(feasiblePtr);
+	
+	return NULL;
+}
@@ -0,0 +1,21 @@
+/*
+ * Definitions of the joint search over the numbers of processors of the tasks
+ * and the lattice, under a budget on the total number of processors.
+ */
+
+#ifndef PROCESSORS_H
+#define PROCESSORS_H
+
+#include<stdio.h>
+
+#include<pet.h>
+#include<isl/ctx.h>
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+
+unsigned * processors_search(FILE *, phase *, isl_ctx *, const architecture_config *, pet_scop **, manipulated_polyhedral_model **, unsigned, isl_set ***, unsigned, unsigned, unsigned);
+
+#endif /* PROCESSORS_H */
@@ -0,0 +1,158 @@
+/*
+ * Implementation of the counters of the isl operations on the hot path
+ */
+#include "support.h"
+#include "profiling.h"
+
+#ifdef PROFILING
+
+typedef struct {
+	unsigned long calls;
+	double time;
+	unsigned long sizedCalls;
+	unsigned long basicSets;
+	unsigned long constraints;
+	unsigned long maxBasicSets;
+	unsigned long maxConstraints;
+} profile_counter;
+
+typedef struct {
+	unsigned long basicSets;
+	unsigned long constraints;
+} profile_size;
+
+const char * profileNames[] = {
+	"isl_union_set_lex_lt_union_set (linearization)",
+	"union_set_count (linearization)",
+	"isl_union_map_union (linearization)",
+	"isl_union_map_coalesce (linearization)",
+	"isl_set_coalesce (dates union)",
+	"isl_union_map_intersect_range (slice dates)",
+	"isl_union_map_intersect_range (slice instances)",
+	"isl_union_set_apply (dataset)",
+	"isl_set_union (dataset)",
+	"isl_set_coalesce (dataset)",
+	"isl_set_intersect (Z - polyhedron)",
+	"set_count (Z - polyhedron)",
+	"isl_set_count_val (counting backend)",
+	"isl_set_card (counting backend)",
+	"isl_map/set_project_out (parameters)",
+	"isl_union_map/set_union (parameters)"
+};
+
+// The counters are process - wide: isl contexts are never shared between threads
+profile_counter profileCounters[NUMPROFILES];
+
+isl_stat profile_basic_set_size(isl_basic_set *, void *);
+isl_stat profile_set_size(isl_set *, void *);
+isl_stat profile_basic_map_size(isl_basic_map *, void *);
+isl_stat profile_map_size(isl_map *, void *);
+void profile_size_record(profile_id, profile_size *);
+
+void profile_time(profile_id id, double elapsed) {
+	profileCounters[id].calls += 1;
+	profileCounters[id].time += elapsed;
+}
+
+void profile_point(profile_id id) {
+	profileCounters[id].calls += 1;
+}
+
+void profile_set(profile_id id, isl_set * set) {
+	// Size of the input
+	profile_size size = { 0, 0 };
+
+	isl_set_foreach_basic_set(set, profile_basic_set_size, &size);
+	profile_size_record(id, &size);
+}
+
+void profile_union_set(profile_id id, isl_union_set * uset) {
+	// Size of the input
+	profile_size size = { 0, 0 };
+
+	isl_union_set_foreach_set(uset, profile_set_size, &size);
+	profile_size_record(id, &size);
+}
+
+void profile_union_map(profile_id id, isl_union_map * umap) {
+	// Size of the input
+	profile_size size = { 0, 0 };
+
+	isl_union_map_foreach_map(umap, profile_map_size, &size);
+	profile_size_record(id, &size);
+}
+
+void profile_size_record(profile_id id, profile_size * sizePtr) {
+	profileCounters[id].sizedCalls += 1;
+	profileCounters[id].basicSets += sizePtr -> basicSets;
+	profileCounters[id].constraints += sizePtr -> constraints;
+
+	if (sizePtr -> basicSets > profileCounters[id].maxBasicSets)
+		profileCounters[id].maxBasicSets = sizePtr -> basicSets;
+
+	if (sizePtr -> constraints > profileCounters[id].maxConstraints)
+		profileCounters[id].maxConstraints = sizePtr -> constraints;
+}
+
+isl_stat profile_basic_set_size(isl_basic_set * bset, void * user) {
+	// Size being accumulated
+	profile_size * sizePtr = (profile_size *)user;
+
+	sizePtr -> basicSets += 1;
+	sizePtr -> constraints += isl_basic_set_n_constraint(bset);
+	isl_basic_set_free(bset);
+
+	return isl_stat_ok;
+}
+
+isl_stat profile_set_size(isl_set * set, void * user) {
+	isl_stat outcome = isl_set_foreach_basic_set(set, profile_basic_set_size, user);
+
+	isl_set_free(set);
+
+	return outcome;
+}
+
+isl_stat profile_basic_map_size(isl_basic_map * bmap, void * user) {
+	// Size being accumulated
+	profile_size * sizePtr = (profile_size *)user;
+
+	sizePtr -> basicSets += 1;
+	sizePtr -> constraints += isl_basic_map_n_constraint(bmap);
+	isl_basic_map_free(bmap);
+
+	return isl_stat_ok;
+}
+
+isl_stat profile_map_size(isl_map * map, void * user) {
+	isl_stat outcome = isl_map_foreach_basic_map(map, profile_basic_map_size, user);
+
+	isl_map_free(map);
+
+	return outcome;
+}
+
+void profile_dump(FILE * stream) {
+	// Counter being printed
+	profile_counter * counterPtr = NULL;
+
+	fprintf(stream, "%-50s %12s %12s %12s %10s %12s %10s\n", "Operation", "Calls", "Time (s)", "Avg (us)", "Avg bsets", "Avg constr.", "Max bsets");
+
+	for (int i = 0; i < NUMPROFILES; i++) {
+		counterPtr = &(profileCounters[i]);
+
+		if (counterPtr -> calls == 0)
+			continue;
+
+		fprintf(stream, "%-50s %12lu %12.6f %12.3f", profileNames[i], counterPtr -> calls, counterPtr -> time, counterPtr -> time * 1e6 / counterPtr -> calls);
+
+		if (counterPtr -> sizedCalls > 0)
+			fprintf(stream, " %10.2f %12.2f %10lu", (double)counterPtr -> basicSets / counterPtr -> sizedCalls, (double)counterPtr -> constraints / counterPtr -> sizedCalls, counterPtr -> maxBasicSets);
+
+		fprintf(stream, "\n");
+	}
+
+	fflush(stream);
+}
+
+#endif /* PROFILING */
@@ -0,0 +1,69 @@
+/*
+ * Definitions of the counters of the isl operations on the hot path. They are
+ * only compiled in when PROFILING is defined; otherwise the macros reduce to
+ * the profiled statements themselves.
+ */
+
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include<stdio.h>
+
+#include<isl/set.h>
+#include<isl/union_set.h>
+#include<isl/union_map.h>
+
+typedef enum {
+	PROFILE_LEX_LT,
+	PROFILE_LEX_COUNT,
+	PROFILE_LINEARIZATION_UNION,
+	PROFILE_LINEARIZATION_COALESCE,
+	PROFILE_DATES_COALESCE,
+	PROFILE_SLICE_DATES,
+	PROFILE_SLICE_INSTANCES,
+	PROFILE_DATASET_APPLY,
+	PROFILE_DATASET_UNION,
+	PROFILE_DATASET_COALESCE,
+	PROFILE_LATTICE_INTERSECT,
+	PROFILE_LATTICE_COUNT,
+	PROFILE_COUNT_ENUMERATED,
+	PROFILE_COUNT_SYMBOLIC,
+	PROFILE_PARAMETERS_PROJECT,
+	PROFILE_PARAMETERS_UNION,
+	NUMPROFILES
+} profile_id;
+
+#ifdef PROFILING
+
+void profile_time(profile_id, double);
+void profile_set(profile_id, isl_set *);
+void profile_union_set(profile_id, isl_union_set *);
+void profile_union_map(profile_id, isl_union_map *);
+void profile_point(profile_id);
+void profile_dump(FILE *);
+
+// Times the given statement and charges it to the counter
+#define PROFILE_TIMED(id, ...) do { \
+		double profileStart = wall_clock(); \
+		__VA_ARGS__; \
+		profile_time((id), wall_clock() - profileStart); \
+	} while (0)
+// Records the size of the input of an operation, before it is consumed
+#define PROFILE_SET(id, set) profile_set((id), (set))
+#define PROFILE_UNION_SET(id, uset) profile_union_set((id), (uset))
+#define PROFILE_UNION_MAP(id, umap) profile_union_map((id), (umap))
+#define PROFILE_POINT(id) profile_point(id)
+#define PROFILE_DUMP(stream) profile_dump(stream)
+
+#else
+
+#define PROFILE_TIMED(id, ...) do { __VA_ARGS__; } while (0)
+#define PROFILE_SET(id, set)
+#define PROFILE_UNION_SET(id, uset)
+#define PROFILE_UNION_MAP(id, umap)
+#define PROFILE_POINT(id)
+#define PROFILE_DUMP(stream)
+
+#endif /* PROFILING */
+
+#endif /* PROFILING_H */
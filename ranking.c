@@ -0,0 +1,164 @@
+/*
+ * Implementation of the ranking of the lattices
+ */
+#define _GNU_SOURCE
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+
+#include "ranking.h"
+
+const char * metricNames[] = {
+	"cost",
+	"worst",
+	"variance",
+	"imbalance"
+};
+
+// What the comparison of two lattices needs
+typedef struct {
+	unsigned long * cost;
+	lattice_metrics * metrics;
+	unsigned long numDates;
+	ranking_objective * objectivePtr;
+} ranking_context;
+
+double metric_value(ranking_context *, metric_id, unsigned);
+int lattice_compare(const void *, const void *, void *);
+
+// The objective is a comma - separated list of metric names, the first one being the most important
+int objective_parse(const char * text, ranking_objective * objectivePtr) {
+	// Length of the current name
+	size_t length = 0;
+	// Metric of the current name
+	int metric = 0;
+	
+	objectivePtr -> numKeys = 0;
+	
+	while (*text != '\0') {
+		length = strcspn(text, ",");
+		
+		for (metric = 0; metric < NUMMETRICS; metric++)
+			if (strlen(metricNames[metric]) == length && strncmp(text, metricNames[metric], length) == 0)
+				break;
+		
+		if (metric == NUMMETRICS || objectivePtr -> numKeys == NUMMETRICS)
+			return -1;
+		
+		objectivePtr -> keys[objectivePtr -> numKeys++] = metric;
+		text += length;
+		
+		if (*text == ',')
+			text++;
+	}
+	
+	return objectivePtr -> numKeys > 0 ? 0 : -1;
+}
+
+void lattice_metrics_date(lattice_metrics * metricsPtr, unsigned long maxLoad, unsigned long minLoad) {
+	
+	if (maxLoad > metricsPtr -> worstDate)
+		metricsPtr -> worstDate = maxLoad;
+	
+	metricsPtr -> sumSquares += maxLoad * maxLoad;
+	metricsPtr -> imbalance += maxLoad - minLoad;
+}
+
+void lattice_metrics_merge(lattice_metrics * metricsPtr, lattice_metrics * otherPtr) {
+	
+	if (otherPtr -> worstDate > metricsPtr -> worstDate)
+		metricsPtr -> worstDate = otherPtr -> worstDate;
+	
+	metricsPtr -> sumSquares += otherPtr -> sumSquares;
+	metricsPtr -> imbalance += otherPtr -> imbalance;
+}
+
+double metric_value(ranking_context * contextPtr, metric_id metric, unsigned i) {
+	// Mean conflicts per date
+	double mean = 0;
+	
+	switch (metric) {
+		case METRIC_COST:
+			return contextPtr -> cost[i];
+		case METRIC_WORST:
+			return contextPtr -> metrics[i].worstDate;
+		case METRIC_VARIANCE:
+			if (contextPtr -> numDates == 0)
+				return 0;
+			
+			mean = (double)contextPtr -> cost[i] / contextPtr -> numDates;
+			
+			return (double)contextPtr -> metrics[i].sumSquares / contextPtr -> numDates - mean * mean;
+		case METRIC_IMBALANCE:
+			return contextPtr -> metrics[i].imbalance;
+		default:
+			return 0;
+	}
+}
+
+int lattice_compare(const void * first, const void * second, void * user) {
+	// What the comparison needs
+	ranking_context * contextPtr = (ranking_context *)user;
+	// Lattices being compared
+	unsigned i = *(const unsigned *)first, j = *(const unsigned *)second;
+	// Values of a metric for the two lattices
+	double iValue = 0, jValue = 0;
+	
+	// The lattices rejected by the capacity analysis come last whatever the objective
+	if ((contextPtr -> cost[i] == ULONG_MAX) != (contextPtr -> cost[j] == ULONG_MAX))
+		return contextPtr -> cost[i] == ULONG_MAX ? 1 : -1;
+	
+	for (int k = 0; k < contextPtr -> objectivePtr -> numKeys; k++) {
+		iValue = metric_value(contextPtr, contextPtr -> objectivePtr -> keys[k], i);
+		jValue = metric_value(contextPtr, contextPtr -> objectivePtr -> keys[k], j);
+		
+		if (iValue != jValue)
+			return iValue < jValue ? -1 : 1;
+	}
+	
+	// Complete ties keep the order of the catalog
+	return i < j ? -1 : (i > j ? 1 : 0);
+}
+
+unsigned * lattices_rank(unsigned long * cost, lattice_metrics * metrics, unsigned numLattices, unsigned long numDates, ranking_objective * objectivePtr) {
+	// Lattices, from the best to the worst
+	unsigned * ranking = NULL;
+	// What the comparison needs
+	ranking_context context = { cost, metrics, numDates, objectivePtr };
+	
+	ranking = malloc(numLattices * sizeof(unsigned));
+	
+	if (ranking == NULL)
+		return NULL;
+	
+	for (int i = 0; i < numLattices; i++)
+		ranking[i] = i;
+	
+	qsort_r(ranking, numLattices, sizeof(unsigned), lattice_compare, &context);
+	
+	return ranking;
+}
+
+void ranking_print(FILE * stream, unsigned * ranking, unsigned numRanked, unsigned long * cost, lattice_metrics * metrics, unsigned long numDates) {
+	// What the metrics need
+	ranking_context context = { cost, metrics, numDates, NULL };
+	
+	// Without metrics only the costs are meaningful
+	if (metrics == NULL) {
+		fprintf(stream, "%-6s %-10s %14s\n", "Rank", "Lattice", "Cost");
+		
+		for (int r = 0; r < numRanked; r++)
+			fprintf(stream, "%-6d %-10u %14lu\n", r + 1, ranking[r], cost[ranking[r]]);
+		
+		fflush(stream);
+		return;
+	}
+	
+	fprintf(stream, "%-6s %-10s %14s %14s %14s %14s\n", "Rank", "Lattice", "Cost", "Worst date", "Variance", "Imbalance");
+	
+	for (int r = 0; r < numRanked; r++)
+		fprintf(stream, "%-6d %-10u %14lu %14lu %14.3f %14lu\n", r + 1, ranking[r], cost[ranking[r]], metrics[ranking[r]].worstDate,
+			metric_value(&context, METRIC_VARIANCE, ranking[r]), metrics[ranking[r]].imbalance);
+	
+	fflush(stream);
+}
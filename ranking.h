@@ -0,0 +1,39 @@
+/*
+ * Definitions of the ranking of the lattices. Besides the summed cost, the
+ * concurrent part keeps for each lattice the conflicts of its worst date, the
+ * sum of the squares of the conflicts of each date, for their variance, and
+ * the summed difference between the most and the least loaded bank, so that
+ * the lattices can be ordered by any lexicographic combination of them.
+ */
+
+#ifndef RANKING_H
+#define RANKING_H
+
+#include<stdio.h>
+
+typedef enum {
+	METRIC_COST,
+	METRIC_WORST,
+	METRIC_VARIANCE,
+	METRIC_IMBALANCE,
+	NUMMETRICS
+} metric_id;
+
+typedef struct {
+	unsigned long worstDate;
+	unsigned long sumSquares;
+	unsigned long imbalance;
+} lattice_metrics;
+
+typedef struct {
+	metric_id keys[NUMMETRICS];
+	unsigned numKeys;
+} ranking_objective;
+
+int objective_parse(const char *, ranking_objective *);
+void lattice_metrics_date(lattice_metrics *, unsigned long, unsigned long);
+void lattice_metrics_merge(lattice_metrics *, lattice_metrics *);
+unsigned * lattices_rank(unsigned long *, lattice_metrics *, unsigned, unsigned long, ranking_objective *);
+void ranking_print(FILE *, unsigned *, unsigned, unsigned long *, lattice_metrics *, unsigned long);
+
+#endif /* RANKING_H */
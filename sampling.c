@@ -0,0 +1,214 @@
+/*
+ * Implementation of the screening of the lattices. The range of the
+ * linearized dates is split in strata of equal width and one date is taken
+ * from each of them; the cost of every lattice on the whole schedule is then
+ * estimated from the conflicts of the sampled dates, with an interval given by
+ * their spread, also used by the anytime evaluation. The interval only orders
+ * the lattices: the conflicts of a date are never negative, so the cost of a
+ * lattice on the sample is a lower bound of its exact cost, and a lattice is
+ * rejected only when that bound is above the exact cost of the best estimated
+ * lattice, which the exact evaluation can then never miss.
+ */
+#include<stdlib.h>
+#include<limits.h>
+#include<math.h>
+
+#include<isl/set.h>
+#include<isl/val.h>
+
+#include "support.h"
+#include "counting.h"
+#include "partitioning.h"
+#include "sampling.h"
+
+// Width of the confidence intervals, in standard errors
+#define SCREENCONFIDENCE 3.0
+
+extern const unsigned parallel_phases;
+
+isl_set * stratum_date(isl_set *, long, long);
+
+// Estimated cost on the whole schedule of a lattice evaluated on a sample of the dates
+void cost_estimate(unsigned long sampleCost, lattice_metrics * sampleMetricsPtr, unsigned long numSampled, unsigned long numDates, double * estimatePtr, double * marginPtr) {
+	// Mean and variance of the conflicts per sampled date
+	double mean = (double)sampleCost / numSampled, variance = 0;
+	
+	*estimatePtr = mean * numDates;
+	
+	if (numSampled < 2) {
+		*marginPtr = INFINITY;
+		return;
+	}
+	
+	variance = ((double)sampleMetricsPtr -> sumSquares - numSampled * mean * mean) / (numSampled - 1);
+	
+	if (variance < 0)
+		variance = 0;
+	
+	// Sampling without replacement from a finite schedule
+	*marginPtr = SCREENCONFIDENCE * numDates * sqrt(variance / numSampled * (1.0 - (double)numSampled / numDates));
+}
+
+isl_set * sample_dates(isl_set * linearizedDatesPtr, unsigned long numSamples) {
+	// Smallest and largest linearized dates
+	isl_val * boundVal = NULL;
+	// First linearized date
+	long firstDate = 0;
+	// Number of linearized dates between the first and the last one
+	long numDates = 0;
+	// Sampled dates
+	isl_set * sampleDatesPtr = NULL;
+	// Date sampled from a stratum
+	isl_set * datePtr = NULL;
+	
+	boundVal = isl_set_dim_min_val(isl_set_copy(linearizedDatesPtr), 0);
+	firstDate = isl_val_get_num_si(boundVal);
+	isl_val_free(boundVal);
+	boundVal = isl_set_dim_max_val(isl_set_copy(linearizedDatesPtr), 0);
+	numDates = isl_val_get_num_si(boundVal) - firstDate + 1;
+	isl_val_free(boundVal);
+	
+	if (numDates < numSamples)
+		numSamples = numDates > 0 ? numDates : 1;
+	
+	sampleDatesPtr = isl_set_empty(isl_set_get_space(linearizedDatesPtr));
+	
+	for (long s = 0; s < numSamples && sampleDatesPtr != NULL; s++) {
+		datePtr = stratum_date(linearizedDatesPtr, firstDate + numDates * s / numSamples, firstDate + numDates * (s + 1) / numSamples - 1);
+		sampleDatesPtr = isl_set_union(sampleDatesPtr, datePtr);
+	}
+	
+	return isl_set_coalesce(sampleDatesPtr);
+}
+
+// The date closest to the middle of the stratum, so that the samples are evenly spaced
+isl_set * stratum_date(isl_set * linearizedDatesPtr, long firstDate, long lastDate) {
+	// Middle of the stratum
+	long middleDate = firstDate + (lastDate - firstDate) / 2;
+	// Date of the stratum
+	isl_set * datePtr = NULL;
+	
+	datePtr = isl_set_lexmin(shard_dates(linearizedDatesPtr, middleDate, lastDate));
+	
+	if (isl_set_is_empty(datePtr) == isl_bool_true) {
+		isl_set_free(datePtr);
+		datePtr = isl_set_lexmax(shard_dates(linearizedDatesPtr, firstDate, middleDate - 1));
+	}
+	
+	return datePtr;
+}
+
+isl_stat lattices_screen(FILE * stream, phase * phasePtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set * linearizedDatesPtr, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, const memory_model * memoryPtr, unsigned long numSamples, unsigned numWorkers, unsigned * survivorsPtr) {
+	// Sampled dates
+	isl_set * sampleDatesPtr = NULL;
+	// Number of linearized dates
+	unsigned long numDates = 0;
+	// Number of sampled dates
+	unsigned long numSampled = 0;
+	// Conflicts of each lattice on the sampled dates
+	unsigned long * sampleCost = NULL;
+	// Metrics of each lattice on the sampled dates
+	lattice_metrics * sampleMetrics = NULL;
+	// Estimated cost of each lattice on the whole schedule
+	double * estimate = NULL;
+	// Half width of the confidence interval of each estimate
+	double * margin = NULL;
+	// Lattice with the best estimate, evaluated on every date
+	unsigned bestLatticeIdx = 0;
+	// Exact cost of the best estimated lattice
+	unsigned long exactCost = 0;
+	// Smallest estimate
+	double bestEstimate = INFINITY;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_error;
+	
+	*survivorsPtr = 0;
+	
+	for (int i = 0; i < numLattices; i++)
+		if (translatesPtr[i] != NULL)
+			*survivorsPtr += 1;
+	
+	sampleDatesPtr = sample_dates(linearizedDatesPtr, numSamples);
+	
+	if (sampleDatesPtr == NULL || set_count(linearizedDatesPtr, &numDates) == isl_stat_error || set_count(sampleDatesPtr, &numSampled) == isl_stat_error) {
+		error(stream, "Error during the sampling of the dates");
+		isl_set_free(sampleDatesPtr);
+		return isl_stat_error;
+	}
+	
+	// A sample with every date would only repeat the exact evaluation
+	if (numSampled < 2 || numSampled >= numDates) {
+		isl_set_free(sampleDatesPtr);
+		return isl_stat_ok;
+	}
+	
+	sampleCost = malloc(numLattices * sizeof(unsigned long));
+	sampleMetrics = malloc(numLattices * sizeof(lattice_metrics));
+	estimate = malloc(numLattices * sizeof(double));
+	margin = malloc(numLattices * sizeof(double));
+	
+	if (sampleCost == NULL || sampleMetrics == NULL || estimate == NULL || margin == NULL) {
+		error(stream, "Memory allocation problem :(");
+		goto cleanup;
+	}
+	
+	info(stream, "Screening the lattices on %d sampled dates", numSampled);
+	
+	if (numWorkers > 1)
+		outcome = cost_function_compute_sharded(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, sampleDatesPtr, translatesPtr, numLattices, numBanks, memoryPtr, sampleCost, sampleMetrics, numWorkers, NULL);
+	else
+		outcome = cost_function_compute(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, sampleDatesPtr, translatesPtr, numLattices, numBanks, memoryPtr, sampleCost, sampleMetrics, NULL, NULL);
+	
+	// The exact evaluation runs the same phases again
+	phasePtr -> phase_num -= parallel_phases;
+	
+	if (outcome == isl_stat_error)
+		goto cleanup;
+	
+	for (int i = 0; i < numLattices; i++) {
+		
+		if (translatesPtr[i] == NULL)
+			continue;
+		
+		cost_estimate(sampleCost[i], &(sampleMetrics[i]), numSampled, numDates, &(estimate[i]), &(margin[i]));
+		
+		if (estimate[i] < bestEstimate) {
+			bestEstimate = estimate[i];
+			bestLatticeIdx = i;
+		}
+	}
+	
+	if (bestEstimate == INFINITY)
+		goto cleanup;
+	
+	// The best estimated lattice gives the bound: its exact cost
+	if (numWorkers > 1)
+		outcome = cost_function_compute_sharded(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearizedDatesPtr, &(translatesPtr[bestLatticeIdx]), 1, numBanks, memoryPtr, &exactCost, NULL, numWorkers, NULL);
+	else
+		outcome = cost_function_compute(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearizedDatesPtr, &(translatesPtr[bestLatticeIdx]), 1, numBanks, memoryPtr, &exactCost, NULL, NULL, NULL);
+	
+	phasePtr -> phase_num -= parallel_phases;
+	
+	if (outcome == isl_stat_error)
+		goto cleanup;
+	
+	fprintf(stream, "The lattice number %u has the best estimate, %.0f +- %.0f, and an exact cost of %lu\n", bestLatticeIdx, estimate[bestLatticeIdx], margin[bestLatticeIdx], exactCost);
+	
+	// The cost on the sample never exceeds the exact one, so no rejected lattice can beat the bound
+	for (int i = 0; i < numLattices; i++)
+		if (translatesPtr[i] != NULL && sampleCost[i] > exactCost) {
+			lattice_reject(translatesPtr, i, numBanks);
+			*survivorsPtr -= 1;
+		}
+	
+	info(stream, "%d lattices survived the screening", *survivorsPtr);
+
+cleanup:
+	isl_set_free(sampleDatesPtr);
+	free(sampleCost);
+	free(sampleMetrics);
+	free(estimate);
+	free(margin);
+	
+	return outcome;
+}
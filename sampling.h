@@ -0,0 +1,24 @@
+/*
+ * Definitions of the screening of the lattices on a stratified sample of the
+ * linearized dates. The lattices whose cost on the sample alone exceeds the
+ * exact cost of the best estimated lattice are rejected before the exact
+ * evaluation.
+ */
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include<stdio.h>
+
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+#include "ranking.h"
+
+void cost_estimate(unsigned long, lattice_metrics *, unsigned long, unsigned long, double *, double *);
+isl_set * sample_dates(isl_set *, unsigned long);
+isl_stat lattices_screen(FILE *, phase *, manipulated_polyhedral_model **, unsigned, isl_set *, isl_set ***, unsigned, unsigned, const memory_model *, unsigned long, unsigned, unsigned *);
+
+#endif /* SAMPLING_H */
@@ -0,0 +1,505 @@
+#ifdef MOREVERBOSE
+#define VERBOSE
+#endif
+/*
+ * Implementation of the long - lived analysis server. Queries are single lines
+ * received over a UNIX domain socket:
+ *   BEST <task> [<task> ...]	->	OK <lattice> <cost>
+ *   COSTS <task> [<task> ...]	->	OK <numLattices> <cost 0> <cost 1> ...
+ *   SHUTDOWN			->	OK
+ * Failures are answered with a line starting with ERROR.
+ */
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<signal.h>
+#include<unistd.h>
+#include<sys/socket.h>
+#include<sys/un.h>
+
+#include<pet.h>
+#include<isl/set.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+#include "partitioning.h"
+#include "server.h"
+
+#define MAXLINE 1024
+#define BACKLOG 16
+
+// Parsed polyhedral model of a task, shared by all the queries naming it
+typedef struct scop_entry {
+	char * name;
+	pet_scop * scop;
+	struct scop_entry * next;
+} scop_entry;
+
+// Lattice catalog for a given dimensionality of the address space
+typedef struct catalog_entry {
+	unsigned dim;
+	unsigned numLattices;
+	isl_set *** translatesPtr;
+	struct catalog_entry * next;
+} catalog_entry;
+
+// Linearized model and cost function values for a given ordered set of tasks
+typedef struct analysis_entry {
+	char * key;
+	unsigned numTasks;
+	manipulated_polyhedral_model ** modifiedPolyhedralModelPtr;
+	isl_set * linearizedDatesPtr;
+	unsigned numLattices;
+	unsigned long * cost;
+	unsigned bestLatticeIdx;
+	unsigned long bestCost;
+	struct analysis_entry * next;
+} analysis_entry;
+
+typedef struct {
+	FILE * stream;
+	isl_ctx * optionsHdl;
+	const architecture_config * archPtr;
+	scop_entry * scops;
+	catalog_entry * catalogs;
+	analysis_entry * analyses;
+} server_state;
+
+pet_scop * scop_lookup(server_state *, char *);
+catalog_entry * catalog_lookup(server_state *, unsigned);
+analysis_entry * analysis_lookup(server_state *, char **, unsigned);
+analysis_entry * analysis_build(server_state *, char **, unsigned, char *);
+int query_answer(server_state *, char *, FILE *);
+void server_state_free(server_state *);
+
+int serve(FILE * stream, isl_ctx * optionsHdl, const architecture_config * archPtr, const char * socketPath) {
+	// State of the server, with all the cached data
+	server_state state = { stream, optionsHdl, archPtr, NULL, NULL, NULL };
+	// Address of the listening socket
+	struct sockaddr_un address;
+	// Descriptor of the listening socket
+	int socketHdl = -1;
+	// Descriptor of the current connection
+	int connectionHdl = -1;
+	// Streams to read the queries from and to write the answers to
+	FILE * queryHdl = NULL;
+	FILE * answerHdl = NULL;
+	// Buffer for the current query
+	char line[MAXLINE];
+	// Whether the server must keep on answering
+	int running = 1;
+	
+	if (strlen(socketPath) >= sizeof(address.sun_path)) {
+		error(stream, "Socket path too long");
+		return -1;
+	}
+	
+	// A client disconnecting before reading its answer must not kill the server
+	signal(SIGPIPE, SIG_IGN);
+	
+	socketHdl = socket(AF_UNIX, SOCK_STREAM, 0);
+	
+	if (socketHdl < 0) {
+		error(stream, "Cannot create the socket");
+		return -1;
+	}
+	
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath);
+	unlink(socketPath);
+	
+	if (bind(socketHdl, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(socketHdl, BACKLOG) < 0) {
+		error(stream, "Cannot listen on the socket");
+		close(socketHdl);
+		return -1;
+	}
+	
+	fprintf(stream, "Listening on %s\n", socketPath);
+	fflush(stream);
+	
+	while (running) {
+		connectionHdl = accept(socketHdl, NULL, NULL);
+		
+		if (connectionHdl < 0) {
+			if (errno == EINTR)
+				continue;
+			
+			error(stream, "Cannot accept a connection");
+			break;
+		}
+		
+		queryHdl = fdopen(connectionHdl, "r");
+		answerHdl = fdopen(dup(connectionHdl), "w");
+		
+		if (queryHdl == NULL || answerHdl == NULL) {
+			error(stream, "Cannot open the connection streams");
+			
+			if (queryHdl != NULL)
+				fclose(queryHdl);
+			else
+				close(connectionHdl);
+			
+			if (answerHdl != NULL)
+				fclose(answerHdl);
+			
+			continue;
+		}
+		
+		// A connection may carry several queries, one per line
+		while (running && fgets(line, MAXLINE, queryHdl) != NULL) {
+			running = query_answer(&state, line, answerHdl);
+			fflush(answerHdl);
+		}
+		
+		fclose(answerHdl);
+		fclose(queryHdl);
+	}
+	
+	close(socketHdl);
+	unlink(socketPath);
+	server_state_free(&state);
+	
+	return 0;
+}
+
+int query_answer(server_state * state, char * line, FILE * answerHdl) {
+	// Array of the task names in the query
+	char * tasks[MAXLINE / 2];
+	// Number of tasks in the query
+	unsigned numTasks = 0;
+	// Current token of the query
+	char * token = NULL;
+	// State of the tokenizer
+	char * savePtr = NULL;
+	// Command of the query
+	char * command = NULL;
+	// Cached analysis of the tasks
+	analysis_entry * entry = NULL;
+	
+	command = strtok_r(line, " \t\r\n", &savePtr);
+	
+	if (command == NULL) {
+		fprintf(answerHdl, "ERROR empty query\n");
+		return 1;
+	}
+	
+	if (strcmp(command, "SHUTDOWN") == 0) {
+		fprintf(answerHdl, "OK\n");
+		return 0;
+	}
+	
+	if (strcmp(command, "BEST") != 0 && strcmp(command, "COSTS") != 0) {
+		fprintf(answerHdl, "ERROR unknown command %s\n", command);
+		return 1;
+	}
+	
+	while ((token = strtok_r(NULL, " \t\r\n", &savePtr)) != NULL)
+		tasks[numTasks++] = token;
+	
+	if (numTasks == 0) {
+		fprintf(answerHdl, "ERROR no tasks given\n");
+		return 1;
+	}
+	
+	if (numTasks > state -> archPtr -> maxTasks) {
+		fprintf(answerHdl, "ERROR at most %u tasks are supported\n", state -> archPtr -> maxTasks);
+		return 1;
+	}
+	
+	entry = analysis_lookup(state, tasks, numTasks);
+	
+	if (entry == NULL) {
+		fprintf(answerHdl, "ERROR analysis failed\n");
+		return 1;
+	}
+	
+	if (strcmp(command, "BEST") == 0)
+		fprintf(answerHdl, "OK %u %lu\n", entry -> bestLatticeIdx, entry -> bestCost);
+	else {
+		fprintf(answerHdl, "OK %u", entry -> numLattices);
+		
+		for (int i = 0; i < entry -> numLattices; i++)
+			fprintf(answerHdl, " %lu", entry -> cost[i]);
+		
+		fprintf(answerHdl, "\n");
+	}
+	
+	return 1;
+}
+
+pet_scop * scop_lookup(server_state * state, char * name) {
+	// Entry of the cache being examined or built
+	scop_entry * entry = NULL;
+	
+	for (entry = state -> scops; entry != NULL; entry = entry -> next)
+		if (strcmp(entry -> name, name) == 0)
+			return entry -> scop;
+	
+	entry = malloc(sizeof(scop_entry));
+	
+	if (entry == NULL) {
+		error(state -> stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	entry -> name = strdup(name);
+	
+	if (entry -> name == NULL || parse_input(state -> stream, state -> optionsHdl, state -> archPtr, &(entry -> name), &(entry -> scop), 1) == isl_stat_error) {
+		free(entry -> name);
+		free(entry);
+		return NULL;
+	}
+	
+	entry -> next = state -> scops;
+	state -> scops = entry;
+	
+	return entry -> scop;
+}
+
+catalog_entry * catalog_lookup(server_state * state, unsigned dim) {
+	// Entry of the cache being examined or built
+	catalog_entry * entry = NULL;
+	
+	for (entry = state -> catalogs; entry != NULL; entry = entry -> next)
+		if (entry -> dim == dim)
+			return entry;
+	
+	entry = malloc(sizeof(catalog_entry));
+	
+	if (entry == NULL) {
+		error(state -> stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	entry -> dim = dim;
+	entry -> translatesPtr = parse_lattices(state -> stream, state -> optionsHdl, state -> archPtr, &(entry -> numLattices), dim);
+	
+	if (entry -> translatesPtr == NULL) {
+		free(entry);
+		return NULL;
+	}
+	
+	entry -> next = state -> catalogs;
+	state -> catalogs = entry;
+	
+	return entry;
+}
+
+analysis_entry * analysis_lookup(server_state * state, char ** tasks, unsigned numTasks) {
+	// Entry of the cache being examined
+	analysis_entry * entry = NULL;
+	// Key of the query, i.e. the ordered task names
+	char * key = NULL;
+	// Length of the key
+	size_t keyLength = 0;
+	
+	for (int i = 0; i < numTasks; i++)
+		keyLength += strlen(tasks[i]) + 1;
+	
+	key = malloc(keyLength);
+	
+	if (key == NULL) {
+		error(state -> stream, "Memory allocation problem :(");
+		return NULL;
+	}
+	
+	key[0] = '\0';
+	
+	for (int i = 0; i < numTasks; i++) {
+		if (i > 0)
+			strcat(key, " ");
+		
+		strcat(key, tasks[i]);
+	}
+	
+	for (entry = state -> analyses; entry != NULL; entry = entry -> next)
+		if (strcmp(entry -> key, key) == 0) {
+			free(key);
+			return entry;
+		}
+	
+	entry = analysis_build(state, tasks, numTasks, key);
+	
+	if (entry == NULL)
+		free(key);
+	
+	return entry;
+}
+
+analysis_entry * analysis_build(server_state * state, char ** tasks, unsigned numTasks, char * key) {
+	// Pointer to the current phase, used for graphical purposes
+	phase * phasePtr = NULL;
+	// Entry being built
+	analysis_entry * entry = NULL;
+	// Array of the original polyhedral models of each task
+	pet_scop ** polyhedralModelPtr = NULL;
+	// Lattice catalog for the address space of the tasks
+	catalog_entry * catalog = NULL;
+	// Dimensionality of the address space
+	unsigned dimAddressSpace = 0;
+	
+	phasePtr = start(state -> stream);
+	entry = malloc(sizeof(analysis_entry));
+	polyhedralModelPtr = malloc(numTasks * sizeof(pet_scop *));
+	
+	if (phasePtr == NULL || entry == NULL || polyhedralModelPtr == NULL) {
+		error(state -> stream, "Memory allocation problem :(");
+		free(polyhedralModelPtr);
+		free(entry);
+		phase_free(phasePtr);
+		return NULL;
+	}
+	
+	entry -> key = key;
+	entry -> numTasks = numTasks;
+	entry -> modifiedPolyhedralModelPtr = NULL;
+	entry -> linearizedDatesPtr = NULL;
+	entry -> cost = NULL;
+	
+	// 1) Only the tasks never seen before are parsed
+	for (int i = 0; i < numTasks; i++) {
+		polyhedralModelPtr[i] = scop_lookup(state, tasks[i]);
+		
+		if (polyhedralModelPtr[i] == NULL) {
+			error(state -> stream, "Error during parsing input files");
+			goto failure;
+		}
+	}
+	
+	complete_phase(state -> stream, phasePtr);
+	
+	// 2) Virtual memory allocation
+	new_phase(state -> stream, phasePtr);
+	
+	entry -> modifiedPolyhedralModelPtr = manipulated_polyhedral_model_array_alloc(numTasks);
+	
+	if (entry -> modifiedPolyhedralModelPtr == NULL) {
+		error(state -> stream, "Memory allocation problem :(");
+		goto failure;
+	}
+	
+	if (virtual_allocation(state -> stream, state -> optionsHdl, polyhedralModelPtr, entry -> modifiedPolyhedralModelPtr, numTasks, &dimAddressSpace, &defaultPlacement) == isl_stat_error) {
+		error(state -> stream, "Error during virtual address space allocation");
+		goto failure;
+	}
+	
+	// 3) The lattices are read only once for each dimensionality
+	new_phase(state -> stream, phasePtr);
+	
+	catalog = catalog_lookup(state, dimAddressSpace);
+	
+	if (catalog == NULL) {
+		error(state -> stream, "Error during parsing lattices :(");
+		goto failure;
+	}
+	
+	complete_phase(state -> stream, phasePtr);
+	
+	// 4) Building the physical schedule
+	new_phase(state -> stream, phasePtr);
+	
+	if (physical_schedule(state -> stream, state -> optionsHdl, state -> archPtr, polyhedralModelPtr, entry -> modifiedPolyhedralModelPtr, numTasks) == isl_stat_error) {
+		error(state -> stream, "Error during physical schedule building");
+		goto failure;
+	}
+	
+	complete_phase(state -> stream, phasePtr);
+	
+	// 5) Building the linearized schedule
+	new_phase(state -> stream, phasePtr);
+	
+	if (eliminate_parameters(state -> stream, state -> archPtr, polyhedralModelPtr, entry -> modifiedPolyhedralModelPtr, numTasks) == isl_stat_error) {
+		error(state -> stream, "Error during parameter projection out");
+		goto failure;
+	}
+	
+	if (linearize_dates(state -> stream, entry -> modifiedPolyhedralModelPtr, numTasks) == isl_stat_error) {
+		error(state -> stream, "Error during dates linearization");
+		goto failure;
+	}
+	
+	entry -> linearizedDatesPtr = linearized_dates_union(state -> stream, entry -> modifiedPolyhedralModelPtr, numTasks);
+	
+	if (entry -> linearizedDatesPtr == NULL) {
+		error(state -> stream, "Error during dates union");
+		goto failure;
+	}
+	
+	complete_phase(state -> stream, phasePtr);
+	
+	// 6) - 8) Concurrent part, for each one of the linearized dates
+	entry -> numLattices = catalog -> numLattices;
+	entry -> cost = malloc(catalog -> numLattices * sizeof(unsigned long));
+	
+	if (entry -> cost == NULL) {
+		error(state -> stream, "Memory allocation problem :(");
+		goto failure;
+	}
+	
+	if (cost_function_compute(state -> stream, phasePtr, entry -> modifiedPolyhedralModelPtr, numTasks, entry -> linearizedDatesPtr, catalog -> translatesPtr, catalog -> numLattices, state -> archPtr -> numBanks, &(state -> archPtr -> memory), entry -> cost, NULL, NULL, NULL) == isl_stat_error) {
+		error(state -> stream, "Error during the concurrent part");
+		goto failure;
+	}
+	
+	// 9) Cost function evaluation
+	new_phase(state -> stream, phasePtr);
+	
+	entry -> bestLatticeIdx = best_lattice(state -> stream, entry -> cost, entry -> numLattices, &(entry -> bestCost));
+	
+	complete_phase(state -> stream, phasePtr);
+	
+	entry -> next = state -> analyses;
+	state -> analyses = entry;
+	
+	// Be clean
+	free(polyhedralModelPtr);
+	phase_free(phasePtr);
+	
+	return entry;
+
+failure:
+	fail_phase(state -> stream, phasePtr);
+	
+	isl_set_free(entry -> linearizedDatesPtr);
+	
+	if (entry -> modifiedPolyhedralModelPtr != NULL)
+		manipulated_polyhedral_model_array_free(entry -> modifiedPolyhedralModelPtr, numTasks);
+	
+	free(entry -> cost);
+	free(entry);
+	free(polyhedralModelPtr);
+	phase_free(phasePtr);
+	
+	return NULL;
+}
+
+void server_state_free(server_state * state) {
+	// Entries being released
+	scop_entry * scop = NULL;
+	catalog_entry * catalog = NULL;
+	analysis_entry * analysis = NULL;
+	
+	while ((analysis = state -> analyses) != NULL) {
+		state -> analyses = analysis -> next;
+		isl_set_free(analysis -> linearizedDatesPtr);
+		manipulated_polyhedral_model_array_free(analysis -> modifiedPolyhedralModelPtr, analysis -> numTasks);
+		free(analysis -> cost);
+		free(analysis -> key);
+		free(analysis);
+	}
+	
+	while ((catalog = state -> catalogs) != NULL) {
+		state -> catalogs = catalog -> next;
+		lattices_free(catalog -> translatesPtr, catalog -> numLattices, state -> archPtr -> numBanks);
+		free(catalog);
+	}
+	
+	while ((scop = state -> scops) != NULL) {
+		state -> scops = scop -> next;
+		pet_scop_free(scop -> scop);
+		free(scop -> name);
+		free(scop);
+	}
+}
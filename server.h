@@ -0,0 +1,18 @@
+/*
+ * Definitions of the long - lived analysis server, which keeps the parsed
+ * models, the linearized schedules and the lattice catalogs in memory and
+ * answers queries over a UNIX domain socket
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include<stdio.h>
+
+#include<isl/ctx.h>
+
+#include "config.h"
+
+int serve(FILE *, isl_ctx *, const architecture_config *, const char *);
+
+#endif /* SERVER_H */
@@ -0,0 +1,232 @@
+/*
+ * Implementation of the evaluation of the cost function split across worker
+ * processes. The coordinator forks once the linearized dates are known, so
+ * every worker inherits its own copy of the isl context and of the models;
+ * each one evaluates a contiguous range of dates and accumulates the costs in
+ * its own slot of an anonymous shared mapping, which the coordinator reduces.
+ */
+#include<stdlib.h>
+#include<limits.h>
+#include<string.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/types.h>
+#include<sys/wait.h>
+
+#include<isl/set.h>
+#include<isl/val.h>
+
+#include "config.h"
+#include "support.h"
+#include "model.h"
+#include "partitioning.h"
+
+// Number of phases performed for each one of the linearized dates
+extern const unsigned parallel_phases;
+
+// Result of a worker, written in the shared mapping before it exits
+typedef struct {
+	isl_stat outcome;
+	run_statistics stats;
+} shard_slot;
+
+void shard_run(FILE *, phase *, manipulated_polyhedral_model **, unsigned, isl_set *, isl_set ***, unsigned, unsigned, const memory_model *, shard_slot *, unsigned long *, lattice_metrics *, result_export *);
+void shard_statistics_merge(run_statistics *, run_statistics *, unsigned);
+
+isl_stat cost_function_compute_sharded (FILE * stream, phase * phasePtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set * linearizedDatesPtr, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, const memory_model * memoryPtr, unsigned long * cost, lattice_metrics * metrics, unsigned numWorkers, result_export * exportPtr) {
+	// Smallest and largest linearized dates
+	isl_val * boundVal = NULL;
+	// First linearized date
+	long firstDate = 0;
+	// Number of linearized dates between the first and the last one
+	long numDates = 0;
+	// Shared mapping with the slots of the workers followed by their costs
+	void * sharedPtr = NULL;
+	// Size of the shared mapping
+	size_t sharedSize = 0;
+	// Slots of the workers
+	shard_slot * slots = NULL;
+	// Costs of the workers, numLattices per worker
+	unsigned long * shardCost = NULL;
+	// Metrics of the workers, numLattices per worker
+	lattice_metrics * shardMetrics = NULL;
+	// Identifiers of the workers
+	pid_t * workers = NULL;
+	// Dates of a worker
+	isl_set * shardDatesPtr = NULL;
+	// Exit status of a worker
+	int status = 0;
+	// Result of a subroutine
+	isl_stat outcome = isl_stat_ok;
+	// Whether there is no date to evaluate
+	isl_bool empty = isl_bool_false;
+	
+	empty = isl_set_is_empty(linearizedDatesPtr);
+	
+	if (empty == isl_bool_error) {
+		error(stream, "Error during the split of the dates");
+		return isl_stat_error;
+	}
+	
+	// Without dates there are no bounds to split, and no worker to start
+	if (empty == isl_bool_true) {
+		for (int i = 0; i < numLattices; i++)
+			cost[i] = translatesPtr[i] != NULL ? 0 : ULONG_MAX;
+		
+		if (metrics != NULL)
+			memset(metrics, 0, numLattices * sizeof(lattice_metrics));
+		
+		phasePtr -> phase_num += parallel_phases;
+		return isl_stat_ok;
+	}
+	
+	// The linearized dates are integers, so they are split by value
+	boundVal = isl_set_dim_min_val(isl_set_copy(linearizedDatesPtr), 0);
+	firstDate = isl_val_get_num_si(boundVal);
+	isl_val_free(boundVal);
+	boundVal = isl_set_dim_max_val(isl_set_copy(linearizedDatesPtr), 0);
+	numDates = isl_val_get_num_si(boundVal) - firstDate + 1;
+	isl_val_free(boundVal);
+	
+	if (numDates < numWorkers)
+		numWorkers = numDates > 0 ? numDates : 1;
+	
+	sharedSize = numWorkers * (sizeof(shard_slot) + numLattices * (sizeof(lattice_metrics) + sizeof(unsigned long)));
+	sharedPtr = mmap(NULL, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	workers = calloc(numWorkers, sizeof(pid_t));
+	
+	if (sharedPtr == MAP_FAILED || workers == NULL) {
+		error(stream, "Memory allocation problem for the workers :(");
+		
+		if (sharedPtr != MAP_FAILED)
+			munmap(sharedPtr, sharedSize);
+		
+		free(workers);
+		return isl_stat_error;
+	}
+	
+	slots = (shard_slot *)sharedPtr;
+	shardMetrics = (lattice_metrics *)(slots + numWorkers);
+	shardCost = (unsigned long *)(shardMetrics + numWorkers * numLattices);
+	
+	info(stream, "Evaluating the dates with %d workers", numWorkers);
+	
+	// Whatever is buffered would otherwise be written once per worker
+	fflush(stream);
+	
+	for (int w = 0; w < numWorkers; w++) {
+		slots[w].outcome = isl_stat_error;
+		shardDatesPtr = shard_dates(linearizedDatesPtr, firstDate + numDates * w / numWorkers, firstDate + numDates * (w + 1) / numWorkers - 1);
+		
+		if (shardDatesPtr == NULL) {
+			error(stream, "Error during the split of the dates");
+			outcome = isl_stat_error;
+			break;
+		}
+		
+		workers[w] = fork();
+		
+		if (workers[w] == 0)
+			shard_run(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, shardDatesPtr, translatesPtr, numLattices, numBanks, memoryPtr, &(slots[w]), shardCost + w * numLattices, metrics != NULL ? shardMetrics + w * numLattices : NULL, exportPtr);
+		
+		isl_set_free(shardDatesPtr);
+		
+		if (workers[w] < 0) {
+			error(stream, "Cannot start a worker");
+			outcome = isl_stat_error;
+			break;
+		}
+	}
+	
+	// Every worker started is waited for, even after a failure
+	for (int w = 0; w < numWorkers; w++) {
+		if (workers[w] <= 0)
+			continue;
+		
+		if (waitpid(workers[w], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || slots[w].outcome != isl_stat_ok) {
+			error(stream, "A worker failed during the concurrent part");
+			outcome = isl_stat_error;
+		}
+	}
+	
+	phasePtr -> phase_num += parallel_phases;
+	
+	if (outcome == isl_stat_ok) {
+		for (int i = 0; i < numLattices; i++) {
+			cost[i] = translatesPtr[i] != NULL ? 0 : ULONG_MAX;
+			
+			for (int w = 0; w < numWorkers && translatesPtr[i] != NULL; w++)
+				cost[i] += shardCost[w * numLattices + i];
+		}
+		
+		if (metrics != NULL) {
+			memset(metrics, 0, numLattices * sizeof(lattice_metrics));
+			
+			for (int w = 0; w < numWorkers; w++)
+				for (int i = 0; i < numLattices; i++)
+					lattice_metrics_merge(&(metrics[i]), &(shardMetrics[w * numLattices + i]));
+		}
+		
+		for (int w = 0; w < numWorkers; w++)
+			shard_statistics_merge(phasePtr -> statsPtr, &(slots[w].stats), phasePtr -> phase_num - parallel_phases);
+	}
+	
+	// Be clean
+	munmap(sharedPtr, sharedSize);
+	free(workers);
+	
+	return outcome;
+}
+
+isl_set * shard_dates(isl_set * linearizedDatesPtr, long firstDate, long lastDate) {
+	// Dates of the shard
+	isl_set * shardDatesPtr = isl_set_copy(linearizedDatesPtr);
+	
+	shardDatesPtr = isl_set_lower_bound_si(shardDatesPtr, isl_dim_set, 0, firstDate);
+	shardDatesPtr = isl_set_upper_bound_si(shardDatesPtr, isl_dim_set, 0, lastDate);
+	
+	return shardDatesPtr;
+}
+
+void shard_run(FILE * stream, phase * phasePtr, manipulated_polyhedral_model ** modifiedPolyhedralModelPtr, unsigned numTasks, isl_set * shardDatesPtr, isl_set *** translatesPtr, unsigned numLattices, unsigned numBanks, const memory_model * memoryPtr, shard_slot * slotPtr, unsigned long * cost, lattice_metrics * metrics, result_export * exportPtr) {
+	// Result of the evaluation
+	isl_stat outcome = isl_stat_ok;
+	
+	// The lines of several workers would interleave
+	phasePtr -> progressPtr = NULL;
+	
+	// The statistics inherited from the coordinator are already counted there, only those of the shard are sent back
+	phasePtr -> statsPtr -> dates = 0;
+	phasePtr -> statsPtr -> points = 0;
+	phasePtr -> statsPtr -> lattices = 0;
+	
+	for (int i = phasePtr -> phase_num; i < phasePtr -> phase_num + parallel_phases && i < NUMPHASES; i++)
+		memset(&(phasePtr -> statsPtr -> records[i]), 0, sizeof(phase_record));
+	
+	outcome = cost_function_compute(stream, phasePtr, modifiedPolyhedralModelPtr, numTasks, shardDatesPtr, translatesPtr, numLattices, numBanks, memoryPtr, cost, metrics, NULL, exportPtr);
+	
+	slotPtr -> stats = *phasePtr -> statsPtr;
+	slotPtr -> outcome = outcome;
+	
+	fflush(stream);
+	
+	// The handlers registered at exit belong to the coordinator
+	_exit(outcome == isl_stat_ok ? 0 : 1);
+}
+
+void shard_statistics_merge(run_statistics * statsPtr, run_statistics * shardStatsPtr, unsigned firstPhase) {
+	
+	statsPtr -> dates += shardStatsPtr -> dates;
+	statsPtr -> points += shardStatsPtr -> points;
+	statsPtr -> lattices += shardStatsPtr -> lattices;
+	
+	// Only the phases of the dates ran in the workers
+	for (int i = firstPhase; i < firstPhase + parallel_phases && i < NUMPHASES; i++) {
+		statsPtr -> records[i].runs += shardStatsPtr -> records[i].runs;
+		statsPtr -> records[i].wallTime += shardStatsPtr -> records[i].wallTime;
+		statsPtr -> records[i].cpuTime += shardStatsPtr -> records[i].cpuTime;
+		
+		if (shardStatsPtr -> records[i].peakRss > statsPtr -> records[i].peakRss)
+			statsPtr -> records[i].peakRss = shardStatsPtr -> records[i].peakRss;
+	}
+}
@@ -3,10 +3,47 @@
  * helper functions
  */
 #include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<pthread.h>
+#include<malloc.h>
+#include<sys/resource.h>
 
 #include "support.h"
 #include "colours.h"
 
+#define ASYNCBUFFER (1 << 16)
+#define ASYNCPIPE (1 << 20)
+// Lattices whose per - date profile is exported by default
+#define DEFAULTEXPORTTOP 5
+// Workers allowed per online processor
+#define WORKERSPERPROCESSOR 4
+// Largest start offset searched, every combination of the tasks being evaluated
+#define MAXOFFSET 1024
+// Largest budget of processors, every vector within it being evaluated
+#define MAXPROCESSORS 256
+// Largest sample of dates for the screening
+#define MAXSAMPLES (1 << 20)
+// Largest shift of the placements, each one being a full evaluation of the catalog
+#define MAXPLACEMENTOFFSET 64
+// Largest number of lattices printed by the ranking
+#define MAXRANK (1 << 16)
+// Largest number of lattices whose per - date profile is exported
+#define MAXEXPORTTOP 1024
+
+// Asynchronous log: the stream written by the program is a pipe drained into the sink by a thread
+typedef struct {
+	FILE * stream;
+	FILE * sink;
+	int readHdl;
+	pthread_t thread;
+	unsigned active;
+	unsigned registered;
+} async_log;
+
 const char * phaseNames[] = {
 	"Reading input files",
 	"Virtual address space allocation",
@@ -19,10 +56,38 @@ const char * phaseNames[] = {
 	"Cost function evaluation"
 };
 
+// There is at most one asynchronous log per process, drained at exit if still open
+async_log asyncLog;
+
+void phase_open(phase *);
+void phase_close(phase *);
+void * async_log_drain(void *);
+void async_log_atexit(void);
+int count_parse(const char *, unsigned long, unsigned long, unsigned *);
+
 phase * start (FILE * stream) {
 	
 	phase * newPhase = malloc(sizeof(phase));
+	
+	if (newPhase == NULL)
+		return NULL;
+	
+	newPhase -> statsPtr = calloc(1, sizeof(run_statistics));
+	
+	if (newPhase -> statsPtr == NULL) {
+		free(newPhase);
+		return NULL;
+	}
+	
 	newPhase -> phase_num = 0;
+	newPhase -> running = 0;
+	newPhase -> quiet = 0;
+	newPhase -> quietDates = 0;
+	newPhase -> checkMemory = 0;
+	newPhase -> progressPtr = NULL;
+	newPhase -> statsPtr -> wallStart = wall_clock();
+	newPhase -> statsPtr -> cpuStart = cpu_clock();
+	phase_open(newPhase);
 	
 	__SET_MAGENTA
 	fprintf(stream, "Step %d) - %s", (newPhase -> phase_num) + 1, phaseNames[newPhase -> phase_num]);
@@ -34,7 +99,13 @@ phase * start (FILE * stream) {
 
 void new_phase (FILE * stream, phase * phasePtr) {
 	
+	// A phase not explicitly completed ends when the next one begins
+	phase_close(phasePtr);
 	phasePtr -> phase_num += 1;
+	phase_open(phasePtr);
+	
+	if (phasePtr -> quiet)
+		return;
 	
 	__SET_MAGENTA
 	fprintf(stream, "Step %d) - %s", (phasePtr -> phase_num) + 1, phaseNames[phasePtr -> phase_num]);
@@ -44,6 +115,11 @@ void new_phase (FILE * stream, phase * phasePtr) {
 
 void complete_phase (FILE * stream, phase * phasePtr) {
 	
+	phase_close(phasePtr);
+	
+	if (phasePtr -> quiet)
+		return;
+	
 	__SET_MAGENTA
 	fprintf(stream, "Step %d) - %s - ", (phasePtr -> phase_num) + 1, phaseNames[phasePtr -> phase_num]);
 	__SET_GREEN
@@ -53,7 +129,9 @@ void complete_phase (FILE * stream, phase * phasePtr) {
 }
 
 
-void abort_phase (FILE * stream, phase * phasePtr) {
+void fail_phase (FILE * stream, phase * phasePtr) {
+	
+	phase_close(phasePtr);
 	
 	__SET_MAGENTA
 	fprintf(stream, "Step %d) - %s - ", (phasePtr -> phase_num) + 1, phaseNames[phasePtr -> phase_num]);
@@ -61,8 +139,14 @@ void abort_phase (FILE * stream, phase * phasePtr) {
 	fprintf(stream, "Failed");
 	__SET_DEFAULT
 	fprintf(stream, "\n");
+	fflush(stream);
+}
+
+void abort_phase (FILE * stream, phase * phasePtr) {
 	
-	free(phasePtr);
+	fail_phase(stream, phasePtr);
+	
+	phase_free(phasePtr);
 	exit(-1);	
 }
 
@@ -102,9 +186,422 @@ void finish (FILE * stream, phase * phasePtr) {
 	__SET_DEFAULT
 	fprintf(stream, "\n");
 	
-	free(phasePtr);
+	phase_free(phasePtr);
+	
+	if (asyncLog.active && stream == asyncLog.stream)
+		stream = async_log_close();
 	
 	if(stream != stdout)
 		fclose(stream);
 	exit(0);
 } 
+
+// A count is a whole decimal number between the two bounds, with nothing after it
+int count_parse(const char * text, unsigned long minCount, unsigned long maxCount, unsigned * countPtr) {
+	// First character not converted
+	char * endPtr = NULL;
+	// Value read
+	unsigned long count = 0;
+	
+	// strtoul would silently negate a leading minus sign
+	if (strchr(text, '-') != NULL)
+		return -1;
+	
+	errno = 0;
+	count = strtoul(text, &endPtr, 10);
+	
+	if (errno != 0 || endPtr == text || *endPtr != '\0' || count < minCount || count > maxCount)
+		return -1;
+	
+	*countPtr = count;
+	
+	return 0;
+}
+
+int parse_options (int argc, char ** argv, run_options * optionsPtr) {
+	// Number of command - line arguments consumed by the options
+	int consumed = 0;
+	// Processors online, which bound the number of workers
+	long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+	// Count read from the command line, before its conversion
+	unsigned count = 0;
+	
+	if (numProcessors < 1)
+		numProcessors = 1;
+	
+	optionsPtr -> socketPath = NULL;
+	optionsPtr -> reportPath = NULL;
+	optionsPtr -> archPath = NULL;
+	optionsPtr -> quiet = 0;
+	optionsPtr -> progress = 0;
+	optionsPtr -> asyncLog = 0;
+	optionsPtr -> checkMemory = 0;
+	optionsPtr -> checkpointPath = NULL;
+	optionsPtr -> resume = 0;
+	optionsPtr -> workers = 1;
+	optionsPtr -> exportPath = NULL;
+	optionsPtr -> exportTop = DEFAULTEXPORTTOP;
+	optionsPtr -> codegenPath = NULL;
+	optionsPtr -> rank = 0;
+	optionsPtr -> objective = NULL;
+	optionsPtr -> screen = 0;
+	optionsPtr -> timeBudget = 0;
+	optionsPtr -> bankCounts = NULL;
+	optionsPtr -> maxOffset = 0;
+	optionsPtr -> processorBudget = 0;
+	optionsPtr -> placementSearch = 0;
+	optionsPtr -> placementOffset = 0;
+	optionsPtr -> mergeAccesses = 0;
+	
+	for (int i = 1; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+		
+		if (strcmp(argv[i], "--server") == 0 && i + 1 < argc) {
+			optionsPtr -> socketPath = argv[++i];
+		} else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+			optionsPtr -> reportPath = argv[++i];
+		} else if (strcmp(argv[i], "--arch") == 0 && i + 1 < argc) {
+			optionsPtr -> archPath = argv[++i];
+		} else if (strcmp(argv[i], "--quiet") == 0) {
+			optionsPtr -> quiet = 1;
+		} else if (strcmp(argv[i], "--progress") == 0) {
+			optionsPtr -> quiet = 1;
+			optionsPtr -> progress = 1;
+		} else if (strcmp(argv[i], "--async-log") == 0) {
+			optionsPtr -> asyncLog = 1;
+		} else if (strcmp(argv[i], "--check-memory") == 0) {
+			optionsPtr -> checkMemory = 1;
+		} else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+			optionsPtr -> checkpointPath = argv[++i];
+		} else if (strcmp(argv[i], "--resume") == 0) {
+			optionsPtr -> resume = 1;
+		} else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+			optionsPtr -> exportPath = argv[++i];
+		} else if (strcmp(argv[i], "--export-top") == 0 && i + 1 < argc) {
+			if (count_parse(argv[++i], 0, MAXEXPORTTOP, &(optionsPtr -> exportTop)) < 0)
+				return -1;
+		} else if (strcmp(argv[i], "--codegen") == 0 && i + 1 < argc) {
+			optionsPtr -> codegenPath = argv[++i];
+		} else if (strcmp(argv[i], "--rank") == 0 && i + 1 < argc) {
+			if (count_parse(argv[++i], 1, MAXRANK, &(optionsPtr -> rank)) < 0)
+				return -1;
+		} else if (strcmp(argv[i], "--objective") == 0 && i + 1 < argc) {
+			optionsPtr -> objective = argv[++i];
+		} else if (strcmp(argv[i], "--screen") == 0 && i + 1 < argc) {
+			if (count_parse(argv[++i], 1, MAXSAMPLES, &count) < 0)
+				return -1;
+			
+			optionsPtr -> screen = count;
+		} else if (strcmp(argv[i], "--time-budget") == 0 && i + 1 < argc) {
+			optionsPtr -> timeBudget = atof(argv[++i]);
+			
+			if (optionsPtr -> timeBudget <= 0)
+				return -1;
+		} else if (strcmp(argv[i], "--banks") == 0 && i + 1 < argc) {
+			optionsPtr -> bankCounts = argv[++i];
+		} else if (strcmp(argv[i], "--offsets") == 0 && i + 1 < argc) {
+			if (count_parse(argv[++i], 1, MAXOFFSET, &(optionsPtr -> maxOffset)) < 0)
+				return -1;
+		} else if (strcmp(argv[i], "--processors") == 0 && i + 1 < argc) {
+			if (count_parse(argv[++i], 1, MAXPROCESSORS, &(optionsPtr -> processorBudget)) < 0)
+				return -1;
+		} else if (strcmp(argv[i], "--placement") == 0 && i + 1 < argc) {
+			optionsPtr -> placementSearch = 1;
+			
+			if (count_parse(argv[++i], 0, MAXPLACEMENTOFFSET, &(optionsPtr -> placementOffset)) < 0)
+				return -1;
+		} else if (strcmp(argv[i], "--merge-accesses") == 0) {
+			optionsPtr -> mergeAccesses = 1;
+		} else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+			if (count_parse(argv[++i], 1, numProcessors * WORKERSPERPROCESSOR, &(optionsPtr -> workers)) < 0)
+				return -1;
+		} else
+			return -1;
+		
+		consumed = i;
+	}
+	
+	return consumed;
+}
+
+void phase_free (phase * phasePtr) {
+	
+	if (phasePtr == NULL)
+		return;
+	
+	free(phasePtr -> statsPtr);
+	free(phasePtr);
+}
+
+void phase_open (phase * phasePtr) {
+	
+	phasePtr -> running = 1;
+	phasePtr -> wallStart = wall_clock();
+	phasePtr -> cpuStart = cpu_clock();
+	
+	if (phasePtr -> checkMemory)
+		phasePtr -> heapStart = heap_in_use();
+}
+
+void phase_close (phase * phasePtr) {
+	// Record of the phase being closed
+	phase_record * recordPtr = NULL;
+	// Peak resident set size up to now
+	long rss = 0;
+	
+	if (phasePtr -> running == 0 || phasePtr -> phase_num >= NUMPHASES)
+		return;
+	
+	recordPtr = &(phasePtr -> statsPtr -> records[phasePtr -> phase_num]);
+	
+	recordPtr -> runs += 1;
+	recordPtr -> wallTime += wall_clock() - phasePtr -> wallStart;
+	recordPtr -> cpuTime += cpu_clock() - phasePtr -> cpuStart;
+	
+	rss = peak_rss();
+	
+	if (rss > recordPtr -> peakRss)
+		recordPtr -> peakRss = rss;
+	
+	if (phasePtr -> checkMemory) {
+		recordPtr -> heapInUse = heap_in_use();
+		recordPtr -> heapGrowth += recordPtr -> heapInUse - phasePtr -> heapStart;
+	}
+	
+	phasePtr -> running = 0;
+}
+
+isl_stat report_write (FILE * reportHdl, phase * phasePtr) {
+	// Statistics of the run
+	run_statistics * statsPtr = phasePtr -> statsPtr;
+	
+	// One phase per line, so that the report can also be processed by line - oriented tools
+	fprintf(reportHdl, "{\n\t\"phases\": [\n");
+	
+	for (int i = 0; i < NUMPHASES; i++)
+		fprintf(reportHdl, "\t\t{\"step\": %d, \"name\": \"%s\", \"runs\": %lu, \"wall_seconds\": %.6f, \"cpu_seconds\": %.6f, \"peak_rss_kb\": %ld}%s\n",
+			i + 1, phaseNames[i], statsPtr -> records[i].runs, statsPtr -> records[i].wallTime, statsPtr -> records[i].cpuTime, statsPtr -> records[i].peakRss, i + 1 < NUMPHASES ? "," : "");
+	
+	fprintf(reportHdl, "\t],\n");
+	fprintf(reportHdl, "\t\"dates\": %lu,\n", statsPtr -> dates);
+	fprintf(reportHdl, "\t\"points\": %lu,\n", statsPtr -> points);
+	fprintf(reportHdl, "\t\"lattices\": %lu,\n", statsPtr -> lattices);
+	fprintf(reportHdl, "\t\"wall_seconds\": %.6f,\n", wall_clock() - statsPtr -> wallStart);
+	fprintf(reportHdl, "\t\"cpu_seconds\": %.6f,\n", cpu_clock() - statsPtr -> cpuStart);
+	fprintf(reportHdl, "\t\"peak_rss_kb\": %ld\n", peak_rss());
+	fprintf(reportHdl, "}\n");
+	
+	return ferror(reportHdl) ? isl_stat_error : isl_stat_ok;
+}
+
+// The heap still in use after each date must not grow with the number of dates
+void memory_date_record (phase * phasePtr) {
+	// Statistics of the run
+	run_statistics * statsPtr = phasePtr -> statsPtr;
+	
+	statsPtr -> lastDateHeap = heap_in_use();
+	
+	if (statsPtr -> heapDates == 0)
+		statsPtr -> firstDateHeap = statsPtr -> lastDateHeap;
+	
+	statsPtr -> heapDates += 1;
+}
+
+void memory_report (FILE * stream, phase * phasePtr) {
+	// Statistics of the run
+	run_statistics * statsPtr = phasePtr -> statsPtr;
+	
+	__SET_BLUE
+	fprintf(stream, "Memory check\n");
+	__SET_DEFAULT
+	fprintf(stream, "%-40s %8s %14s %18s %18s\n", "Phase", "Runs", "Peak RSS (kB)", "Heap in use (kB)", "Heap growth (kB)");
+	
+	for (int i = 0; i < NUMPHASES; i++)
+		fprintf(stream, "%-40s %8lu %14ld %18ld %18ld\n", phaseNames[i], statsPtr -> records[i].runs, statsPtr -> records[i].peakRss,
+			statsPtr -> records[i].heapInUse / 1024, statsPtr -> records[i].heapGrowth / 1024);
+	
+	if (statsPtr -> heapDates > 1)
+		fprintf(stream, "Heap growth between the first and the last of %lu dates: %ld bytes (%.1f bytes per date)\n", statsPtr -> heapDates,
+			statsPtr -> lastDateHeap - statsPtr -> firstDateHeap, (double)(statsPtr -> lastDateHeap - statsPtr -> firstDateHeap) / (statsPtr -> heapDates - 1));
+	
+	fprintf(stream, "Heap still in use: %ld kB\n", heap_in_use() / 1024);
+	fflush(stream);
+}
+
+void progress_begin (progress_meter * progressPtr, unsigned long total, double interval) {
+	
+	progressPtr -> total = total;
+	progressPtr -> dates = 0;
+	progressPtr -> lattices = 0;
+	progressPtr -> startTime = wall_clock();
+	progressPtr -> lastReport = progressPtr -> startTime;
+	progressPtr -> interval = interval;
+}
+
+void progress_print (FILE * stream, progress_meter * progressPtr, double now) {
+	// Time elapsed since the beginning
+	double elapsed = now - progressPtr -> startTime;
+	// Throughput in dates per second
+	double dateRate = elapsed > 0 ? progressPtr -> dates / elapsed : 0;
+	
+	__SET_BLUE
+	fprintf(stream, "Dates %lu/%lu (%.1f%%), %.1f dates/s, %.1f lattices/s, ", progressPtr -> dates, progressPtr -> total,
+		progressPtr -> total > 0 ? 100.0 * progressPtr -> dates / progressPtr -> total : 100.0, dateRate, elapsed > 0 ? progressPtr -> lattices / elapsed : 0);
+	
+	if (progressPtr -> dates < progressPtr -> total && dateRate > 0)
+		fprintf(stream, "ETA %.0f s", (progressPtr -> total - progressPtr -> dates) / dateRate);
+	else
+		fprintf(stream, "elapsed %.1f s", elapsed);
+	
+	__SET_DEFAULT
+	fprintf(stream, "\n");
+	fflush(stream);
+}
+
+void progress_update (FILE * stream, progress_meter * progressPtr, unsigned long dates, unsigned long lattices) {
+	// Current time
+	double now = 0;
+	
+	progressPtr -> dates += dates;
+	progressPtr -> lattices += lattices;
+	
+	now = wall_clock();
+	
+	if (now - progressPtr -> lastReport < progressPtr -> interval)
+		return;
+	
+	progressPtr -> lastReport = now;
+	progress_print(stream, progressPtr, now);
+}
+
+void progress_end (FILE * stream, progress_meter * progressPtr) {
+	progress_print(stream, progressPtr, wall_clock());
+}
+
+FILE * async_log_open (FILE * sink) {
+	// Descriptors of the pipe
+	int pipeHdl[2];
+	
+	if (asyncLog.active)
+		return asyncLog.stream;
+	
+	if (pipe(pipeHdl) < 0)
+		return NULL;
+	
+#ifdef F_SETPIPE_SZ
+	// A larger pipe lets the program run ahead of a slow terminal
+	fcntl(pipeHdl[1], F_SETPIPE_SZ, ASYNCPIPE);
+#endif
+	
+	asyncLog.stream = fdopen(pipeHdl[1], "w");
+	
+	if (asyncLog.stream == NULL) {
+		close(pipeHdl[0]);
+		close(pipeHdl[1]);
+		return NULL;
+	}
+	
+	setvbuf(asyncLog.stream, NULL, _IOFBF, ASYNCBUFFER);
+	asyncLog.sink = sink;
+	asyncLog.readHdl = pipeHdl[0];
+	
+	if (pthread_create(&(asyncLog.thread), NULL, async_log_drain, NULL) != 0) {
+		fclose(asyncLog.stream);
+		close(asyncLog.readHdl);
+		return NULL;
+	}
+	
+	asyncLog.active = 1;
+	
+	if (asyncLog.registered == 0) {
+		atexit(async_log_atexit);
+		asyncLog.registered = 1;
+	}
+	
+	return asyncLog.stream;
+}
+
+FILE * async_log_close (void) {
+	
+	if (asyncLog.active == 0)
+		return NULL;
+	
+	// Closing the writing end lets the thread drain the pipe and stop
+	fclose(asyncLog.stream);
+	pthread_join(asyncLog.thread, NULL);
+	close(asyncLog.readHdl);
+	fflush(asyncLog.sink);
+	asyncLog.active = 0;
+	
+	return asyncLog.sink;
+}
+
+void * async_log_drain (void * user) {
+	// Chunk of the log being moved
+	char buffer[ASYNCBUFFER];
+	// Length of the chunk
+	ssize_t length = 0;
+	
+	while ((length = read(asyncLog.readHdl, buffer, ASYNCBUFFER)) != 0) {
+		
+		if (length < 0) {
+			if (errno == EINTR)
+				continue;
+			
+			break;
+		}
+		
+		fwrite(buffer, 1, length, asyncLog.sink);
+		fflush(asyncLog.sink);
+	}
+	
+	return NULL;
+}
+
+void async_log_atexit (void) {
+	async_log_close();
+}
+
+long heap_in_use (void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	// Statistics of the allocator
+	struct mallinfo2 heapInfo = mallinfo2();
+	
+	return (long)(heapInfo.uordblks + heapInfo.hblkhd);
+#elif defined(__GLIBC__)
+	// Statistics of the allocator
+	struct mallinfo heapInfo = mallinfo();
+	
+	return (long)heapInfo.uordblks + heapInfo.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+double wall_clock (void) {
+	// Current time
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+double cpu_clock (void) {
+	// Processor time consumed up to now
+	struct timespec now;
+	
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+	
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+long peak_rss (void) {
+	// Resources used up to now
+	struct rusage usage;
+	
+	if (getrusage(RUSAGE_SELF, &usage) < 0)
+		return 0;
+	
+	// Kilobytes on Linux
+	return usage.ru_maxrss;
+}
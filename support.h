@@ -8,17 +8,104 @@
 
 #include<stdio.h>
 
+#include<isl/ctx.h>
+
+#define NUMPHASES 9
+
+// Resources used by a phase, summed over all its runs
+typedef struct {
+	unsigned long runs;
+	double wallTime;
+	double cpuTime;
+	long peakRss;
+	long heapInUse;
+	long heapGrowth;
+} phase_record;
+
+// Statistics of a whole run, shared by all the copies of a phase
+typedef struct {
+	phase_record records[NUMPHASES];
+	double wallStart;
+	double cpuStart;
+	unsigned long dates;
+	unsigned long points;
+	unsigned long lattices;
+	unsigned long heapDates;
+	long firstDateHeap;
+	long lastDateHeap;
+} run_statistics;
+
+// Throughput of the concurrent part, reported at most once per interval
+typedef struct {
+	unsigned long total;
+	unsigned long dates;
+	unsigned long lattices;
+	double startTime;
+	double lastReport;
+	double interval;
+} progress_meter;
+
 typedef struct {
 	unsigned phase_num;
+	unsigned running;
+	unsigned quiet;
+	unsigned quietDates;
+	unsigned checkMemory;
+	double wallStart;
+	double cpuStart;
+	long heapStart;
+	run_statistics * statsPtr;
+	progress_meter * progressPtr;
 } phase;
 
+typedef struct {
+	const char * socketPath;
+	const char * reportPath;
+	const char * archPath;
+	unsigned quiet;
+	unsigned progress;
+	unsigned asyncLog;
+	unsigned checkMemory;
+	const char * checkpointPath;
+	unsigned resume;
+	unsigned workers;
+	const char * exportPath;
+	unsigned exportTop;
+	const char * codegenPath;
+	unsigned rank;
+	const char * objective;
+	unsigned long screen;
+	double timeBudget;
+	const char * bankCounts;
+	unsigned maxOffset;
+	unsigned processorBudget;
+	unsigned placementSearch;
+	unsigned placementOffset;
+	unsigned mergeAccesses;
+} run_options;
+
 phase * start(FILE *);
 void new_phase(FILE *, phase *);
 void complete_phase(FILE *, phase *);
+void fail_phase(FILE *, phase *);
 void abort_phase(FILE *, phase *);
 void error(FILE *, const char *);
 void warning(FILE *, const char *);
 void info(FILE *, const char *, int);
 void finish(FILE *, phase *);
+void phase_free(phase *);
+isl_stat report_write(FILE *, phase *);
+void progress_begin(progress_meter *, unsigned long, double);
+void progress_update(FILE *, progress_meter *, unsigned long, unsigned long);
+void progress_end(FILE *, progress_meter *);
+FILE * async_log_open(FILE *);
+FILE * async_log_close(void);
+double wall_clock(void);
+double cpu_clock(void);
+long peak_rss(void);
+long heap_in_use(void);
+void memory_date_record(phase *);
+void memory_report(FILE *, phase *);
+int parse_options(int, char **, run_options *);
 
 #endif /* SUPPORT_H */
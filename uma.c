@@ -15,24 +15,32 @@
 #include "support.h"
 #include "model.h"
 #include "partitioning.h"
+#include "server.h"
+#include "profiling.h"
+#include "codegen.h"
+#include "capacity.h"
+#include "sampling.h"
+#include "anytime.h"
+#include "hierarchy.h"
+#include "counting.h"
+#include "pareto.h"
+#include "offsets.h"
+#include "processors.h"
+#include "placement.h"
 
 //#define DIMSTRING 100
 
-const unsigned options = 1;
-const unsigned parallel_phases = 3;
+// Order of the lattices when only --rank is given
+#define DEFAULTOBJECTIVE "cost,worst,variance,imbalance"
 
-typedef struct {
-	phase * phasePtr;
-	FILE * stream;
-	unsigned numTasks;
-	manipulated_polyhedral_model ** modifiedPolyhedralModelPtr;
-	isl_set *** translatesPtr;
-	unsigned long * cost;
-	unsigned numLattices;
-} concurrent_part_params;
+// Seconds between two checkpoints
+#define CHECKPOINTINTERVAL 60.0
+// Checkpoint used by --resume when no file is given
+#define DEFAULTCHECKPOINT "uma.checkpoint"
+
+unsigned options = 1;
 
 char ** validate_input(int, char**);
-isl_stat concurrent_part(isl_point *, void *);
 
 // Note that when an array lasts in Ptr, its elements are pointers
 int main(int argc, char ** argv) {
@@ -42,10 +50,52 @@ int main(int argc, char ** argv) {
 	FILE * outputStreamHdl = NULL;
 	// Handle for the configuration of the isl and pet libraries
 	isl_ctx * optionsHdl = NULL;
-#ifdef VERBOSE
-	// Pointer to the printer
-	isl_printer * printer = NULL;
-#endif
+	// Architecture - specific parameters
+	const architecture_config * archPtr = &defaultArchitecture;
+	// Architecture - specific parameters read from a file, if any
+	architecture_config * customArchPtr = NULL;
+	// Options given on the command line
+	run_options runOptions;
+	// Handle to the file of the report
+	FILE * reportHdl = NULL;
+	// Throughput of the concurrent part
+	progress_meter progress;
+	// Checkpoint of the concurrent part, if requested
+	checkpoint * checkpointPtr = NULL;
+	// Machine - readable export of the results, if requested
+	result_export * exportPtr = NULL;
+	// Addresses accessed by the tasks
+	isl_set * addressSpacePtr = NULL;
+	// Bank mapping of the best lattice
+	bank_mapping * mappingPtr = NULL;
+	// Storage needed in the banks under each lattice
+	bank_usage * usage = NULL;
+	// Secondary metrics of each lattice
+	lattice_metrics * metrics = NULL;
+	// Number of lattices left after the screening
+	unsigned numSurvivors = 0;
+	// Number of linearized dates
+	unsigned long numDates = 0;
+	// Order of the lattices
+	ranking_objective objective;
+	// Lattices from the best to the worst, if a ranking is requested
+	unsigned * ranking = NULL;
+	// Number of lattices printed with their metrics
+	unsigned numRanked = 0;
+	// Numbers of banks explored in one run, if requested
+	unsigned * bankCounts = NULL;
+	// Number of explored numbers of banks
+	int numCounts = 0;
+	// Configuration with the searched numbers of processors, if any
+	architecture_config searchedArch;
+	// Numbers of processors of the tasks, if searched
+	unsigned * processors = NULL;
+	// Placement of the arrays with the fewest conflicts, if searched
+	placement_policy placement = defaultPlacement;
+	// Start offsets of the tasks, if searched
+	unsigned * offsets = NULL;
+	// Number of command - line arguments consumed by the options
+	int consumed = 0;
 	// Array of task names
 	char ** tasks = NULL;
 	// Total numbers of tasks to work with
@@ -56,6 +106,14 @@ int main(int argc, char ** argv) {
 	isl_set *** translatesPtr = NULL;
 	// Number of different fundamental lattices
 	unsigned numLattices = 0;
+	// Array of the lattices of the clusters, for a hierarchical partitioning
+	isl_set *** clusterTranslatesPtr = NULL;
+	// Number of lattices of the clusters
+	unsigned numClusterLattices = 0;
+	// Array of cost function values for each lattice of the clusters
+	unsigned long * clusterCost = NULL;
+	// Lattice of the clusters paired with each lattice of the banks
+	unsigned * partner = NULL;
 	// Array containing the manipulated version of the polyhedral models of each task
 	manipulated_polyhedral_model ** modifiedPolyhedralModelPtr = NULL;
 	// Dimensionality of the address space
@@ -68,22 +126,35 @@ int main(int argc, char ** argv) {
 	unsigned bestLatticeIdx = 0;
 	// Best value of the cost function
 	unsigned long bestCost = 0;
-	// Parameters for the callback function
-	concurrent_part_params * params = NULL;
 	// Result of a subroutine
 	isl_stat outcome = isl_stat_ok;
 	
-	// 1a) We check if the user passed some sources to work with 
-	if (argc <= options + 1) {
+	consumed = parse_options(argc, argv, &runOptions);
+	
+	if (consumed >= 0 && (runOptions.rank > 0 || runOptions.objective != NULL) && objective_parse(runOptions.objective != NULL ? runOptions.objective : DEFAULTOBJECTIVE, &objective) < 0)
+		consumed = -1;
+	
+	if (consumed >= 0 && runOptions.bankCounts != NULL && (numCounts = bank_counts_parse(runOptions.bankCounts, &bankCounts)) <= 0)
+		consumed = -1;
+	
+	if (consumed < 0) {
+		fprintf(stderr, "Usage: %s [--server <socket>] [--report <file>] [--arch <file>] [--quiet | --progress] [--async-log] [--check-memory] [--checkpoint <file>] [--resume] [--workers <n>] [--export <file> [--export-top <k>]] [--codegen <file>] [--rank <k>] [--objective <metric>[,<metric> ...]] [--screen <dates>] [--time-budget <seconds>] [--banks <n>[,<n> ...]] [--offsets <max>] [--processors <budget>] [--placement <offset>] [--merge-accesses] <output> <task> [<task> ...]\n", argv[0]);
+		exit(1);
+	}
+	
+	options += consumed;
+	
+	// 1a) We check if the user passed some sources to work with, unless only the server is requested
+	if (argc <= options + (runOptions.socketPath == NULL ? 1 : 0)) {
 		perror("Not enough input file(s)");
 		exit(1);
 	}
 	
 	
-	if (strcmp(argv[1], "stdout") == 0)
+	if (strcmp(argv[options], "stdout") == 0)
 		outputStreamHdl = stdout;
 	else {
-		outputStreamHdl = fopen(argv[1],"w");
+		outputStreamHdl = fopen(argv[options],"w");
 		
 		if (outputStreamHdl == NULL) {
 			perror("Cannot create the output file");
@@ -91,6 +162,55 @@ int main(int argc, char ** argv) {
 		}
 	}
 	
+	// The workers are forked, and a fork only keeps the thread which calls it, not the one draining the log
+	if (runOptions.asyncLog && runOptions.workers > 1) {
+		warning(outputStreamHdl, "The output is written directly with several workers");
+		runOptions.asyncLog = 0;
+	}
+	
+	if (runOptions.asyncLog) {
+		outputStreamHdl = async_log_open(outputStreamHdl);
+		
+		if (outputStreamHdl == NULL) {
+			perror("Cannot create the asynchronous log");
+			exit(1);
+		}
+	}
+	
+	if (runOptions.archPath != NULL) {
+		customArchPtr = parse_architecture(outputStreamHdl, runOptions.archPath);
+		
+		if (customArchPtr == NULL) {
+			error(outputStreamHdl, "Error during parsing the architecture file");
+			exit(1);
+		}
+		
+		archPtr = customArchPtr;
+	}
+	
+	// The server keeps the models in memory and answers the queries on the socket
+	if (runOptions.socketPath != NULL) {
+		optionsHdl = isl_ctx_alloc_with_pet_options();
+		
+		if (optionsHdl == NULL) {
+			error(outputStreamHdl, "Sorry, there is something wrong with one of the libraries :(");
+			exit(1);
+		}
+		
+		if (serve(outputStreamHdl, optionsHdl, archPtr, runOptions.socketPath) < 0)
+			exit(1);
+		
+		isl_ctx_free(optionsHdl);
+		architecture_free(customArchPtr);
+		
+		if (runOptions.asyncLog)
+			outputStreamHdl = async_log_close();
+		
+		if(outputStreamHdl != stdout)
+			fclose(outputStreamHdl);
+		exit(0);
+	}
+	
 	phasePtr = start(outputStreamHdl);
 	
 	if (phasePtr == NULL) {
@@ -98,8 +218,19 @@ int main(int argc, char ** argv) {
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
+	phasePtr -> quietDates = runOptions.quiet;
+	phasePtr -> checkMemory = runOptions.checkMemory;
+	
+	if (runOptions.progress)
+		phasePtr -> progressPtr = &progress;
+	
 	numTasks = argc - options - 1;
 	
+	if (numTasks > archPtr -> maxTasks) {
+		error(outputStreamHdl, "Not enough task configurations for the provided input");
+		abort_phase(outputStreamHdl, phasePtr);
+	}
+	
 	tasks = validate_input(numTasks, argv);
 	
 	if (tasks == NULL) {
@@ -123,6 +254,58 @@ int main(int argc, char ** argv) {
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
+	// The exploration of the numbers of banks only reports their Pareto front
+	if (numCounts > 0 && (runOptions.exportPath != NULL || runOptions.codegenPath != NULL || runOptions.rank > 0 || runOptions.objective != NULL || runOptions.screen > 0 || runOptions.timeBudget > 0 || runOptions.maxOffset > 0 || runOptions.processorBudget > 0 || runOptions.placementSearch || runOptions.checkpointPath != NULL || runOptions.resume || archPtr -> numClusters > 0)) {
+		warning(outputStreamHdl, "Only the Pareto front is computed when several numbers of banks are explored");
+		runOptions.exportPath = NULL;
+		runOptions.codegenPath = NULL;
+		runOptions.checkpointPath = NULL;
+		runOptions.resume = 0;
+	}
+	
+	// The sample and the metrics only see the banks, while the cost of a hierarchy also charges the clusters
+	if (archPtr -> numClusters > 0 && runOptions.screen > 0) {
+		warning(outputStreamHdl, "The lattices are not screened with clusters");
+		runOptions.screen = 0;
+	}
+	
+	// The screening bounds the cost alone, so it could drop the lattice another objective or a longer ranking would list
+	if (runOptions.screen > 0 && (runOptions.rank > 0 || (runOptions.objective != NULL && objective.keys[0] != METRIC_COST))) {
+		warning(outputStreamHdl, "The lattices are only screened when the cost alone chooses the best one");
+		runOptions.screen = 0;
+	}
+	
+	if (archPtr -> numClusters > 0 && (runOptions.rank > 0 || runOptions.objective != NULL) && (objective.numKeys > 1 || objective.keys[0] != METRIC_COST)) {
+		warning(outputStreamHdl, "The lattices are ranked by their cost alone with clusters");
+		objective.keys[0] = METRIC_COST;
+		objective.numKeys = 1;
+	}
+	
+	// An anytime search is meant to be short, so it is neither sharded nor checkpointed
+	if (runOptions.timeBudget > 0 && runOptions.workers > 1)
+		warning(outputStreamHdl, "The dates are evaluated by a single worker with a time budget");
+	
+	// The workers of a sharded run keep their progress to themselves
+	if ((runOptions.checkpointPath != NULL || runOptions.resume) && runOptions.workers > 1)
+		warning(outputStreamHdl, "Checkpoints are not taken with several workers");
+	else if ((runOptions.checkpointPath != NULL || runOptions.resume) && runOptions.timeBudget > 0)
+		warning(outputStreamHdl, "Checkpoints are not taken with a time budget");
+	else if ((runOptions.checkpointPath != NULL || runOptions.resume) && runOptions.maxOffset > 0)
+		warning(outputStreamHdl, "Checkpoints are not taken with a search of the start offsets");
+	else if (runOptions.checkpointPath != NULL || runOptions.resume) {
+		checkpointPtr = checkpoint_alloc(runOptions.checkpointPath != NULL ? runOptions.checkpointPath : DEFAULTCHECKPOINT, CHECKPOINTINTERVAL, tasks, numTasks, archPtr -> numBanks, checkpoint_key(archPtr, &runOptions));
+		
+		if (checkpointPtr == NULL) {
+			error(outputStreamHdl, "Memory allocation problem :(");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+		
+		if (runOptions.resume && checkpoint_load(outputStreamHdl, optionsHdl, checkpointPtr) == isl_stat_error) {
+			error(outputStreamHdl, "Error during reading the checkpoint");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+	}
+	
 	polyhedralModelPtr = malloc(numTasks * sizeof(pet_scop *));
 	
 	if (polyhedralModelPtr == NULL) {
@@ -130,7 +313,7 @@ int main(int argc, char ** argv) {
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-	outcome = parse_input(outputStreamHdl, optionsHdl, tasks, polyhedralModelPtr, numTasks);
+	outcome = parse_input(outputStreamHdl, optionsHdl, archPtr, tasks, polyhedralModelPtr, numTasks);
 	
 	if (outcome == isl_stat_error) {
 		error(outputStreamHdl, "Error during parsing input files");
@@ -150,29 +333,55 @@ int main(int argc, char ** argv) {
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-	outcome = virtual_allocation(outputStreamHdl, optionsHdl, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, &dimAddressSpace);
+	outcome = virtual_allocation(outputStreamHdl, optionsHdl, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, &dimAddressSpace, &defaultPlacement);
 	
 	if (outcome == isl_stat_error) {
 		error(outputStreamHdl, "Error during virtual address space allocation");
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-	// 3) Reading the lattices with all the translates
+	// 3) Reading the lattices with all the translates, unless each number of banks reads its own catalog
 	new_phase(outputStreamHdl, phasePtr);
 	
-	translatesPtr = parse_lattices(outputStreamHdl, optionsHdl, &numLattices, dimAddressSpace);
+	if (numCounts == 0) {
+		translatesPtr = parse_lattices(outputStreamHdl, optionsHdl, archPtr, &numLattices, dimAddressSpace);
+		
+		if (translatesPtr == NULL) {
+			error(outputStreamHdl, "Error during parsing lattices :(");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+	}
 	
-	if (translatesPtr == NULL) {
-		error(outputStreamHdl, "Error during parsing lattices :(");
-		abort_phase(outputStreamHdl, phasePtr);
+	// The clusters have their own catalog, with as many banks as clusters
+	if (archPtr -> numClusters > 0 && numCounts == 0) {
+		clusterTranslatesPtr = cluster_lattices_parse(outputStreamHdl, optionsHdl, archPtr, &numClusterLattices, dimAddressSpace);
+		
+		if (clusterTranslatesPtr == NULL) {
+			error(outputStreamHdl, "Error during parsing the lattices of the clusters :(");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
 	}
 	
 	complete_phase(outputStreamHdl, phasePtr);
 	
+	// The numbers of processors with the highest throughput replace those of the configuration
+	if (runOptions.processorBudget > 0 && numCounts == 0) {
+		processors = processors_search(outputStreamHdl, phasePtr, optionsHdl, archPtr, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, translatesPtr, numLattices, runOptions.processorBudget, runOptions.workers);
+		
+		if (processors == NULL) {
+			error(outputStreamHdl, "Error during the search of the numbers of processors");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+		
+		searchedArch = *archPtr;
+		searchedArch.N = processors;
+		archPtr = &searchedArch;
+	}
+	
 	// 4) Building the physical schedule
 	new_phase(outputStreamHdl, phasePtr);
 	
-	outcome = physical_schedule(outputStreamHdl, optionsHdl, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks);
+	outcome = physical_schedule(outputStreamHdl, optionsHdl, archPtr, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks);
 	
 	if (outcome == isl_stat_error) {
 		error(outputStreamHdl, "Error during physical schedule building");
@@ -184,251 +393,264 @@ int main(int argc, char ** argv) {
 	// 5) Building the linearized schedule
 	new_phase(outputStreamHdl, phasePtr);
 	
-	outcome = eliminate_parameters(outputStreamHdl, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks);
+	outcome = eliminate_parameters(outputStreamHdl, archPtr, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks);
 	
 	if (outcome == isl_stat_error) {
 		error(outputStreamHdl, "Error during parameter projection out");
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-	outcome = linearize_dates(outputStreamHdl, modifiedPolyhedralModelPtr, numTasks);
+	// The linearization of a resumed run is taken from the checkpoint
+	if (checkpointPtr != NULL && checkpoint_linearization_restore(checkpointPtr, modifiedPolyhedralModelPtr) == isl_bool_true)
+		outcome = isl_stat_ok;
+	else
+		outcome = linearize_dates(outputStreamHdl, modifiedPolyhedralModelPtr, numTasks);
 	
 	if (outcome == isl_stat_error) {
 		error(outputStreamHdl, "Error during dates linearization");
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-	linearized_schedule_dates_set = isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[0] -> linearizedSchedule)));
+	linearized_schedule_dates_set = linearized_dates_union(outputStreamHdl, modifiedPolyhedralModelPtr, numTasks);
 	
 	if (linearized_schedule_dates_set == NULL) {
 		error(outputStreamHdl, "Error during dates union");
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-	for (int i = 1; i < numTasks; i++)
-		linearized_schedule_dates_set = isl_set_union(linearized_schedule_dates_set, isl_set_from_union_set(isl_union_map_range(isl_union_map_copy(modifiedPolyhedralModelPtr[i] -> linearizedSchedule))));
-	
-	linearized_schedule_dates_set = isl_set_coalesce(linearized_schedule_dates_set);
+	// The placement of the arrays with the fewest conflicts replaces the first one, the capacity depending on it
+	if (runOptions.placementSearch && numCounts == 0) {
+		outcome = placement_search(outputStreamHdl, phasePtr, optionsHdl, archPtr, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, dimAddressSpace, linearized_schedule_dates_set, translatesPtr, numLattices, runOptions.placementOffset, runOptions.workers, &placement);
+		
+		if (outcome == isl_stat_error || placement_allocate(outputStreamHdl, optionsHdl, archPtr, polyhedralModelPtr, modifiedPolyhedralModelPtr, numTasks, dimAddressSpace, &placement) == isl_stat_error) {
+			error(outputStreamHdl, "Error during the search of the placement of the arrays");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+	}
 	
-	if (linearized_schedule_dates_set == NULL) {
-		error(outputStreamHdl, "Error during dates union");
+	// Each task then applies its accesses once per date, tagged for the port - aware model
+	if (runOptions.mergeAccesses && accesses_merge(outputStreamHdl, modifiedPolyhedralModelPtr, numTasks, dimAddressSpace, archPtr -> memory.ports != NULL) == isl_stat_error) {
+		error(outputStreamHdl, "Error during the merge of the accesses");
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-#ifdef VERBOSE
-	fprintf(outputStreamHdl, "Unified linearized schedule space:\n");
-	fflush(outputStreamHdl);
-	printer = isl_printer_to_file(optionsHdl, outputStreamHdl);
+	// The lattices which do not fit in the banks are rejected before the concurrent part
+	addressSpacePtr = address_space_range(modifiedPolyhedralModelPtr, numTasks);
 	
-	if(printer == NULL) {
-		error(outputStreamHdl, "Memory allocation problem :(");
-		abort_phase(outputStreamHdl, phasePtr);
-	} 
+	if (numCounts > 0) {
+		complete_phase(outputStreamHdl, phasePtr);
+		
+		// 6) - 9) The datasets of the dates are shared by the catalogs of all the numbers of banks
+		if (pareto_explore(outputStreamHdl, phasePtr, optionsHdl, archPtr, modifiedPolyhedralModelPtr, numTasks, linearized_schedule_dates_set, dimAddressSpace, addressSpacePtr, bankCounts, numCounts, runOptions.workers) == isl_stat_error) {
+			error(outputStreamHdl, "Error during the exploration of the numbers of banks");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+		
+		goto report;
+	}
 	
-	printer = isl_printer_print_set(printer, linearized_schedule_dates_set);
+	usage = addressSpacePtr != NULL ? lattices_capacity_analyse(outputStreamHdl, translatesPtr, numLattices, archPtr -> numBanks, addressSpacePtr) : NULL;
 	
-	if(printer == NULL) {
-		error(outputStreamHdl, "Printing problem :(");
+	if (usage == NULL)
+		warning(outputStreamHdl, "Cannot analyse the capacity of the banks");
+	else if (lattices_capacity_filter(outputStreamHdl, translatesPtr, usage, numLattices, archPtr -> numBanks, archPtr -> bankCapacity) == 0) {
+		error(outputStreamHdl, "No lattice fits in the capacity of the banks");
 		abort_phase(outputStreamHdl, phasePtr);
-	} 
-	
-	fprintf(outputStreamHdl, "\n");
+	}
 	
-	isl_printer_free(printer);
-#endif
+	// The tasks are staggered by the start offsets with the fewest conflicts, and the dates gathered again
+	if (runOptions.maxOffset > 0 && numTasks > 1) {
+		offsets = offsets_search(outputStreamHdl, modifiedPolyhedralModelPtr, numTasks, translatesPtr, numLattices, archPtr -> numBanks, &(archPtr -> memory), runOptions.maxOffset);
+		
+		if (offsets == NULL || offsets_apply(outputStreamHdl, modifiedPolyhedralModelPtr, numTasks, offsets) == isl_stat_error) {
+			error(outputStreamHdl, "Error during the search of the start offsets");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+		
+		isl_set_free(linearized_schedule_dates_set);
+		linearized_schedule_dates_set = linearized_dates_union(outputStreamHdl, modifiedPolyhedralModelPtr, numTasks);
+		
+		if (linearized_schedule_dates_set == NULL) {
+			error(outputStreamHdl, "Error during dates union");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+	} else if (runOptions.maxOffset > 0)
+		warning(outputStreamHdl, "A single task has no start offset to search");
 	
 	complete_phase(outputStreamHdl, phasePtr);
 	
-	// This part must be iterated for each one of the linearized dates
-	params = malloc(sizeof(concurrent_part_params));
+	// 6) - 8) This part must be iterated for each one of the linearized dates
+	cost = malloc(numLattices * sizeof(unsigned long));
+	metrics = malloc(numLattices * sizeof(lattice_metrics));
 	
-	if (params == NULL) {
-		error(outputStreamHdl, "Memory allocation problem for the parameters of the concurrent part:(");
-		abort_phase(outputStreamHdl, phasePtr);
-	}
-	
-	params -> phasePtr = phasePtr;
-	params -> stream = outputStreamHdl;
-	params -> numTasks = numTasks;
-	params -> modifiedPolyhedralModelPtr = modifiedPolyhedralModelPtr;
-	params -> translatesPtr = translatesPtr;
-	params -> numLattices = numLattices;
-	params -> cost = malloc(numLattices * sizeof(unsigned long));
-	
-	if(params -> cost == NULL) {
+	if(cost == NULL || metrics == NULL) {
 		error(outputStreamHdl, "Memory allocation problem :(");
 		abort_phase(outputStreamHdl, phasePtr);
 	} 
 	
-	for (int i = 0; i < numLattices; i++)
-		params -> cost[i] = 0;
+	if (runOptions.exportPath != NULL) {
+		exportPtr = export_open(outputStreamHdl, runOptions.exportPath, runOptions.exportTop, numLattices);
+		
+		if (exportPtr == NULL)
+			abort_phase(outputStreamHdl, phasePtr);
+	}
 	
-	outcome = isl_set_foreach_point(linearized_schedule_dates_set, concurrent_part, (void *)params);
+	// A first screening on a sample of the dates leaves fewer lattices to the exact evaluation
+	if (runOptions.screen > 0) {
+		outcome = lattices_screen(outputStreamHdl, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearized_schedule_dates_set, translatesPtr, numLattices, archPtr -> numBanks, &(archPtr -> memory), runOptions.screen, runOptions.workers, &numSurvivors);
+		
+		if (outcome == isl_stat_error) {
+			error(outputStreamHdl, "Error during the screening of the lattices");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+	}
+	
+	if (runOptions.timeBudget > 0)
+		outcome = cost_function_compute_anytime(outputStreamHdl, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearized_schedule_dates_set, translatesPtr, numLattices, archPtr -> numBanks, &(archPtr -> memory), cost, metrics, exportPtr, runOptions.timeBudget);
+	else if (runOptions.workers > 1)
+		outcome = cost_function_compute_sharded(outputStreamHdl, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearized_schedule_dates_set, translatesPtr, numLattices, archPtr -> numBanks, &(archPtr -> memory), cost, metrics, runOptions.workers, exportPtr);
+	else
+		outcome = cost_function_compute(outputStreamHdl, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearized_schedule_dates_set, translatesPtr, numLattices, archPtr -> numBanks, &(archPtr -> memory), cost, metrics, checkpointPtr, exportPtr);
 	
 	if (outcome == isl_stat_error) {
 		error(outputStreamHdl, "Error during the concurrent part");
-		phasePtr -> phase_num += parallel_phases;
 		abort_phase(outputStreamHdl, phasePtr);
 	}
 	
-	phasePtr -> phase_num += parallel_phases;
-	// 9) Cost function evaluation
-	new_phase(outputStreamHdl, phasePtr);
-	
-	cost = params -> cost;
-	
-#ifdef VERBOSE
-	fprintf(outputStreamHdl, "F. lattice #\t Cost function value\n");
-	
-	for (int i = 0; i < numLattices; i++)
-		fprintf(outputStreamHdl, "%u) \t\t %lu\n", i, cost[i]);
+	// The lattices of the clusters are evaluated on their own, then paired with those of the banks
+	if (clusterTranslatesPtr != NULL) {
+		clusterCost = malloc(numClusterLattices * sizeof(unsigned long));
+		partner = malloc(numLattices * sizeof(unsigned));
+		
+		if (clusterCost == NULL || partner == NULL) {
+			error(outputStreamHdl, "Memory allocation problem :(");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+		
+		if (cluster_cost_compute(outputStreamHdl, phasePtr, modifiedPolyhedralModelPtr, numTasks, linearized_schedule_dates_set, clusterTranslatesPtr, numClusterLattices, archPtr, clusterCost, runOptions.workers) == isl_stat_error) {
+			error(outputStreamHdl, "Error during the concurrent part of the clusters");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+		
+		if (hierarchy_combine(outputStreamHdl, clusterTranslatesPtr, numClusterLattices, clusterCost, translatesPtr, numLattices, cost, archPtr, partner) == 0) {
+			error(outputStreamHdl, "No lattice of the banks refines a lattice of the clusters");
+			abort_phase(outputStreamHdl, phasePtr);
+		}
+	}
 	
-	fflush(outputStreamHdl);
-#endif
+	// A completed run leaves nothing to resume
+	if (checkpointPtr != NULL)
+		checkpoint_remove(checkpointPtr);
 	
-	bestCost = cost[0];
-	bestLatticeIdx = 0;
+	// 9) Cost function evaluation
+	new_phase(outputStreamHdl, phasePtr);
 	
-#ifdef MOREVERBOSE
-	fprintf(outputStreamHdl, "Cost function value for the fundamental lattice %u: \t %lu\n", 0, cost[0]);
-	fflush(outputStreamHdl);
-#endif
+	// The screening and a resumed run leave the statistics apart from the number of dates
+	if (set_count(linearized_schedule_dates_set, &numDates) == isl_stat_error) {
+		error(outputStreamHdl, "Error during the count of the dates");
+		abort_phase(outputStreamHdl, phasePtr);
+	}
 	
-	for (int i = 1; i < numLattices; i++)
-		if (cost[i] < bestCost) {
-			bestCost = cost[i];
-			bestLatticeIdx = i;
-			
-#ifdef MOREVERBOSE
-			fprintf(outputStreamHdl, "Cost function value for the fundamental lattice %u: \t %lu\n", i, cost[i]);
-			fflush(outputStreamHdl);
-#endif
+	// Without a ranking the lowest cost wins, the lowest index breaking the ties
+	if (runOptions.rank > 0 || runOptions.objective != NULL) {
+		ranking = lattices_rank(cost, metrics, numLattices, numDates, &objective);
+		
+		if (ranking == NULL) {
+			error(outputStreamHdl, "Memory allocation problem :(");
+			abort_phase(outputStreamHdl, phasePtr);
 		}
+		
+		bestLatticeIdx = ranking[0];
+		bestCost = cost[bestLatticeIdx];
+	} else
+		bestLatticeIdx = best_lattice(outputStreamHdl, cost, numLattices, &bestCost);
 	
 	complete_phase(outputStreamHdl, phasePtr);
 	
-	fprintf(outputStreamHdl, "The best allocation is the one corresponding to the lattice number %u\n", bestLatticeIdx);
-	
-	// Be clean
-	free(cost);
-	free(params);
-	manipulated_polyhedral_model_array_free(modifiedPolyhedralModelPtr, numTasks);
-	free(tasks);
-	finish(outputStreamHdl, phasePtr);
-}
-
-char ** validate_input(int n, char ** argv) {
-	
-	char ** names = malloc(n * sizeof(char *));
-	
-	for (int i = 0; i < n; i++)
-		names[i] = argv[i+options+1];
-	
-	return names;
-}
-
-isl_stat concurrent_part(isl_point * pointPtr, void * user) {
-	// Pointer to the input parameters
-	concurrent_part_params * params = (concurrent_part_params *)user;
-	// Pointer to the printer
-	isl_printer * printer = NULL;
-	// Pointer to the phase of the current point
-	phase phasePoint = *params -> phasePtr;
-	// Pointer to the array of the polyhedral slices
-	isl_union_set ** polyhedralSlicePtr = NULL;
-	// Pointer to the concurrent dataset
-	isl_set * concurrentDatasetPtr = NULL;
-	// Result of a subroutine
-	isl_stat outcome = isl_stat_ok;
-	
-	info (params -> stream, "Linearized date: %d", isl_val_get_num_si(isl_point_get_coordinate_val(pointPtr, isl_dim_set, 0)));
-	
-	printer = isl_printer_to_file(isl_point_get_ctx(pointPtr), params -> stream);
+	if (ranking != NULL) {
+		// With only an objective the winner alone is printed
+		numRanked = runOptions.rank == 0 ? 1 : (runOptions.rank < numLattices ? runOptions.rank : numLattices);
+		ranking_print(outputStreamHdl, ranking, numRanked, cost, partner == NULL ? metrics : NULL, numDates);
+	}
 	
-	// 6) Polyhedral slices building
-	new_phase(params -> stream, &(phasePoint));
+	fprintf(outputStreamHdl, "The best allocation is the one corresponding to the lattice number %u\n", bestLatticeIdx);
 	
-	polyhedralSlicePtr = malloc ((params -> numTasks) * sizeof(isl_union_set *));
+	if (partner != NULL)
+		fprintf(outputStreamHdl, "Its banks are grouped in clusters by the lattice number %u of the clusters\n", partner[bestLatticeIdx]);
 	
-	if (polyhedralSlicePtr == NULL) {
-		error(params -> stream, "Memory allocation problem for the polyhedral slices");
-		return isl_stat_error;
-	}
+	if (usage != NULL)
+		fprintf(outputStreamHdl, "It needs %lu words per bank, the most loaded bank holds %lu addresses and %.1f%% of the words are unused\n",
+			usage[bestLatticeIdx].capacity, usage[bestLatticeIdx].maxFootprint, usage[bestLatticeIdx].fragmentation * 100);
 	
-	for (int i = 0; i < params -> numTasks; i++) {
-		
-#ifdef MOREVERBOSE
-		info(params -> stream, "Task %d)", i);
-#endif
+report:
+	if (runOptions.reportPath != NULL) {
+		reportHdl = fopen(runOptions.reportPath, "w");
 		
-		polyhedralSlicePtr[i] = polyhedral_slice_build (params -> stream, isl_union_map_copy(params -> modifiedPolyhedralModelPtr[i] -> flattenedSchedule), isl_union_map_copy(params -> modifiedPolyhedralModelPtr[i] -> linearizedSchedule), pointPtr);
+		if (reportHdl == NULL || report_write(reportHdl, phasePtr) == isl_stat_error)
+			warning(outputStreamHdl, "Cannot write the report");
 		
-		if (polyhedralSlicePtr[i] == NULL) {
-			error(params -> stream, "Error during polyhedral slices building");
-			return isl_stat_error;
-		}
-		
-#ifdef MOREVERBOSE
-		printer = isl_printer_set_indent(printer, moreIndent);
-		fprintf(params -> stream, "Polyhedral slice of task %d:\n", i);
-		printer = isl_printer_print_union_set(printer, polyhedralSlicePtr[i]);
+		if (reportHdl != NULL)
+			fclose(reportHdl);
+	}
+	
+	if (exportPtr != NULL && export_write(outputStreamHdl, exportPtr, cost, bestLatticeIdx, translatesPtr, archPtr -> numBanks, usage) == isl_stat_error)
+		warning(outputStreamHdl, "Cannot write the export");
+	
+	if (runOptions.codegenPath != NULL) {
+		mappingPtr = addressSpacePtr != NULL ? bank_mapping_build(outputStreamHdl, translatesPtr[bestLatticeIdx], archPtr -> numBanks, addressSpacePtr) : NULL;
 		
-		if(printer == NULL) {
-			error(params -> stream, "Printing problem :(");
-			return isl_stat_error;
-		} 
+		if (mappingPtr == NULL || bank_mapping_generate(outputStreamHdl, runOptions.codegenPath, mappingPtr, bestLatticeIdx) == isl_stat_error)
+			warning(outputStreamHdl, "Cannot generate the bank mapping");
 		
-		fprintf(params -> stream, "\n");
-		fflush(params -> stream);
-#endif
+		bank_mapping_free(mappingPtr);
 	}
-		
-	complete_phase(params -> stream, &(phasePoint));
 	
-	// 7) Concurrent dataset building
-	new_phase(params -> stream, &(phasePoint));
+	PROFILE_DUMP(outputStreamHdl);
 	
-	concurrentDatasetPtr = concurrent_dataset_build(params -> stream, params -> modifiedPolyhedralModelPtr, polyhedralSlicePtr, params -> numTasks);
+	// Be clean
+	checkpoint_free(checkpointPtr);
+	export_free(exportPtr);
+	free(usage);
+	free(ranking);
+	free(metrics);
+	isl_set_free(addressSpacePtr);
+	free(cost);
+	isl_set_free(linearized_schedule_dates_set);
 	
-	if (concurrentDatasetPtr == NULL) {
-		error(params -> stream, "Error during concurrent dataset building");
-		return isl_stat_error;
-	}
+	if (translatesPtr != NULL)
+		lattices_free(translatesPtr, numLattices, archPtr -> numBanks);
 	
-#ifdef VERBOSE
-	fprintf(params -> stream, "Concurrent dataset:\n");
-	printer = isl_printer_print_set(printer, concurrentDatasetPtr);
-		
-	if(printer == NULL) {
-		error(params -> stream, "Printing problem :(");
-		return isl_stat_error;
-	} 
+	if (clusterTranslatesPtr != NULL)
+		lattices_free(clusterTranslatesPtr, numClusterLattices, archPtr -> numClusters);
 	
-	fprintf(params -> stream, "\n");
-	fflush(params -> stream);
-#endif
+	free(clusterCost);
+	free(partner);
+	free(bankCounts);
+	free(offsets);
+	free(processors);
+	manipulated_polyhedral_model_array_free(modifiedPolyhedralModelPtr, numTasks);
 	
-	complete_phase(params -> stream, &(phasePoint));
+	for (int i = 0; i < numTasks; i++)
+		pet_scop_free(polyhedralModelPtr[i]);
 	
-	// 8) Cost function computation for the current date
-	new_phase(params -> stream, &(phasePoint));
+	free(polyhedralModelPtr);
+	// The context warns if some isl object is still referenced
+	isl_ctx_free(optionsHdl);
+	free(tasks);
+	architecture_free(customArchPtr);
 	
-	for (int i = 0; i < params -> numLattices; i++) {
-#ifdef VERBOSE
-		info(params -> stream, "Fundamental lattice %u)", i);
-#endif
-		
-		outcome = evaluate_fundamental_lattice(params -> stream, concurrentDatasetPtr, params -> translatesPtr[i], &(params -> cost[i]));
-		
-		if (outcome == isl_stat_error) {
-			error(params -> stream, "Error during the evaluation of the cost function");
-			return isl_stat_error;
-		} 
-	}
+	if (runOptions.checkMemory)
+		memory_report(outputStreamHdl, phasePtr);
 	
-	complete_phase(params -> stream, &(phasePoint));
+	finish(outputStreamHdl, phasePtr);
+}
+
+char ** validate_input(int n, char ** argv) {
 	
-	isl_printer_free(printer);
+	char ** names = malloc(n * sizeof(char *));
 	
-	return isl_stat_ok;
-}
\ No newline at end of file
+	for (int i = 0; i < n; i++)
+		names[i] = argv[i+options+1];
+	
+	return names;
+}
@@ -16,37 +16,35 @@
 // Dimensions added by the mapping policy
 const unsigned dPolicy = 1;
 
-isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModel, unsigned numTasks, unsigned * dimPtr) {
+// Every array has its own coordinate of the policy dimension, without shift
+const placement_policy defaultPlacement = {0, 0};
+
+isl_map * array_allocation_build(isl_ctx *, isl_set *, unsigned, unsigned, long, long);
+
+isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** polyhedralModelPtr, manipulated_polyhedral_model ** modifiedPolyhedralModel, unsigned numTasks, unsigned * dimPtr, const placement_policy * policyPtr) {
 	
 	// Maximum dimension of the arrays to be allocated
 	unsigned dMax = 0;
-	// Dimension of the padding zeros for the address space currently being reallocated
-	unsigned dZeros = 0;
-	// Array of dimensions of each task
-	unsigned * dTask = NULL;
+	// Dimension of the current array
+	unsigned dArray = 0;
+	// Whether the arrays of a task are interleaved along their first dimension
+	unsigned interleaved = 0;
+	// Index of the current array across all the tasks
+	long arrayId = 0;
 #ifdef VERBOSE
 	// Pointer to the printer
 	isl_printer * printer = NULL;
 #endif
 	// Pointer to the array to be allocated, for the current task
 	isl_set * originalArrayPtr = NULL;
-	// Pointer to the space of the allocation address space, for the current task
-	isl_space * allocationArraySpacePtr = NULL;
-	// Pointer to the space of the allocation address space, for the current task
-	isl_set * allocationArrayPtr = NULL;
-	// Pointer to the virtual address space allocation
-	isl_map * allocationRelationPtr = NULL;
-	// Pointer to the local space of the virtual address space allocation
-	isl_local_space * allocationRelationLocalSpacePtr = NULL;
-	// Pointer to the constraint under building
-	isl_constraint * constraintPtr = NULL;
-	
-	dTask = malloc(numTasks * sizeof(unsigned));
-	
-	if (dTask == NULL) {
-		error(stream, "Memory allocation problem :(");
-		return isl_stat_error;
-	} 
+	// Pointer to the virtual address space allocation of an array
+	isl_map * arrayAllocationPtr = NULL;
+	// Pointer to the virtual address space allocation of all the arrays of the current task
+	isl_union_map * allocationRelationPtr = NULL;
+#ifdef VERBOSE
+	// Pointer to an original access relation, only used for printing
+	isl_union_map * accessPtr = NULL;
+#endif
 	
 #ifdef VERBOSE
 	printer = isl_printer_to_file(optionsHdl, stream);
@@ -57,185 +55,86 @@ isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** po
 	} 
 #endif
 	
-	// 1) We determine the dimension of the allocation address space
-	for (int i = 0; i < numTasks; i++) {
-		// Here we assume that each task has only one array
-		originalArrayPtr = isl_set_copy(polyhedralModelPtr[i] -> arrays[0] -> extent);
-		
-		if (originalArrayPtr == NULL) {
-			error(stream, "Cannot retrieve the original address space");
-			free(dTask);
-			return isl_stat_error;
-		} 
-		
-		dTask[i] = isl_set_dim(originalArrayPtr, isl_dim_set);
-		
+	// 1) We determine the dimension of the allocation address space, over every array of every task
+	for (int i = 0; i < numTasks; i++)
+		for (int k = 0; k < polyhedralModelPtr[i] -> n_array; k++) {
+			originalArrayPtr = isl_set_copy(polyhedralModelPtr[i] -> arrays[k] -> extent);
+			
+			if (originalArrayPtr == NULL) {
+				error(stream, "Cannot retrieve the original address space");
+				return isl_stat_error;
+			} 
+			
+			dArray = isl_set_dim(originalArrayPtr, isl_dim_set);
+			
+			if (dMax < dArray)
+				dMax = dArray;
+			
 #ifdef VERBOSE
-		fprintf(stream, "Original array of task %d: ", i);
-		fflush(stream);
-		printer = isl_printer_print_set(printer, originalArrayPtr);
-		
-		if(printer == NULL) {
-			error(stream, "Printing problem :(");
-			return isl_stat_error;
-		} 
-		
-		fprintf(stream, "\nDimensionality: %d\n", dTask[i]);
+			fprintf(stream, "Original array %d of task %d: ", k, i);
+			fflush(stream);
+			printer = isl_printer_print_set(printer, originalArrayPtr);
+			
+			if(printer == NULL) {
+				error(stream, "Printing problem :(");
+				return isl_stat_error;
+			} 
+			
+			fprintf(stream, "\nDimensionality: %d\n", dArray);
 #endif
-	}
-		
-	// Maximum algorithm
-	dMax = dTask[0];
-	
-	for (int i = 1; i < numTasks; i++)
-		if (dMax < dTask[i])
-			dMax = dTask[i];
+			
+			isl_set_free(originalArrayPtr);
+		}
 	
 	*dimPtr = dMax + dPolicy;
+	// Without a first dimension the interleaved arrays would share their addresses
+	interleaved = policyPtr -> interleaved && dMax > 0;
 #ifdef VERBOSE
 	fprintf(stream, "Maximum dimensionality of the arrays to be allocated: %d\n", dMax);
 	fprintf(stream, "Dimensionality of the allocation address space: %d\n", *dimPtr);
 #endif	
 		
 	for (int i = 0; i < numTasks; i++) {
-		dZeros = *dimPtr - dTask[i] - dPolicy;
+		if (polyhedralModelPtr[i] -> n_array == 0) {
+			error(stream, "A task does not access any array");
+			return isl_stat_error;
+		}
 		
 #ifdef VERBOSE
 		info(stream, "Task %d)", i);
-		fprintf(stream, "Padding zeros: %u\n", dZeros);
 		isl_printer_set_indent(printer, moreIndent);
 #endif
 		
-		originalArrayPtr = isl_set_copy(polyhedralModelPtr[i] -> arrays[0] -> extent);
-		// 2) We build the allocation relation
-		// Building the allocation address space set
-		allocationArraySpacePtr = isl_space_set_alloc(optionsHdl, 0, *dimPtr);
-		
-		if (allocationArraySpacePtr == NULL)
-			return isl_stat_error;
-		
-//		allocationArraySpacePtr = isl_space_set_tuple_name(allocationArraySpacePtr, isl_dim_set, "V");
-		
-		if (allocationArraySpacePtr == NULL)
-			return isl_stat_error;
-		
-		// Building the allocation address space 
-		allocationArrayPtr = isl_set_universe(allocationArraySpacePtr);
-		
-		if (allocationArrayPtr == NULL)
-			return isl_stat_error;
-		
-#ifdef VERBOSE
-		fprintf(stream, "Allocated set: ");
-		fflush(stream);
-		printer = isl_printer_print_set(printer, allocationArrayPtr);
-		
-		if(printer == NULL) {
-			error(stream, "Printing problem :(");
-			return isl_stat_error;
-		} 
-		
-		fprintf(stream, "\n");
-#endif
-		
-		allocationRelationPtr = isl_map_from_domain_and_range(isl_set_copy(originalArrayPtr), isl_set_copy(allocationArrayPtr));
-		
-		if (allocationRelationPtr == NULL)
-			return isl_stat_error;
-		
-#ifdef MOREVERBOSE
-		fprintf(stream, "Unconstrained relation: ");
-		fflush(stream);
-		printer = isl_printer_print_map(printer, allocationRelationPtr);
-		
-		if(printer == NULL) {
-			error(stream, "Printing problem :(");
-			return isl_stat_error;
-		} 
-		
-		fprintf(stream, "\n");
-#endif
-		
-		allocationRelationLocalSpacePtr = isl_local_space_from_space(isl_map_get_space(allocationRelationPtr));
-		
-		if (allocationRelationLocalSpacePtr == NULL)
-			return isl_stat_error;
-		
-#ifdef MOREVERBOSE
-		fprintf(stream, "Local space to constrain: ");
-		fflush(stream);
-		printer = isl_printer_print_local_space(printer, allocationRelationLocalSpacePtr);
-		
-		if(printer == NULL) {
-			error(stream, "Printing problem :(");
-			return isl_stat_error;
-		} 
-		
-		fprintf(stream, "\n");
-#endif
-		
-		// Constraint on the dimension(s) used by the virtual allocation policy
-		constraintPtr = isl_constraint_alloc_equality(isl_local_space_copy(allocationRelationLocalSpacePtr));
-		
-		if (constraintPtr == NULL)
-			return isl_stat_error;
-		
-		// The first dimension of the allocation space must be equal to the task number
-		constraintPtr = isl_constraint_set_coefficient_si(constraintPtr, isl_dim_out, 0, 1);
-		constraintPtr = isl_constraint_set_constant_si(constraintPtr, -i);
-		allocationRelationPtr = isl_map_add_constraint(allocationRelationPtr, constraintPtr);
-		
-#ifdef MOREVERBOSE
-		fprintf(stream, "Constraints of the virtual allocation policy: ");
-		fflush(stream);
-		printer = isl_printer_print_map(printer, allocationRelationPtr);
-		
-		if(printer == NULL) {
-			error(stream, "Printing problem :(");
-			return isl_stat_error;
-		} 
-		
-		fprintf(stream, "\n");
-#endif
-		
-		// Constraints on the original dimensions
-		for (int j = 0; j < dTask[i]; j++) {
-			constraintPtr = isl_constraint_alloc_equality(isl_local_space_copy(allocationRelationLocalSpacePtr));
-		
-			if (constraintPtr == NULL)
-				return isl_stat_error;
-		
-			constraintPtr = isl_constraint_set_coefficient_si(constraintPtr, isl_dim_in, j, 1);
-			constraintPtr = isl_constraint_set_coefficient_si(constraintPtr, isl_dim_out, dPolicy + j, -1);
-			allocationRelationPtr = isl_map_add_constraint(allocationRelationPtr, constraintPtr);
-		}
-		
-		// Constraint on the padding zeros
-		for (int j = dPolicy + dTask[i]; j < *dimPtr; j++) {
-			constraintPtr = isl_constraint_alloc_equality(isl_local_space_copy(allocationRelationLocalSpacePtr));
-		
-			if (constraintPtr == NULL)
+		// 2) We build the allocation relation, as the union of the ones of the arrays
+		allocationRelationPtr = NULL;
+		
+		for (int k = 0; k < polyhedralModelPtr[i] -> n_array; k++, arrayId++) {
+			// The interleaved arrays of a task share its coordinate, the others have their own and are shifted
+			if (interleaved)
+				arrayAllocationPtr = array_allocation_build(optionsHdl, isl_set_copy(polyhedralModelPtr[i] -> arrays[k] -> extent), *dimPtr, polyhedralModelPtr[i] -> n_array, i, k);
+			else
+				arrayAllocationPtr = array_allocation_build(optionsHdl, isl_set_copy(polyhedralModelPtr[i] -> arrays[k] -> extent), *dimPtr, 1, arrayId, arrayId * policyPtr -> offset);
+			
+			allocationRelationPtr = allocationRelationPtr == NULL ? isl_union_map_from_map(arrayAllocationPtr) : isl_union_map_union(allocationRelationPtr, isl_union_map_from_map(arrayAllocationPtr));
+			
+			if (allocationRelationPtr == NULL)
 				return isl_stat_error;
-		
-			constraintPtr = isl_constraint_set_coefficient_si(constraintPtr, isl_dim_out, j, 1);
-			constraintPtr = isl_constraint_set_constant_si(constraintPtr, 0);
-			allocationRelationPtr = isl_map_add_constraint(allocationRelationPtr, constraintPtr);
 		}
 		
 #ifdef VERBOSE
 		fprintf(stream, "Virtual address space allocation: ");
 		fflush(stream);
-		isl_printer_print_map(printer, allocationRelationPtr);
+		printer = isl_printer_print_union_map(printer, allocationRelationPtr);
 		
 		if(printer == NULL) {
 			error(stream, "Printing problem :(");
 			return isl_stat_error;
-		} 
+		}
 		
 		fprintf(stream, "\n");
 #endif
 		// May - reads remapping
-		modifiedPolyhedralModel[i] -> remappedMayReads = isl_union_map_apply_range (pet_scop_get_may_reads(polyhedralModelPtr[i]), isl_union_map_from_map(isl_map_copy(allocationRelationPtr)));
+		modifiedPolyhedralModel[i] -> remappedMayReads = isl_union_map_apply_range (pet_scop_get_may_reads(polyhedralModelPtr[i]), isl_union_map_copy(allocationRelationPtr));
 		
 		if (modifiedPolyhedralModel[i] -> remappedMayReads == NULL)
 			return isl_stat_error;
@@ -243,7 +142,9 @@ isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** po
 #ifdef VERBOSE
 		fprintf(stream, "Original may - read access relation: ");
 		fflush(stream);
-		printer = isl_printer_print_union_map(printer, pet_scop_get_may_reads(polyhedralModelPtr[i]));
+		accessPtr = pet_scop_get_may_reads(polyhedralModelPtr[i]);
+		printer = isl_printer_print_union_map(printer, accessPtr);
+		isl_union_map_free(accessPtr);
 		
 		if(printer == NULL) {
 			error(stream, "Printing problem :(");
@@ -262,7 +163,7 @@ isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** po
 		fprintf(stream, "\n");
 #endif
 		// May - writes remapping
-		modifiedPolyhedralModel[i] -> remappedMayWrites = isl_union_map_apply_range (pet_scop_get_may_writes(polyhedralModelPtr[i]), isl_union_map_from_map(isl_map_copy(allocationRelationPtr)));
+		modifiedPolyhedralModel[i] -> remappedMayWrites = isl_union_map_apply_range (pet_scop_get_may_writes(polyhedralModelPtr[i]), isl_union_map_copy(allocationRelationPtr));
 		
 		if (modifiedPolyhedralModel[i] -> remappedMayWrites == NULL)
 			return isl_stat_error;
@@ -270,7 +171,9 @@ isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** po
 #ifdef VERBOSE
 		fprintf(stream, "Original may - write access relation: ");
 		fflush(stream);
-		printer = isl_printer_print_union_map(printer, pet_scop_get_may_writes(polyhedralModelPtr[i]));
+		accessPtr = pet_scop_get_may_writes(polyhedralModelPtr[i]);
+		printer = isl_printer_print_union_map(printer, accessPtr);
+		isl_union_map_free(accessPtr);
 		
 		if(printer == NULL) {
 			error(stream, "Printing problem :(");
@@ -289,7 +192,7 @@ isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** po
 		fprintf(stream, "\n");
 #endif
 		// Must - writes remapping
-		modifiedPolyhedralModel[i] -> remappedMustWrites = isl_union_map_apply_range (pet_scop_get_must_writes(polyhedralModelPtr[i]), isl_union_map_from_map(isl_map_copy(allocationRelationPtr)));
+		modifiedPolyhedralModel[i] -> remappedMustWrites = isl_union_map_apply_range (pet_scop_get_must_writes(polyhedralModelPtr[i]), isl_union_map_copy(allocationRelationPtr));
 		
 		if (modifiedPolyhedralModel[i] -> remappedMustWrites == NULL)
 			return isl_stat_error;
@@ -297,7 +200,9 @@ isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** po
 #ifdef VERBOSE
 		fprintf(stream, "Original must - write access relation: ");
 		fflush(stream);
-		printer = isl_printer_print_union_map(printer, pet_scop_get_must_writes(polyhedralModelPtr[i]));
+		accessPtr = pet_scop_get_must_writes(polyhedralModelPtr[i]);
+		printer = isl_printer_print_union_map(printer, accessPtr);
+		isl_union_map_free(accessPtr);
 		
 		if(printer == NULL) {
 			error(stream, "Printing problem :(");
@@ -317,13 +222,56 @@ isl_stat virtual_allocation (FILE * stream, isl_ctx * optionsHdl, pet_scop ** po
 		isl_printer_set_indent(printer, lessIndent);
 #endif
 		
+		// Be clean for the next task
+		isl_union_map_free(allocationRelationPtr);
 	}
 	
 #ifdef VERBOSE
 	isl_printer_free(printer);
 #endif
 	
-	free(dTask);
 	return isl_stat_ok;
 	
 }
+
+// An address of the array is the policy coordinate, then its coordinates, the first one scaled and shifted, then zeros
+isl_map * array_allocation_build(isl_ctx * optionsHdl, isl_set * originalArrayPtr, unsigned dim, unsigned scale, long policyCoordinate, long shift) {
+	// Dimension of the array
+	unsigned dArray = isl_set_dim(originalArrayPtr, isl_dim_set);
+	// Pointer to the virtual address space allocation
+	isl_map * allocationRelationPtr = NULL;
+	// Pointer to the local space of the virtual address space allocation
+	isl_local_space * allocationRelationLocalSpacePtr = NULL;
+	// Pointer to the constraint under building
+	isl_constraint * constraintPtr = NULL;
+	
+	allocationRelationPtr = isl_map_from_domain_and_range(originalArrayPtr, isl_set_universe(isl_space_set_alloc(optionsHdl, 0, dim)));
+	allocationRelationLocalSpacePtr = isl_local_space_from_space(isl_map_get_space(allocationRelationPtr));
+	
+	if (allocationRelationLocalSpacePtr == NULL) {
+		isl_map_free(allocationRelationPtr);
+		return NULL;
+	}
+	
+	// Constraint on the dimension(s) used by the virtual allocation policy
+	constraintPtr = isl_constraint_alloc_equality(isl_local_space_copy(allocationRelationLocalSpacePtr));
+	constraintPtr = isl_constraint_set_coefficient_si(constraintPtr, isl_dim_out, 0, 1);
+	constraintPtr = isl_constraint_set_constant_si(constraintPtr, -policyCoordinate);
+	allocationRelationPtr = isl_map_add_constraint(allocationRelationPtr, constraintPtr);
+	
+	// Constraints on the original dimensions, then on the padding zeros
+	for (int j = 0; j < dim - dPolicy; j++) {
+		constraintPtr = isl_constraint_alloc_equality(isl_local_space_copy(allocationRelationLocalSpacePtr));
+		
+		if (j < dArray)
+			constraintPtr = isl_constraint_set_coefficient_si(constraintPtr, isl_dim_in, j, j == 0 ? scale : 1);
+		
+		constraintPtr = isl_constraint_set_coefficient_si(constraintPtr, isl_dim_out, dPolicy + j, -1);
+		constraintPtr = isl_constraint_set_constant_si(constraintPtr, j == 0 ? shift : 0);
+		allocationRelationPtr = isl_map_add_constraint(allocationRelationPtr, constraintPtr);
+	}
+	
+	isl_local_space_free(allocationRelationLocalSpacePtr);
+	
+	return allocationRelationPtr;
+}